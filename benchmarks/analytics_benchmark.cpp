@@ -0,0 +1,139 @@
+#include "../include/MusicStoreDB.h"
+#include "../include/AnalyticsSnapshot.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+// Сравнение аналитических отчетов: SQL-запросы против колоночного снимка.
+// Запуск: analytics_benchmark [лет] [операций в день] [компакт-дисков]
+
+namespace {
+
+const char* DB_PATH = "analytics_benchmark.db";
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Медиана нескольких запусков
+template <typename Func>
+double measure(Func func, int runs = 5) {
+    std::vector<double> times;
+    for (int i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        times.push_back(elapsedMs(start));
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+std::string formatMs(double ms) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.2f", ms);
+    return buffer;
+}
+
+// Генерация CSV-файлов и импорт в базу
+void generate(MusicStoreDB& db, int years, int operationsPerDay, int discs) {
+    std::mt19937 random(42);
+    std::ofstream discsFile("analytics_benchmark_discs.csv");
+    std::ofstream worksFile("analytics_benchmark_works.csv");
+    std::ofstream operationsFile("analytics_benchmark_operations.csv");
+    
+    discsFile << "disc_key,production_date,company,price\n";
+    worksFile << "disc_key,title,author,performer\n";
+    operationsFile << "disc_key,operation_date,operation_type,quantity\n";
+    
+    for (int disc = 1; disc <= discs; disc++) {
+        discsFile << "D" << disc << ",2014-01-01,Label " << disc % 50 << "," << 5 + random() % 2000 / 100.0 << "\n";
+        for (int work = 0; work < 3; work++) {
+            worksFile << "D" << disc << ",Work " << disc << "-" << work << ",Author " << random() % 300
+                      << ",Performer " << random() % 200 << "\n";
+        }
+        operationsFile << "D" << disc << ",2014-12-31,поступление,100000000\n";
+    }
+    
+    static const int DAYS_IN_MONTH[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    for (int year = 2015; year < 2015 + years; year++) {
+        for (int month = 1; month <= 12; month++) {
+            int days = DAYS_IN_MONTH[month - 1] + (month == 2 && year % 4 == 0 ? 1 : 0);
+            for (int day = 1; day <= days; day++) {
+                char date[32];
+                std::snprintf(date, sizeof(date), "%04d-%02d-%02d", year, month, day);
+                for (int i = 0; i < operationsPerDay; i++) {
+                    operationsFile << "D" << 1 + random() % discs << "," << date << ",продажа," << 1 + random() % 5 << "\n";
+                }
+            }
+        }
+    }
+    
+    discsFile.close();
+    worksFile.close();
+    operationsFile.close();
+    
+    db.importCsv(ImportKind::Discs, "analytics_benchmark_discs.csv");
+    db.importCsv(ImportKind::Works, "analytics_benchmark_works.csv");
+    db.importCsv(ImportKind::Operations, "analytics_benchmark_operations.csv");
+    
+    std::filesystem::remove("analytics_benchmark_discs.csv");
+    std::filesystem::remove("analytics_benchmark_works.csv");
+    std::filesystem::remove("analytics_benchmark_operations.csv");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int years = argc > 1 ? std::atoi(argv[1]) : 10;
+    int operationsPerDay = argc > 2 ? std::atoi(argv[2]) : 60;
+    int discs = argc > 3 ? std::atoi(argv[3]) : 2000;
+    
+    std::filesystem::remove(DB_PATH);
+    std::ostringstream discarded;
+    std::streambuf* oldCout = std::cout.rdbuf(discarded.rdbuf());
+    
+    MusicStoreDB db(DB_PATH);
+    db.login("admin", "admin");
+    auto start = std::chrono::steady_clock::now();
+    generate(db, years, operationsPerDay, discs);
+    double generateMs = elapsedMs(start);
+    
+    start = std::chrono::steady_clock::now();
+    AnalyticsSnapshot snapshot;
+    db.loadAnalyticsSnapshot(snapshot);
+    double loadMs = elapsedMs(start);
+    
+    TableWriter table;
+    table.setHeader({"Отчет", "Путь", "мс"});
+    
+    table.addRow({"Продажи по авторам", "SQL", formatMs(measure([&] { db.getAuthorSales(); }, 3))});
+    table.addRow({"Продажи по исполнителям", "SQL", formatMs(measure([&] { db.getPerformerSales(); }, 3))});
+    table.addRow({"Статистика за 2020 год", "SQL",
+                  formatMs(measure([&] { db.calculatePeriodStatistics("2020-01-01", "2020-12-31"); }, 3))});
+    
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2}) {
+        if (level > AnalyticsSnapshot::detectSimdLevel()) {
+            continue;
+        }
+        snapshot.setSimdLevel(level);
+        std::string path = std::string("снимок, ") + AnalyticsSnapshot::simdLevelName(level);
+        
+        table.addRow({"Продажи по авторам", path, formatMs(measure([&] { snapshot.authorSales(); }))});
+        table.addRow({"Продажи по исполнителям", path, formatMs(measure([&] { snapshot.performerSales(); }))});
+        table.addRow({"Статистика за 2020 год", path,
+                      formatMs(measure([&] { snapshot.periodStatistics("2020-01-01", "2020-12-31"); }))});
+    }
+    
+    std::cout.rdbuf(oldCout);
+    std::cout << "Операций: " << snapshot.operationCount() << ", генерация: " << formatMs(generateMs)
+              << " мс, загрузка снимка: " << formatMs(loadMs) << " мс" << std::endl;
+    table.write(std::cout);
+    
+    std::filesystem::remove(DB_PATH);
+    return 0;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ReportTypes.h"
+
+/**
+ * @brief Набор векторных инструкций для агрегирующих функций
+ */
+enum class SimdLevel {
+    Scalar, // Без векторных инструкций
+    Sse2,   // SSE2 (128 бит)
+    Avx2    // AVX2 (256 бит)
+};
+
+/**
+ * @brief Колоночный снимок операций для аналитических отчетов
+ *
+ * Операции хранятся по столбцам (дата, тип, количество, цена). Для каждого
+ * измерения отчета (автор, исполнитель, компакт-диск) строки упорядочены по
+ * группе, поэтому каждая группа - непрерывный диапазон, а сумма с фильтром
+ * по периоду и типу операции считается векторной функцией без ветвлений.
+ * Авторы и исполнители закодированы словарем, отсортированным по имени.
+ *
+ * Снимок заполняется методами add*() и готов к запросам после build();
+ * после построения он только читается и может использоваться из нескольких потоков.
+ */
+class AnalyticsSnapshot {
+private:
+    /**
+     * @brief Столбцы операций, сгруппированные по одному измерению
+     *
+     * Сегмент - операции одного произведения (для авторов и исполнителей)
+     * или одного компакт-диска.
+     */
+    struct Projection {
+        std::vector<uint32_t> segmentGroup; // Код группы каждого сегмента
+        std::vector<size_t> segmentStart;   // Начало сегмента (размер - число сегментов + 1)
+        std::vector<int32_t> day;           // Дата операции (YYYYMMDD)
+        std::vector<uint8_t> type;          // 1 - продажа, 0 - поступление
+        std::vector<int32_t> quantity;      // Количество
+        std::vector<double> price;          // Цена компакт-диска
+    };
+
+    struct StagedWork {
+        int workId;
+        int compactId;
+        std::string author;
+        std::string performer;
+    };
+
+    struct StagedOperation {
+        int compactId;
+        int32_t day;
+        uint8_t type;
+        int32_t quantity;
+    };
+
+    std::vector<std::string> authors;    // Словарь авторов
+    std::vector<std::string> performers; // Словарь исполнителей
+    std::vector<int> discIds;            // Компакт-диски по возрастанию идентификатора
+    Projection byAuthor;                 // Сегменты-произведения по авторам
+    Projection byPerformer;              // Сегменты-произведения по исполнителям
+    Projection byDisc;                   // Сегменты-компакт-диски
+    size_t operations;                   // Количество операций
+    SimdLevel simdLevel;                 // Используемые векторные инструкции
+
+    std::unordered_map<int, double> stagedPrices; // Цены до построения
+    std::vector<StagedWork> stagedWorks;           // Произведения до построения
+    std::vector<StagedOperation> stagedOperations; // Операции до построения
+
+    /**
+     * @brief Преобразование границ периода (пустая строка - без ограничения)
+     *
+     * @return false, если дата некорректна
+     */
+    static bool parseRange(const std::string &startDate, const std::string &endDate, int32_t &from, int32_t &to);
+
+    /**
+     * @brief Суммы по диапазону строк с фильтром по периоду
+     */
+    DiscPeriodTotals aggregate(const Projection &projection, size_t begin, size_t end,
+                               int32_t from, int32_t to) const;
+
+public:
+    /**
+     * @brief Конструктор пустого снимка
+     */
+    AnalyticsSnapshot();
+
+    /**
+     * @brief Добавление компакт-диска
+     */
+    void addDisc(int compactId, double price);
+
+    /**
+     * @brief Добавление произведения
+     */
+    void addWork(int workId, int compactId, const std::string &author, const std::string &performer);
+
+    /**
+     * @brief Добавление операции
+     *
+     * @param day Дата операции в виде YYYYMMDD
+     * @param sale true - продажа, false - поступление
+     */
+    void addOperation(int compactId, int32_t day, bool sale, int32_t quantity);
+
+    /**
+     * @brief Построение столбцов из добавленных данных
+     */
+    void build();
+
+    /**
+     * @brief Количество операций в снимке
+     */
+    size_t operationCount() const;
+
+    /**
+     * @brief Продажи по авторам за период
+     *
+     * Совпадает с MusicStoreDB::getAuthorSales(): продажи компакт-диска
+     * засчитываются каждому произведению на нем, строки упорядочены по автору.
+     *
+     * @param startDate Начало периода (YYYY-MM-DD, пустая строка - без ограничения)
+     * @param endDate Конец периода (YYYY-MM-DD, пустая строка - без ограничения)
+     */
+    std::vector<AuthorSales> authorSales(const std::string &startDate = "", const std::string &endDate = "") const;
+
+    /**
+     * @brief Продажи по исполнителям за период
+     */
+    std::vector<PerformerSales> performerSales(const std::string &startDate = "",
+                                               const std::string &endDate = "") const;
+
+    /**
+     * @brief Поступления и продажи каждого компакт-диска за период
+     */
+    std::vector<DiscPeriodTotals> periodStatistics(const std::string &startDate = "",
+                                                   const std::string &endDate = "") const;
+
+    /**
+     * @brief Выбор векторных инструкций (не выше поддерживаемых процессором)
+     */
+    void setSimdLevel(SimdLevel level);
+
+    /**
+     * @brief Используемые векторные инструкции
+     */
+    SimdLevel getSimdLevel() const;
+
+    /**
+     * @brief Лучшие векторные инструкции, поддерживаемые процессором
+     */
+    static SimdLevel detectSimdLevel();
+
+    /**
+     * @brief Название набора инструкций
+     */
+    static const char *simdLevelName(SimdLevel level);
+};
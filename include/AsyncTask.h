@@ -0,0 +1,444 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+/**
+ * @brief Завершение задачи: управление передается ожидающей корутине
+ */
+struct ContinuationAwaiter {
+    bool await_ready() noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        std::coroutine_handle<> continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() noexcept {}
+};
+
+/**
+ * @brief Общая часть обещания задачи
+ */
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation; // Корутина, ожидающая результат
+    std::exception_ptr error;             // Исключение, выброшенное задачей
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    ContinuationAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+
+    void rethrowIfFailed() const {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value; // Результат задачи
+
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U &&result) {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T result() {
+        rethrowIfFailed();
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void result() { rethrowIfFailed(); }
+};
+
+/**
+ * @brief Корутина, которая запускается сразу и сама освобождает свой кадр
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+/**
+ * @brief Однократное событие для ожидания из обычного потока
+ */
+class OneShotEvent {
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool signaled = false;
+
+public:
+    void set() {
+        // Уведомление под блокировкой: после wait() объект может быть сразу уничтожен
+        std::lock_guard<std::mutex> lock(mutex);
+        signaled = true;
+        condition.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return signaled; });
+    }
+};
+
+template <typename T>
+using StoredResult = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+template <typename T>
+DetachedTask runAndStore(Task<T> &task, std::optional<StoredResult<T>> &result, std::exception_ptr &error,
+                         OneShotEvent &done) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await task;
+            result.emplace();
+        } else {
+            result.emplace(co_await task);
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    done.set();
+}
+
+} // namespace detail
+
+/**
+ * @brief Ленивая задача C++20: выполняется при первом co_await
+ *
+ * Результат (или исключение) передается ожидающей корутине, которая
+ * продолжает работу в том потоке, где задача завершилась.
+ *
+ * @tparam T Тип результата
+ */
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+private:
+    std::coroutine_handle<promise_type> handle; // Кадр корутины
+
+public:
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle(handle) {}
+
+    Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    /**
+     * @brief Запуск задачи и ожидание ее результата
+     */
+    auto operator co_await() noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter{handle};
+    }
+};
+
+template <typename T>
+Task<T> detail::TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> detail::TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/**
+ * @brief Асинхронный генератор: корутина может ожидать (co_await) и выдавать значения (co_yield)
+ *
+ * Потребитель получает значения по одному:
+ * @code
+ * while (auto row = co_await rows.next()) { ... }
+ * @endcode
+ *
+ * @tparam T Тип выдаваемых значений
+ */
+template <typename T>
+class AsyncGenerator {
+public:
+    struct promise_type {
+        std::optional<T> current;         // Последнее выданное значение
+        std::coroutine_handle<> consumer; // Корутина, ожидающая следующее значение
+        std::exception_ptr error;         // Исключение генератора
+
+        AsyncGenerator get_return_object() noexcept {
+            return AsyncGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    return handle.promise().consumer;
+                }
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+
+        auto yield_value(T value) {
+            current.emplace(std::move(value));
+            struct YieldAwaiter {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    return handle.promise().consumer;
+                }
+                void await_resume() noexcept {}
+            };
+            return YieldAwaiter{};
+        }
+
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle; // Кадр корутины-генератора
+
+public:
+    explicit AsyncGenerator(std::coroutine_handle<promise_type> handle) noexcept : handle(handle) {}
+
+    AsyncGenerator(AsyncGenerator &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    AsyncGenerator &operator=(AsyncGenerator &&other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    AsyncGenerator(const AsyncGenerator &) = delete;
+    AsyncGenerator &operator=(const AsyncGenerator &) = delete;
+
+    ~AsyncGenerator() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    /**
+     * @brief Ожидание следующего значения
+     *
+     * @return Значение или std::nullopt, если генератор завершился
+     */
+    auto next() noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().consumer = awaiting;
+                handle.promise().current.reset();
+                return handle;
+            }
+
+            std::optional<T> await_resume() {
+                if (!handle) {
+                    return std::nullopt;
+                }
+                if (handle.promise().error) {
+                    std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+                }
+                return std::exchange(handle.promise().current, std::nullopt);
+            }
+        };
+        return Awaiter{handle};
+    }
+};
+
+/**
+ * @brief Блокирующее ожидание задачи из обычного (не корутинного) кода
+ *
+ * @return Результат задачи; исключение задачи выбрасывается повторно
+ */
+template <typename T>
+T syncWait(Task<T> task) {
+    std::optional<detail::StoredResult<T>> result;
+    std::exception_ptr error;
+    detail::OneShotEvent done;
+    detail::runAndStore(task, result, error, done);
+    done.wait();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*result);
+    }
+}
+
+namespace detail {
+
+inline DetachedTask runDetached(Task<void> task) {
+    co_await task;
+}
+
+} // namespace detail
+
+/**
+ * @brief Запуск задачи без ожидания результата
+ *
+ * Кадр задачи освобождается после ее завершения. Исключение, вышедшее из
+ * задачи, завершает программу, поэтому задача должна обрабатывать их сама.
+ */
+inline void spawn(Task<void> task) {
+    detail::runDetached(std::move(task));
+}
+
+namespace detail {
+
+/**
+ * @brief Счетчик завершения группы задач
+ *
+ * Начальное значение на единицу больше числа задач: последнюю единицу
+ * снимает ожидающая корутина после запуска всех задач.
+ */
+class WhenAllCounter {
+private:
+    std::atomic<size_t> remaining;
+    std::coroutine_handle<> continuation;
+
+public:
+    explicit WhenAllCounter(size_t count) : remaining(count + 1) {}
+
+    void setContinuation(std::coroutine_handle<> handle) { continuation = handle; }
+
+    // Возвращает true для последнего завершившегося участника
+    bool arrive() noexcept { return remaining.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+    void resume() { continuation.resume(); }
+};
+
+template <typename T>
+DetachedTask runWhenAllItem(Task<T> &task, std::optional<StoredResult<T>> &result, std::exception_ptr &error,
+                            WhenAllCounter &counter) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await task;
+            result.emplace();
+        } else {
+            result.emplace(co_await task);
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (counter.arrive()) {
+        counter.resume();
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Параллельное ожидание группы задач
+ *
+ * Все задачи запускаются сразу; ожидающая корутина продолжается в потоке,
+ * завершившем последнюю задачу. Первое исключение выбрасывается повторно.
+ *
+ * @return Результаты в порядке следования задач
+ */
+template <typename T>
+Task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> whenAll(std::vector<Task<T>> tasks) {
+    std::vector<std::optional<detail::StoredResult<T>>> results(tasks.size());
+    std::vector<std::exception_ptr> errors(tasks.size());
+    detail::WhenAllCounter counter(tasks.size());
+
+    struct StartAll {
+        std::vector<Task<T>> &tasks;
+        std::vector<std::optional<detail::StoredResult<T>>> &results;
+        std::vector<std::exception_ptr> &errors;
+        detail::WhenAllCounter &counter;
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            counter.setContinuation(awaiting);
+            for (size_t i = 0; i < tasks.size(); i++) {
+                detail::runWhenAllItem(tasks[i], results[i], errors[i], counter);
+            }
+            // Если все задачи уже завершились, продолжаем без приостановки
+            return !counter.arrive();
+        }
+
+        void await_resume() const noexcept {}
+    };
+    co_await StartAll{tasks, results, errors, counter};
+
+    for (const auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    if constexpr (!std::is_void_v<T>) {
+        std::vector<T> values;
+        values.reserve(results.size());
+        for (auto &result : results) {
+            values.push_back(std::move(*result));
+        }
+        co_return values;
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Музыкальное произведение в кеше каталога
+ */
+struct CatalogWork {
+    int workId;            // Идентификатор произведения
+    std::string title;     // Название
+    std::string author;    // Автор
+    std::string performer; // Исполнитель
+};
+
+/**
+ * @brief Компакт-диск в кеше каталога
+ */
+struct CatalogDisc {
+    int compactId;                  // Идентификатор компакт-диска
+    std::string productionDate;     // Дата выпуска
+    std::string company;            // Компания-производитель
+    double price;                   // Цена
+    std::vector<CatalogWork> works; // Произведения по возрастанию идентификатора
+};
+
+/**
+ * @brief Неизменяемый снимок каталога
+ */
+class CatalogSnapshot {
+private:
+    std::unordered_map<int, CatalogDisc> discs; // Компакт-диски по идентификатору
+
+    friend class CatalogCache;
+
+public:
+    /**
+     * @brief Добавление компакт-диска при загрузке снимка
+     */
+    void addDisc(CatalogDisc disc);
+
+    /**
+     * @brief Добавление произведения при загрузке снимка
+     *
+     * @return false если компакт-диска нет в снимке
+     */
+    bool addWork(int compactId, CatalogWork work);
+
+    /**
+     * @brief Поиск компакт-диска
+     *
+     * @return Компакт-диск или nullptr
+     */
+    const CatalogDisc *find(int compactId) const;
+
+    /**
+     * @brief Идентификаторы компакт-дисков компании
+     */
+    std::vector<int> discsOf(const std::string &company) const;
+
+    /**
+     * @brief Количество компакт-дисков
+     */
+    size_t size() const { return discs.size(); }
+};
+
+/**
+ * @brief Кеш каталога для чтения без блокировок (RCU)
+ *
+ * Читатели получают текущий снимок одной атомарной загрузкой
+ * std::shared_ptr и работают с ним, не блокируя писателей и не обращаясь
+ * к базе. Изменение копирует снимок, правит копию и атомарно подменяет
+ * указатель; старый снимок освобождается, когда его отпустит последний
+ * читатель. Каталог меняется редко, поэтому копирование при записи
+ * дешевле, чем запросы к compact_discs и musical_works в каждом отчете.
+ *
+ * Пустой кеш загружается из базы при первом обращении. Загрузка,
+ * начатая до изменения, не публикуется (проверяется номер поколения).
+ */
+class CatalogCache {
+private:
+    std::atomic<std::shared_ptr<const CatalogSnapshot>> current; // Текущий снимок (nullptr - не загружен)
+    std::atomic<uint64_t> generation;                             // Номер поколения, растет при каждом изменении
+    std::atomic<long long> swaps;                                 // Количество подмен снимка
+    std::mutex writeMutex;                                        // Писатели выполняются по одному
+
+    /**
+     * @brief Изменение копии снимка и ее публикация
+     */
+    void update(const std::function<void(CatalogSnapshot &)> &change);
+
+public:
+    CatalogCache();
+
+    CatalogCache(const CatalogCache &) = delete;
+    CatalogCache &operator=(const CatalogCache &) = delete;
+
+    /**
+     * @brief Текущий снимок (nullptr - кеш не загружен)
+     */
+    std::shared_ptr<const CatalogSnapshot> snapshot() const { return current.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Номер поколения для publish()
+     */
+    uint64_t currentGeneration() const { return generation.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Публикация загруженного снимка
+     *
+     * @param snapshot Снимок, прочитанный из базы
+     * @param startGeneration Номер поколения до начала чтения
+     * @return false если каталог успел измениться (снимок устарел)
+     */
+    bool publish(std::shared_ptr<const CatalogSnapshot> snapshot, uint64_t startGeneration);
+
+    /**
+     * @brief Добавление или замена компакт-диска (произведения сохраняются)
+     */
+    void putDisc(int compactId, const std::string &productionDate, const std::string &company, double price);
+
+    /**
+     * @brief Изменение компании и цены компакт-диска
+     */
+    void updateDisc(int compactId, const std::string &company, double price);
+
+    /**
+     * @brief Удаление компакт-диска вместе с произведениями
+     */
+    void removeDisc(int compactId);
+
+    /**
+     * @brief Добавление произведения
+     */
+    void addWork(int compactId, CatalogWork work);
+
+    /**
+     * @brief Сброс кеша (следующее обращение загрузит каталог из базы)
+     */
+    void invalidate();
+
+    /**
+     * @brief Количество подмен снимка
+     */
+    long long swapCount() const { return swaps.load(); }
+};
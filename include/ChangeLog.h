@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Тип изменения строки
+ */
+enum class ChangeOp : uint8_t {
+    Insert = 1,
+    Update = 2,
+    Delete = 3
+};
+
+/**
+ * @brief Таблица, в которой произошло изменение
+ */
+enum class ChangeTable : uint8_t {
+    Operations = 1,
+    CompactDiscs = 2,
+    MusicalWorks = 3
+};
+
+/**
+ * @brief Запись журнала изменений
+ */
+struct ChangeRecord {
+    uint64_t sequence; // Порядковый номер (начиная с 1, монотонно возрастает)
+    int64_t rowId;     // Идентификатор измененной строки
+    ChangeOp op;       // Тип изменения
+    ChangeTable table; // Таблица
+};
+
+/**
+ * @brief Журнал изменений только на дозапись, отображенный в память
+ *
+ * Записи имеют фиксированный размер, поэтому запись с номером N лежит по
+ * известному смещению и потребитель может продолжить чтение с любого номера.
+ * Счетчик записей в заголовке обновляется после самих записей, так что
+ * читатели (в том числе в других процессах) видят только целые пакеты.
+ * Писатель у журнала один: при открытии для записи файл блокируется
+ * flock, и второй писатель (в том числе из другого процесса) журнал не откроет.
+ */
+class ChangeLog {
+private:
+    int fd;                    // Дескриптор файла журнала
+    mutable char* base;        // Начало отображенной области
+    mutable size_t mappedSize; // Размер отображенной области
+    bool readOnly;             // Журнал открыт только для чтения
+    mutable std::mutex mutex;  // Защита отображения при росте файла
+
+    /**
+     * @brief Отображение файла в память с заданной емкостью
+     *
+     * @param size Требуемый размер файла в байтах
+     * @return true если отображение выполнено успешно
+     */
+    bool remap(size_t size) const;
+
+    /**
+     * @brief Количество записей, опубликованных в заголовке
+     */
+    uint64_t publishedCount() const;
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * @param path Путь к файлу журнала (создается при отсутствии)
+     * @param readOnly Открыть журнал только для чтения (для потребителей)
+     */
+    explicit ChangeLog(const std::string& path, bool readOnly = false);
+
+    /**
+     * @brief Деструктор
+     */
+    ~ChangeLog();
+
+    ChangeLog(const ChangeLog&) = delete;
+    ChangeLog& operator=(const ChangeLog&) = delete;
+
+    /**
+     * @brief Проверка, открыт ли журнал
+     */
+    bool isOpen() const { return base != nullptr; }
+
+    /**
+     * @brief Дозапись пакета изменений одной транзакции
+     *
+     * @param batch Изменения; номера присваиваются журналом
+     * @return Номер последней записанной записи (0 при ошибке)
+     */
+    uint64_t append(std::vector<ChangeRecord>& batch);
+
+    /**
+     * @brief Номер последней опубликованной записи
+     */
+    uint64_t lastSequence() const;
+
+    /**
+     * @brief Чтение изменений после заданного номера
+     *
+     * @param afterSequence Номер последней уже обработанной записи (0 - с начала)
+     * @param maxRecords Максимальное количество возвращаемых записей
+     * @return Записи с номерами больше afterSequence
+     */
+    std::vector<ChangeRecord> readFrom(uint64_t afterSequence, size_t maxRecords = 1024) const;
+};
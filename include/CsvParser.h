@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Разбор CSV (RFC 4180) по частям в нескольких потоках
+ *
+ * Файл делится на части по границам записей: перевод строки считается
+ * границей, только если перед ним четное количество кавычек, поэтому
+ * значения в кавычках с переводами строк не разрываются.
+ */
+class CsvParser {
+public:
+    using Record = std::vector<std::string>;
+
+    /**
+     * @brief Разбор одной записи
+     *
+     * @param pos Текущая позиция (сдвигается за конец записи)
+     * @param end Конец данных
+     * @param fields Значения полей записи
+     * @return false если данные закончились
+     */
+    static bool parseRecord(const char *&pos, const char *end, Record &fields);
+
+    /**
+     * @brief Разбиение данных на части по границам записей
+     *
+     * @param data Начало данных
+     * @param size Размер данных
+     * @param parts Желаемое количество частей
+     * @return Пары смещений [начало, конец) для каждой части
+     */
+    static std::vector<std::pair<size_t, size_t>> splitChunks(const char *data, size_t size, size_t parts);
+
+    /**
+     * @brief Разбор части данных
+     *
+     * @param begin Начало части
+     * @param end Конец части
+     * @return Записи части (пустые строки пропускаются)
+     */
+    static std::vector<Record> parseChunk(const char *begin, const char *end);
+};
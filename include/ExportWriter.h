@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Потоковая выгрузка результатов запроса в файл CSV или NDJSON
+ *
+ * Строки форматируются в буфер фиксированного размера, который сбрасывается
+ * в файл по заполнении, поэтому объем памяти не зависит от количества строк.
+ * При сборке с zlib файл может сжиматься в формате gzip.
+ *
+ * Данные пишутся во временный файл <path>.part, который переименовывается
+ * в path только при успешном close(), как в MusicStoreDB::backupTo:
+ * прерванная выгрузка не оставляет усеченный файл под итоговым именем.
+ */
+class ExportWriter {
+public:
+    /**
+     * @brief Формат выгрузки
+     */
+    enum class Format {
+        Csv,   // CSV (RFC 4180) со строкой заголовков
+        Ndjson // Один JSON-объект на строку
+    };
+
+private:
+    Format format;                    // Формат выгрузки
+    std::string path;                 // Итоговый путь
+    std::string tempPath;             // Временный файл (<path>.part)
+    std::FILE *file;                  // Несжатый файл
+    void *gzHandle;                   // Сжатый файл (gzFile из zlib)
+    std::string buffer;               // Буфер записи
+    size_t bufferSize;                // Порог сброса буфера
+    std::vector<std::string> columns; // Ключи JSON (уже экранированные)
+    size_t fieldIndex;                // Номер текущего поля в строке
+    long long rowsWritten;            // Количество записанных строк
+    bool failed;                      // Произошла ошибка записи
+    bool closed;                      // Файл закрыт (переименован или удален)
+
+    /**
+     * @brief Начало очередного поля строки
+     */
+    void beginField();
+
+    /**
+     * @brief Сброс буфера в файл
+     */
+    void flush();
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * @param path Путь к файлу выгрузки (перезаписывается после успешной выгрузки)
+     * @param format Формат выгрузки
+     * @param compress Сжимать файл gzip
+     * @param bufferSize Размер буфера записи в байтах
+     */
+    ExportWriter(const std::string &path, Format format, bool compress = false,
+                 size_t bufferSize = 1 << 20);
+
+    /**
+     * @brief Деструктор (незакрытая выгрузка отменяется, как в discard())
+     */
+    ~ExportWriter();
+
+    ExportWriter(const ExportWriter &) = delete;
+    ExportWriter &operator=(const ExportWriter &) = delete;
+
+    /**
+     * @brief Проверка, открыт ли файл
+     */
+    bool isOpen() const { return file != nullptr || gzHandle != nullptr; }
+
+    /**
+     * @brief Установка названий колонок (для CSV записывается строка заголовков)
+     */
+    void setColumns(const std::vector<std::string> &names);
+
+    /**
+     * @brief Начало строки
+     */
+    void beginRow();
+
+    /**
+     * @brief Текстовое значение поля
+     */
+    void addText(std::string_view value);
+
+    /**
+     * @brief Числовое значение поля в текстовом виде (в JSON без кавычек)
+     */
+    void addNumber(std::string_view value);
+
+    /**
+     * @brief Отсутствующее значение (пустое поле CSV, null в JSON)
+     */
+    void addNull();
+
+    /**
+     * @brief Завершение строки
+     */
+    void endRow();
+
+    /**
+     * @brief Сброс буфера, закрытие файла и переименование в итоговый путь
+     *
+     * При ошибке записи временный файл удаляется, а итоговый не меняется.
+     *
+     * @return true если все данные записаны
+     */
+    bool close();
+
+    /**
+     * @brief Отмена выгрузки: временный файл удаляется, итоговый не меняется
+     */
+    void discard();
+
+    /**
+     * @brief Количество записанных строк
+     */
+    long long rowCount() const { return rowsWritten; }
+
+    /**
+     * @brief Проверка, собрана ли программа с поддержкой сжатия
+     */
+    static bool compressionAvailable();
+
+    /**
+     * @brief Определение формата по имени файла (.csv, .ndjson, .jsonl, с суффиксом .gz)
+     *
+     * @param path Путь к файлу
+     * @param format Результат: формат выгрузки
+     * @param compress Результат: нужно ли сжатие
+     * @return true если расширение распознано
+     */
+    static bool formatFromPath(const std::string &path, Format &format, bool &compress);
+};
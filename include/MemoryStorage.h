@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdio>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "StorageBackend.h"
+
+/**
+ * @brief Хранилище в оперативной памяти с журналом на диске
+ *
+ * Компакт-диски и произведения лежат в хеш-таблицах по идентификатору.
+ * Для каждого компакт-диска операции хранятся отсортированными по дате
+ * вместе с префиксными суммами поступлений и продаж, поэтому остаток
+ * читается за O(1), а суммы за период - двумя бинарными поисками.
+ *
+ * Каждое изменение дописывается строкой в журнал; при создании объекта
+ * журнал воспроизводится и состояние восстанавливается.
+ */
+class MemoryStorage : public StorageBackend {
+private:
+    struct Disc {
+        std::string productionDate; // Дата изготовления
+        std::string company;        // Компания-производитель
+        float price;                // Цена
+    };
+
+    struct Work {
+        std::string title;     // Название
+        std::string author;    // Автор
+        std::string performer; // Исполнитель
+        int compactId;         // Компакт-диск
+    };
+
+    /**
+     * @brief Операции одного компакт-диска
+     */
+    struct Ledger {
+        std::vector<int> dates;                // Даты операций (YYYYMMDD), по возрастанию
+        std::vector<long long> receivedPrefix; // Поступления до i-й операции (размер dates + 1)
+        std::vector<long long> soldPrefix;     // Продажи до i-й операции (размер dates + 1)
+        std::vector<int> workIds;              // Произведения на компакт-диске
+    };
+
+    std::unordered_map<int, Disc> discs;     // Компакт-диски
+    std::unordered_map<int, Work> works;     // Произведения
+    std::unordered_map<int, Ledger> ledgers; // Операции по компакт-дискам
+    int nextDiscId;                          // Следующий идентификатор компакт-диска
+    int nextWorkId;                          // Следующий идентификатор произведения
+    int nextOperationId;                     // Следующий идентификатор операции
+    std::FILE *journal;                      // Журнал изменений (nullptr - без журнала)
+    mutable std::shared_mutex mutex;         // Читатели параллельно, писатель монопольно
+
+    /**
+     * @brief Дописывание записи в журнал
+     */
+    void writeJournal(const std::vector<std::string> &fields);
+
+    /**
+     * @brief Воспроизведение журнала
+     *
+     * @return Количество примененных записей
+     */
+    size_t replayJournal(const std::string &path);
+
+    int applyAddDisc(int compactId, const std::string &productionDate, const std::string &company, float price);
+    int applyAddWork(int workId, const std::string &title, const std::string &author,
+                     const std::string &performer, int compactId);
+    bool applyUpdateDisc(int compactId, const std::string &company, float price);
+    bool applyDeleteDisc(int compactId);
+    int applyOperation(int operationId, int date, bool receipt, int compactId, int quantity);
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * @param journalPath Путь к журналу (пустая строка - хранить только в памяти)
+     */
+    explicit MemoryStorage(const std::string &journalPath = "");
+
+    /**
+     * @brief Деструктор
+     */
+    ~MemoryStorage() override;
+
+    MemoryStorage(const MemoryStorage &) = delete;
+    MemoryStorage &operator=(const MemoryStorage &) = delete;
+
+    int addCompactDisc(const std::string &productionDate, const std::string &company, float price) override;
+    int addMusicalWork(const std::string &title, const std::string &author,
+                       const std::string &performer, int compactId) override;
+    bool updateCompactDisc(int compactId, const std::string &company, float price) override;
+
+    /**
+     * @brief Удаление компакт-диска вместе с его произведениями
+     *
+     * Компакт-диск, по которому есть операции, не удаляется.
+     */
+    bool deleteCompactDisc(int compactId) override;
+
+    int registerOperation(const std::string &operationType, int compactId, int quantity,
+                          const std::string &operationDate) override;
+    long long getStockLevel(int compactId) override;
+    PeriodTotals getPeriodTotals(int compactId, const std::string &startDate,
+                                 const std::string &endDate) override;
+    std::vector<PerformerSales> getPerformerSales() override;
+    std::vector<AuthorSales> getAuthorSales() override;
+    InventoryValue getInventoryValue() override;
+
+    /**
+     * @brief Разбор даты YYYY-MM-DD в число YYYYMMDD
+     *
+     * @return Число или -1, если дата некорректна
+     */
+    static int parseDate(const std::string &date);
+};
@@ -1,9 +1,90 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <unordered_map>
 #include <string>
 #include <vector>
 #include <sqlite3.h>
+#include "ReportTypes.h"
+#include "ChangeLog.h"
+#include "TableWriter.h"
+#include "ExportWriter.h"
+#include "CsvParser.h"
+#include "AnalyticsSnapshot.h"
+#include "Query.h"
+#include "ReportArena.h"
+#include "CatalogCache.h"
+
+/**
+ * @brief Режим открытия базы данных
+ */
+enum class OpenMode {
+    ReadWrite, // Чтение и запись; схема создается и обновляется при открытии
+    ReadOnly,  // Только чтение (SQLITE_OPEN_READONLY), схема не изменяется
+    Immutable  // Только чтение неизменяемого файла (immutable=1): SQLite не использует блокировки
+};
+
+/**
+ * @brief Пользователь, прошедший проверку пароля
+ */
+struct AuthenticatedUser {
+    int userId;           // Идентификатор пользователя
+    std::string username; // Имя пользователя
+    bool admin;           // Пользователь - администратор
+    bool needsRehash;     // Пароль хранится в открытом виде и должен быть заменен хешем
+};
+
+/**
+ * @brief Выбор компакт-дисков для пакетных операций над каталогом
+ *
+ * Заданные условия объединяются через И. Весь каталог выбирается только
+ * явно (all = true): выбор без условий отклоняется, чтобы ошибка в
+ * аргументах не затронула все диски.
+ */
+struct DiscSelection {
+    std::vector<int> compactIds; // Идентификаторы (пусто - любые)
+    std::string company;         // Компания-производитель (пусто - любая)
+    bool all = false;            // Выбрать весь каталог
+};
+
+/**
+ * @brief Ожидание блокировки базы, занятой другим соединением или процессом
+ *
+ * Пока блокировка занята, попытки повторяются с экспоненциально растущей
+ * паузой, выбираемой случайно из [delay / 2, delay], чтобы ожидающие
+ * терминалы не просыпались одновременно.
+ */
+struct BusyPolicy {
+    std::chrono::milliseconds timeout{5000};   // Наибольшее время ожидания одной блокировки
+    std::chrono::milliseconds initialDelay{1}; // Первая пауза
+    std::chrono::milliseconds maxDelay{100};   // Наибольшая пауза
+    int writeRetries = 3;                      // Повторов записи после истечения ожидания
+};
+
+/**
+ * @brief Счетчики ожидания блокировок соединения
+ */
+struct LockStats {
+    long long waits;        // Запросов, ожидавших блокировку
+    long long busyCalls;    // Вызовов обработчика занятости (пауз)
+    long long waitedMicros; // Суммарное время ожидания, мкс
+    long long timeouts;     // Ожиданий, завершившихся SQLITE_BUSY
+    long long writeRetries; // Повторов записи после SQLITE_BUSY
+};
+
+/**
+ * @brief Причина прерывания запроса
+ */
+enum class QueryInterrupt {
+    None,      // Запрос не прерывался
+    Cancelled, // Отменен вызовом cancelQuery()
+    Timeout    // Превышено время выполнения
+};
 
 /**
  * @brief Класс для работы с базой данных музыкального салона
@@ -13,9 +94,33 @@ class MusicStoreDB
 private:
     sqlite3 *db;        // Указатель на соединение с базой данных
     std::string dbPath; // Путь к файлу базы данных
+    OpenMode openMode;  // Режим открытия базы данных
     bool isAdmin;       // Признак того, что пользователь - администратор
     int userId;         // Идентификатор текущего пользователя
-    static bool headers;
+    TableWriter::Format outputFormat; // Формат вывода отчетов
+    std::unique_ptr<ChangeLog> changeLog;     // Журнал изменений (если включен)
+    std::vector<ChangeRecord> pendingChanges; // Изменения текущей транзакции
+    std::vector<ChangeRecord> committingChanges; // Изменения фиксируемой транзакции (до завершения COMMIT)
+    bool changeFeedWal;                       // Журнал изменений пополняется из WAL hook
+    std::chrono::milliseconds queryTimeout;               // Ограничение времени запроса (0 - нет)
+    std::chrono::steady_clock::time_point queryStart;     // Начало текущего запроса
+    std::function<void(long long)> progressCallback;      // Уведомление о ходе выполнения
+    long long progressSteps;                              // Шагов виртуальной машины в текущем запросе
+    std::atomic<bool> cancelRequested;                    // Запрошена отмена
+    std::atomic<bool> timedOut;                           // Запрос прерван по времени
+    StatementCache statements;                            // Кеш подготовленных запросов
+    BusyPolicy busyPolicy;                                // Ожидание занятой блокировки
+    std::chrono::steady_clock::time_point busyStart;      // Начало текущего ожидания
+    std::atomic<long long> lockWaits;                     // Счетчики LockStats
+    std::atomic<long long> busyCalls;
+    std::atomic<long long> lockWaitMicros;
+    std::atomic<long long> lockTimeouts;
+    std::atomic<long long> writeRetries;
+    std::shared_ptr<CatalogCache> catalog;                // Кеш каталога для отчетов
+    long long catalogDataVersion;                         // PRAGMA data_version при последней проверке кеша
+    long long catalogVersion;                             // Значение catalog_version при последней проверке
+    bool catalogDirty;                                    // Каталог изменен в незафиксированной транзакции
+    bool catalogChecked;                                  // catalog_version проверен в текущей транзакции
 
     /**
      * @brief Выполнение SQL-запроса без возврата результатов
@@ -25,37 +130,279 @@ private:
      */
     bool executeQuery(const std::string &sql);
 
+    /**
+     * @brief Выполнение записи с повтором, если база занята
+     *
+     * Отклоненная с SQLITE_BUSY команда ничего не изменила, поэтому ее
+     * можно повторить, в том числе COMMIT.
+     *
+     * @param sql SQL-запрос
+     * @return true если запрос выполнен успешно
+     */
+    bool executeWrite(const std::string &sql);
+
+    /**
+     * @brief Шаг изменяющего запроса с повтором, если база занята
+     *
+     * @return Код sqlite3_step последней попытки
+     */
+    int stepWrite(sqlite3_stmt *stmt);
+
+    /**
+     * @brief Обработчик занятости SQLite: пауза со случайным разбросом
+     *
+     * @return 0 - прекратить ожидание (запрос получит SQLITE_BUSY)
+     */
+    static int busyHandler(void *self, int count);
+
+    /**
+     * @brief Текущий снимок каталога (при пустом кеше загружается из базы)
+     *
+     * Внутри транзакции, изменившей каталог, снимок загружается только для
+     * этого соединения и в общий кеш не публикуется.
+     */
+    std::shared_ptr<const CatalogSnapshot> catalogSnapshot();
+
+    /**
+     * @brief Сброс кеша каталога, если каталог изменило другое соединение или процесс
+     *
+     * PRAGMA data_version меняется после фиксации транзакции любым другим
+     * соединением; тогда сравнивается счетчик catalog_version, который
+     * увеличивают триггеры на compact_discs и musical_works.
+     *
+     * Внутри транзакции снимок базы не меняется, поэтому проверка
+     * выполняется один раз на транзакцию; признак сбрасывается, когда
+     * executeQuery или executeWrite начинают новую транзакцию.
+     */
+    void checkCatalogVersion();
+
+    /**
+     * @brief Изменение кеша каталога после записи этим соединением
+     *
+     * Внутри транзакции изменение откладывается: кеш сбрасывается после ее
+     * завершения, чтобы другие соединения не видели несфиксированных данных.
+     */
+    void updateCatalog(const std::function<void(CatalogCache &)> &change);
+
+    /**
+     * @brief Компакт-диск из снимка каталога, при промахе - из базы
+     *
+     * @param snapshot Снимок каталога (может быть nullptr)
+     * @param compactId Идентификатор компакт-диска
+     * @param loaded Место для диска, прочитанного из базы
+     * @return Компакт-диск или nullptr, если его нет
+     */
+    const CatalogDisc *findDisc(const CatalogSnapshot *snapshot, int compactId, CatalogDisc &loaded);
+
+    /**
+     * @brief Продажи выбранных компакт-дисков через временную таблицу
+     *
+     * @param snapshot Снимок каталога, уже полученный отчетом
+     */
+    DiscSalesReport collectDiscSales(const std::shared_ptr<const CatalogSnapshot> &snapshot,
+                                     const std::vector<int> &compactIds, const std::string &startDate,
+                                     const std::string &endDate);
+
+    /**
+     * @brief Вывод отчета по нескольким компакт-дискам
+     */
+    void printDiscSales(const std::string &title, const DiscSalesReport &report);
+
+    /**
+     * @brief Заполнение временной таблицы selected_discs
+     *
+     * @return true если идентификаторы записаны
+     */
+    bool selectDiscs(const std::vector<int> &compactIds);
+
+    /**
+     * @brief Пакетная операция над выбранными компакт-дисками в одной транзакции
+     *
+     * @param selection Выбор компакт-дисков
+     * @param dryRun Только подсчитать затрагиваемые диски
+     * @param count Подсчет (аргумент - признак выбора по идентификаторам)
+     * @param apply Изменение одним запросом
+     * @return Количество затронутых дисков или -1 при ошибке
+     */
+    long long runBulkOperation(const DiscSelection &selection, bool dryRun,
+                               const std::function<std::optional<long long>(int)> &count,
+                               const std::function<bool(int)> &apply);
+
     /**
      * @brief Callback-функция для обработки результатов запроса
      */
     static int callback(void *data, int argc, char **argv, char **azColName);
 
     /**
-     * @brief Callback-функция для вывода результатов запроса
+     * @brief Callback-функция для накопления результатов запроса в TableWriter
      */
-    static int printCallback(void *notUsed, int argc, char **argv, char **azColName);
+    static int tableCallback(void *writer, int argc, char **argv, char **azColName);
+
+    /**
+     * @brief Вывод заголовка отчета (только в текстовом формате)
+     *
+     * @param title Название отчета
+     */
+    void printTitle(const std::string &title);
 
     /**
      * @brief Инициализация базы данных (создание таблиц, индексов, триггеров)
      */
     void initializeDB();
 
+    /**
+     * @brief Проверка, что база данных открыта для записи
+     *
+     * @return true если запись разрешена; иначе выводится сообщение об ошибке
+     */
+    bool ensureWritable();
+
+    /**
+     * @brief Сохранение статистики за период в таблицу report_results
+     *
+     * @return true если статистика сохранена
+     */
+    bool storePeriodStatistics(const std::string &startDate, const std::string &endDate);
+
+    /**
+     * @brief Проверка существования таблицы
+     *
+     * @param name Имя таблицы
+     * @return true если таблица есть в схеме
+     */
+    bool tableExists(const std::string &name);
+
+    /**
+     * @brief Преобразование пользовательской строки в запрос FTS5
+     *
+     * Каждое слово ищется по префиксу; префикс поля ("author:бах")
+     * ограничивает поиск одной колонкой.
+     */
+    static std::string buildMatchQuery(const std::string &text);
+
+    /**
+     * @brief Потоковая выгрузка результата подготовленного запроса в файл
+     *
+     * Строки читаются из запроса по одной и сразу форматируются в буфер
+     * писателя, поэтому результат целиком в памяти не хранится.
+     *
+     * @param stmt Подготовленный запрос (освобождается методом)
+     * @param path Путь к файлу выгрузки
+     * @param format Формат выгрузки
+     * @param compress Сжимать файл gzip
+     * @return Количество выгруженных строк или -1 при ошибке
+     */
+    long long exportStatement(sqlite3_stmt *stmt, const std::string &path,
+                              ExportWriter::Format format, bool compress);
+
+    /**
+     * @brief Вставка одной записи импорта
+     *
+     * @param kind Вид данных
+     * @param record Значения полей записи
+     * @param columns Номера нужных полей в записи (в порядке, описанном в ImportKind)
+     * @param insert Подготовленный запрос вставки
+     * @param insertKey Подготовленный запрос сохранения внешнего ключа (для дисков)
+     * @param keys Соответствие внешних ключей идентификаторам компакт-дисков
+     * @param error Описание ошибки для отклоненной записи
+     * @return 1 - запись добавлена, 0 - пропущена, -1 - отклонена
+     */
+    int importRecord(ImportKind kind, const CsvParser::Record &record, const std::vector<size_t> &columns,
+                     sqlite3_stmt *insert, sqlite3_stmt *insertKey,
+                     std::unordered_map<std::string, int> &keys, std::string &error);
+
+    /**
+     * @brief Hook SQLite: фиксирует изменение строки в текущей транзакции
+     */
+    static void updateHook(void *self, int op, const char *dbName, const char *table, sqlite3_int64 rowId);
+
+    /**
+     * @brief Hook SQLite: откладывает изменения транзакции до завершения фиксации
+     *
+     * Вызывается до записи COMMIT, который еще может завершиться ошибкой,
+     * поэтому в WAL изменения попадают в журнал только из walHook.
+     */
+    static int commitHook(void *self);
+
+    /**
+     * @brief Hook SQLite: переносит изменения в журнал после успешной фиксации в WAL
+     *
+     * Заменяет автоматическую контрольную точку SQLite, поэтому выполняет ее сам.
+     */
+    static int walHook(void *self, sqlite3 *db, const char *dbName, int pages);
+
+    /**
+     * @brief Hook SQLite: отбрасывает изменения отмененной транзакции
+     */
+    static void rollbackHook(void *self);
+
+    /**
+     * @brief Установка или снятие обработчиков хода выполнения запросов
+     */
+    void updateProgressHandler();
+
+    /**
+     * @brief Обработчик хода выполнения SQLite: проверка отмены и ограничения времени
+     *
+     * @return Ненулевое значение прерывает запрос
+     */
+    static int progressHandler(void *self);
+
+    /**
+     * @brief Трассировка SQLite: отметка начала очередного запроса
+     */
+    static int traceHandler(unsigned type, void *self, void *stmt, void *sql);
+
 public:
     /**
      * @brief Конструктор
      *
+     * В режимах только для чтения схема не создается и пользователи по
+     * умолчанию не добавляются: база должна быть подготовлена заранее
+     * (например, ночная копия). Методы изменения данных в этих режимах
+     * возвращают ошибку.
+     *
+     * База для записи переводится в режим WAL, чтобы несколько процессов
+     * могли работать с одним файлом: чтение не ждет записи, а запись ждет
+     * блокировку по BusyPolicy вместо немедленной ошибки SQLITE_BUSY.
+     *
      * @param dbPath Путь к файлу базы данных
+     * @param mode Режим открытия
      */
-    MusicStoreDB(const std::string &dbPath);
+    MusicStoreDB(const std::string &dbPath, OpenMode mode = OpenMode::ReadWrite);
 
     /**
      * @brief Деструктор
      */
     ~MusicStoreDB();
 
+    /**
+     * @brief Проверка имени и пароля без входа
+     *
+     * Состояние соединения (текущий пользователь) не меняется, поэтому
+     * метод подходит для сервера, где одно соединение обслуживает многих
+     * пользователей. Пароль проверяется PBKDF2 (см. PasswordHash).
+     *
+     * @param username Имя пользователя
+     * @param password Пароль
+     * @return Пользователь или std::nullopt, если имя или пароль неверны
+     */
+    std::optional<AuthenticatedUser> authenticate(const std::string &username, const std::string &password);
+
+    /**
+     * @brief Сохранение хеша пароля пользователя
+     *
+     * @param userId Идентификатор пользователя
+     * @param passwordHash Хеш, полученный PasswordHash::hash()
+     * @return true если хеш сохранен
+     */
+    bool updatePasswordHash(int userId, const std::string &passwordHash);
+
     /**
      * @brief Аутентификация пользователя
      *
+     * Пароль, сохраненный в открытом виде, при успешном входе заменяется хешем.
+     *
      * @param username Имя пользователя
      * @param password Пароль
      * @return true если аутентификация успешна
@@ -67,6 +414,36 @@ public:
      */
     void showCompactInventory();
 
+    /**
+     * @brief Страница складского отчета (keyset-пагинация)
+     *
+     * Строки упорядочены по убыванию остатка, затем по убыванию
+     * идентификатора; страница читается по индексу без OFFSET.
+     *
+     * @param pageSize Размер страницы
+     * @param token Токен продолжения из предыдущей страницы (пустой - первая страница)
+     * @return Страница строк и токен следующей страницы
+     */
+    Page<InventoryRow> getCompactInventoryPage(int pageSize, const std::string &token = "");
+
+    /**
+     * @brief Вывод страницы складского отчета
+     *
+     * @param pageSize Размер страницы
+     * @param token Токен продолжения (пустой - первая страница)
+     * @return Токен следующей страницы (пустой - страница последняя)
+     */
+    std::string showCompactInventoryPage(int pageSize, const std::string &token = "");
+
+    /**
+     * @brief Страница каталога произведений (keyset-пагинация по названию)
+     *
+     * @param pageSize Размер страницы
+     * @param token Токен продолжения (пустой - первая страница)
+     * @return Страница строк и токен следующей страницы
+     */
+    Page<CatalogRow> getCatalogPage(int pageSize, const std::string &token = "");
+
     /**
      * @brief Получение информации о продажах компакт-диска за период
      *
@@ -76,6 +453,42 @@ public:
      */
     void showCompactSales(int compactId, const std::string &startDate, const std::string &endDate);
 
+    /**
+     * @brief Продажи нескольких компакт-дисков за период одним запросом
+     *
+     * Идентификаторы помещаются во временную таблицу, продажи считаются
+     * одним сгруппированным запросом с соединением по ней. Неизвестные
+     * идентификаторы пропускаются, диски без продаж выводятся с нулями.
+     *
+     * @param compactIds Идентификаторы компакт-дисков
+     * @param startDate Начальная дата периода
+     * @param endDate Конечная дата периода
+     * @return Продажи по дискам и итоги
+     */
+    DiscSalesReport getDiscSales(const std::vector<int> &compactIds, const std::string &startDate,
+                                 const std::string &endDate);
+
+    /**
+     * @brief Продажи всех компакт-дисков компании за период
+     *
+     * @param company Компания-производитель
+     * @param startDate Начальная дата периода
+     * @param endDate Конечная дата периода
+     * @return Продажи по дискам и итоги
+     */
+    DiscSalesReport getCompanySales(const std::string &company, const std::string &startDate,
+                                    const std::string &endDate);
+
+    /**
+     * @brief Вывод продаж нескольких компакт-дисков с итоговой строкой
+     */
+    void showDiscSales(const std::vector<int> &compactIds, const std::string &startDate, const std::string &endDate);
+
+    /**
+     * @brief Вывод продаж компакт-дисков компании с итоговой строкой
+     */
+    void showCompanySales(const std::string &company, const std::string &startDate, const std::string &endDate);
+
     /**
      * @brief Получение информации о самом популярном компакт-диске
      */
@@ -91,6 +504,57 @@ public:
      */
     void showAuthorSales();
 
+    /**
+     * @brief Продажи по исполнителям (без вывода на экран)
+     *
+     * @return Список исполнителей с количеством проданных экземпляров
+     */
+    std::vector<PerformerSales> getPerformerSales();
+
+    /**
+     * @brief Продажи по авторам (без вывода на экран)
+     *
+     * @return Список авторов с количеством продаж и выручкой
+     */
+    std::vector<AuthorSales> getAuthorSales();
+
+    /**
+     * @brief Сводная стоимость запасов (без вывода на экран)
+     *
+     * @return Суммарные поступления, продажи, остаток и его стоимость
+     */
+    InventoryValue getInventoryValue();
+
+    /**
+     * @brief Текущий остаток компакт-диска
+     *
+     * @param compactId Идентификатор компакт-диска
+     * @return Остаток или -1, если компакт-диск не найден
+     */
+    long long getStockLevel(int compactId);
+
+    /**
+     * @brief Остатки всех компакт-дисков
+     */
+    std::vector<StockLevel> getStockLevels();
+
+    /**
+     * @brief Поступления и продажи компакт-диска за период (без вывода на экран)
+     *
+     * @param compactId Идентификатор компакт-диска
+     * @param startDate Начальная дата периода
+     * @param endDate Конечная дата периода
+     */
+    PeriodTotals getPeriodTotals(int compactId, const std::string &startDate, const std::string &endDate);
+
+    /**
+     * @brief Загрузка каталога и операций в колоночный аналитический снимок
+     *
+     * @param snapshot Пустой снимок; после успешной загрузки он построен
+     * @return true, если данные прочитаны полностью
+     */
+    bool loadAnalyticsSnapshot(AnalyticsSnapshot &snapshot);
+
     /**
      * @brief Получение информации о продажах компакт-диска за период
      *
@@ -108,14 +572,133 @@ public:
      */
     void calculatePeriodStatistics(const std::string &startDate, const std::string &endDate);
 
+    /**
+     * @brief Сравнение поступлений, продаж и выручки за несколько периодов
+     *
+     * Все периоды считаются одним проходом по операциям: каждая операция
+     * сопоставляется с периодами, в которые попадает ее дата (периоды
+     * могут пересекаться), и суммируется с условием по типу операции.
+     * Выручка считается по текущей цене компакт-диска.
+     *
+     * @param periods Периоды в порядке сравнения
+     * @return Показатели по дискам и итоги с изменениями относительно предыдущего периода
+     */
+    PeriodComparison comparePeriods(const std::vector<ReportPeriod> &periods);
+
+    /**
+     * @brief Вывод сравнения периодов с итоговой строкой
+     */
+    void showPeriodComparison(const std::vector<ReportPeriod> &periods);
+
+    /**
+     * @brief Временной ряд продаж и выручки по интервалам
+     *
+     * Ряд строится по дневной сводке daily_sales (поддерживается
+     * триггерами на operations) одним упорядоченным проходом: скользящие
+     * средние и накопительные итоги считаются оконными функциями.
+     * Интервалы без продаж в ряд не попадают, но в скользящем среднем
+     * учитываются как нулевые; до начала ряда окно укорачивается.
+     *
+     * @param bucket Длина интервала
+     * @param grouping Группировка рядов
+     * @param startDate Начальная дата периода
+     * @param endDate Конечная дата периода
+     * @param window Окно скользящего среднего в интервалах
+     * @return Точки рядов по ключу и времени
+     */
+    std::vector<SalesSeriesPoint> getSalesSeries(SeriesBucket bucket, SeriesGrouping grouping,
+                                                 const std::string &startDate, const std::string &endDate,
+                                                 int window = 7);
+
+    /**
+     * @brief Вывод временного ряда продаж
+     */
+    void showSalesSeries(SeriesBucket bucket, SeriesGrouping grouping, const std::string &startDate,
+                         const std::string &endDate, int window = 7);
+
+    /**
+     * @brief Полнотекстовый поиск по каталогу произведений
+     *
+     * @param text Строка поиска (слова по названию, автору, исполнителю)
+     * @param limit Размер страницы
+     * @param offset Смещение страницы
+     * @return Произведения с информацией о компакт-диске, по убыванию релевантности
+     */
+    std::vector<CatalogSearchResult> searchCatalog(const std::string &text, int limit = 20, int offset = 0);
+
+    /**
+     * @brief Вывод страницы результатов поиска по каталогу
+     *
+     * @param text Строка поиска
+     * @param page Номер страницы (с 1)
+     * @param pageSize Размер страницы
+     * @return true если после этой страницы есть еще результаты
+     */
+    bool showCatalogSearch(const std::string &text, int page = 1, int pageSize = 20);
+
+    /**
+     * @brief Выгрузка операций за период в файл CSV или NDJSON
+     *
+     * @param path Путь к файлу выгрузки
+     * @param startDate Начальная дата периода
+     * @param endDate Конечная дата периода
+     * @param format Формат выгрузки
+     * @param compress Сжимать файл gzip
+     * @return Количество выгруженных операций или -1 при ошибке
+     */
+    long long exportOperations(const std::string &path, const std::string &startDate,
+                               const std::string &endDate, ExportWriter::Format format,
+                               bool compress = false);
+
+    /**
+     * @brief Выгрузка каталога (произведения с данными компакт-дисков)
+     *
+     * @param path Путь к файлу выгрузки
+     * @param format Формат выгрузки
+     * @param compress Сжимать файл gzip
+     * @return Количество выгруженных строк или -1 при ошибке
+     */
+    long long exportCatalog(const std::string &path, ExportWriter::Format format, bool compress = false);
+
+    /**
+     * @brief Выгрузка отчета в файл
+     *
+     * @param report Название отчета: "inventory", "performers" или "authors"
+     * @param path Путь к файлу выгрузки
+     * @param format Формат выгрузки
+     * @param compress Сжимать файл gzip
+     * @return Количество выгруженных строк или -1 при ошибке
+     */
+    long long exportReport(const std::string &report, const std::string &path,
+                           ExportWriter::Format format, bool compress = false);
+
+    /**
+     * @brief Импорт CSV-файла компакт-дисков, произведений или операций
+     *
+     * Файл разбирается частями в нескольких потоках, а вставка выполняется
+     * одним соединением пакетами по transactionRows записей. Первая строка
+     * файла - заголовки колонок. Компакт-диски идентифицируются внешним
+     * ключом disc_key, соответствие которого compact_id сохраняется в базе,
+     * поэтому произведения и операции можно импортировать отдельными файлами.
+     *
+     * @param kind Вид данных
+     * @param path Путь к CSV-файлу
+     * @param threads Количество потоков разбора (0 - по числу ядер)
+     * @param transactionRows Количество записей в одной транзакции
+     * @return Итог импорта
+     */
+    ImportResult importCsv(ImportKind kind, const std::string &path, unsigned threads = 0,
+                           int transactionRows = 50000);
+
     /**
      * @brief Добавление нового компакт-диска
      *
      * @param productionDate Дата изготовления
      * @param company Компания-производитель
      * @param price Цена
+     * @return Идентификатор нового компакт-диска или -1 при ошибке
      */
-    void addCompactDisc(const std::string &productionDate, const std::string &company, float price);
+    int addCompactDisc(const std::string &productionDate, const std::string &company, float price);
 
     /**
      * @brief Добавление музыкального произведения
@@ -124,9 +707,10 @@ public:
      * @param author Автор произведения
      * @param performer Исполнитель
      * @param compactId Идентификатор компакт-диска
+     * @return Идентификатор нового произведения или -1 при ошибке
      */
-    void addMusicalWork(const std::string &title, const std::string &author,
-                        const std::string &performer, int compactId);
+    int addMusicalWork(const std::string &title, const std::string &author,
+                       const std::string &performer, int compactId);
 
     /**
      * @brief Регистрация операции (поступление/продажа)
@@ -134,8 +718,11 @@ public:
      * @param operationType Тип операции ("поступление" или "продажа")
      * @param compactId Идентификатор компакт-диска
      * @param quantity Количество
+     * @param operationDate Дата операции (YYYY-MM-DD; пустая строка - текущая дата)
+     * @return Идентификатор операции или -1 при ошибке
      */
-    void registerOperation(const std::string &operationType, int compactId, int quantity);
+    int registerOperation(const std::string &operationType, int compactId, int quantity,
+                          const std::string &operationDate = "");
 
     /**
      * @brief Обновление информации о компакт-диске
@@ -143,15 +730,207 @@ public:
      * @param compactId Идентификатор компакт-диска
      * @param company Компания-производитель
      * @param price Цена
+     * @return true если изменение выполнено
      */
-    void updateCompactDisc(int compactId, const std::string &company, float price);
+    bool updateCompactDisc(int compactId, const std::string &company, float price);
 
     /**
      * @brief Удаление компакт-диска
      *
      * @param compactId Идентификатор компакт-диска
+     * @return true если удаление выполнено
+     */
+    bool deleteCompactDisc(int compactId);
+
+    /**
+     * @brief Изменение цены выбранных компакт-дисков на процент
+     *
+     * Все диски изменяются одним запросом UPDATE в одной транзакции; новая
+     * цена округляется до копеек и не опускается ниже 0.01.
+     *
+     * @param selection Выбор компакт-дисков
+     * @param percent Изменение в процентах (например, -15 - скидка 15%)
+     * @param dryRun Только подсчитать диски, не изменяя цены
+     * @return Количество дисков или -1 при ошибке
+     */
+    long long repriceDiscs(const DiscSelection &selection, double percent, bool dryRun = false);
+
+    /**
+     * @brief Смена компании-производителя выбранных компакт-дисков
+     *
+     * @param selection Выбор компакт-дисков
+     * @param company Новая компания
+     * @param dryRun Только подсчитать диски
+     * @return Количество дисков или -1 при ошибке
+     */
+    long long reassignCompany(const DiscSelection &selection, const std::string &company, bool dryRun = false);
+
+    /**
+     * @brief Удаление выбранных компакт-дисков, по которым не было операций
+     *
+     * @param selection Выбор компакт-дисков
+     * @param dryRun Только подсчитать диски
+     * @return Количество дисков или -1 при ошибке
+     */
+    long long deleteUnsoldDiscs(const DiscSelection &selection, bool dryRun = false);
+
+    /**
+     * @brief Начало транзакции
+     *
+     * Транзакция сразу берет блокировку записи (BEGIN IMMEDIATE): в режиме
+     * WAL отложенная транзакция, прочитавшая устаревший снимок, не может
+     * дождаться записи и сразу получает SQLITE_BUSY.
+     *
+     * @return true если транзакция начата
      */
-    void deleteCompactDisc(int compactId);
+    bool beginTransaction();
+
+    /**
+     * @brief Фиксация транзакции
+     *
+     * @return true если транзакция зафиксирована
+     */
+    bool commitTransaction();
+
+    /**
+     * @brief Откат транзакции
+     *
+     * @return true если транзакция отменена
+     */
+    bool rollbackTransaction();
+
+    /**
+     * @brief Признак открытой транзакции
+     *
+     * SQLite сам откатывает транзакцию после некоторых ошибок (SQLITE_FULL,
+     * SQLITE_IOERR и т.п.); по этому признаку вызывающий код узнает об откате.
+     *
+     * @return true если соединение находится внутри транзакции
+     */
+    bool inTransaction() const { return !sqlite3_get_autocommit(db); }
+
+    /**
+     * @brief Горячее резервное копирование базы данных
+     *
+     * Копия снимается через online backup API небольшими порциями страниц
+     * с паузами, поэтому запись в базу во время копирования не блокируется.
+     * Изменения, сделанные через это же соединение, переносятся в копию
+     * автоматически; если копирование перезапускается из-за записи другим
+     * процессом, порция страниц увеличивается. Копия сначала пишется во
+     * временный файл, переводится из режима WAL в обычный журнал (чтобы
+     * копию можно было открыть OpenMode::ReadOnly на разделе только для
+     * чтения), проверяется PRAGMA integrity_check и только затем
+     * переименовывается (или сжимается gzip) в итоговый файл. Внутри
+     * открытой транзакции копирование не выполняется; если база остается
+     * заблокированной дольше BusyPolicy::timeout, копирование прерывается.
+     *
+     * @param path Путь к файлу резервной копии
+     * @param compress Сжать копию gzip (требуется сборка с zlib)
+     * @param pagesPerStep Количество страниц за один шаг копирования
+     * @param pause Пауза между шагами
+     * @param progress Функция, получающая число оставшихся и общее число страниц
+     * @return true если копия создана и прошла проверку целостности
+     */
+    bool backupTo(const std::string &path, bool compress = false, int pagesPerStep = 128,
+                  std::chrono::milliseconds pause = std::chrono::milliseconds(10),
+                  std::function<void(int, int)> progress = nullptr);
+
+    /**
+     * @brief Включение журнала изменений (change data capture)
+     *
+     * Вставки, изменения и удаления в operations, compact_discs и
+     * musical_works записываются в журнал при фиксации транзакции.
+     * Журнал пишет только одно соединение: если он уже открыт для записи
+     * другим экземпляром программы, журнал не включается.
+     *
+     * @param logPath Путь к файлу журнала
+     * @return true если журнал открыт
+     */
+    bool enableChangeFeed(const std::string &logPath);
+
+    /**
+     * @brief Журнал изменений
+     *
+     * @return Указатель на журнал или nullptr, если он не включен
+     */
+    const ChangeLog *getChangeFeed() const { return changeLog.get(); }
+
+    /**
+     * @brief Установка формата вывода отчетов
+     *
+     * @param format Текстовая таблица, CSV, TSV или JSON
+     */
+    void setOutputFormat(TableWriter::Format format) { outputFormat = format; }
+
+    /**
+     * @brief Ограничение времени выполнения одного запроса
+     *
+     * Запрос, выполняющийся дольше, прерывается с ошибкой SQLITE_INTERRUPT.
+     *
+     * @param timeout Ограничение (0 - без ограничения)
+     */
+    void setQueryTimeout(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Уведомление о ходе выполнения запросов
+     *
+     * Функция вызывается из потока, выполняющего запрос, примерно каждые
+     * несколько тысяч шагов виртуальной машины SQLite.
+     *
+     * @param callback Функция, получающая число шагов текущего запроса (пустая - отключить)
+     */
+    void setProgressCallback(std::function<void(long long)> callback);
+
+    /**
+     * @brief Отмена выполняющегося запроса (можно вызывать из другого потока)
+     *
+     * Отмена действует и на последующие запросы до вызова resetInterrupt(),
+     * чтобы отчет из нескольких запросов прерывался целиком.
+     */
+    void cancelQuery();
+
+    /**
+     * @brief Сброс признаков отмены и превышения времени
+     */
+    void resetInterrupt();
+
+    /**
+     * @brief Причина прерывания запросов после последнего resetInterrupt()
+     */
+    QueryInterrupt lastInterrupt() const;
+
+    /**
+     * @brief Кеш каталога этого соединения
+     */
+    std::shared_ptr<CatalogCache> getCatalogCache() const { return catalog; }
+
+    /**
+     * @brief Общий кеш каталога для нескольких соединений одного процесса
+     *
+     * Изменения каталога через любое из соединений видны остальным;
+     * изменения из других процессов - после CatalogCache::invalidate().
+     */
+    void setCatalogCache(std::shared_ptr<CatalogCache> cache) { catalog = std::move(cache); }
+
+    /**
+     * @brief Настройка ожидания блокировки базы
+     */
+    void setBusyPolicy(const BusyPolicy &policy) { busyPolicy = policy; }
+
+    /**
+     * @brief Счетчики ожидания блокировок с момента открытия или resetLockStats()
+     */
+    LockStats getLockStats() const;
+
+    /**
+     * @brief Обнуление счетчиков ожидания блокировок
+     */
+    void resetLockStats();
+
+    /**
+     * @brief Проверка, открыта ли база данных только для чтения
+     */
+    bool isReadOnly() const { return openMode != OpenMode::ReadWrite; }
 
     /**
      * @brief Проверка, является ли текущий пользователь администратором
@@ -159,4 +938,11 @@ public:
      * @return true если пользователь администратор
      */
     bool isUserAdmin() const { return isAdmin; }
+
+    /**
+     * @brief Идентификатор текущего пользователя
+     *
+     * @return Идентификатор или -1, если вход не выполнен
+     */
+    int getUserId() const { return userId; }
 };
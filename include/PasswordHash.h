@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Хеширование паролей PBKDF2-HMAC-SHA256 с солью
+ *
+ * Хеш хранится строкой "pbkdf2-sha256$<итерации>$<соль hex>$<ключ hex>",
+ * поэтому число итераций можно увеличивать без миграции: старые хеши
+ * проверяются со своим числом итераций. Строки без префикса считаются
+ * паролями, сохраненными в открытом виде (до появления хеширования).
+ */
+class PasswordHash {
+public:
+    static constexpr int DEFAULT_ITERATIONS = 100000; // Итераций для новых хешей
+    static constexpr size_t SALT_SIZE = 16;           // Байт соли
+    static constexpr size_t KEY_SIZE = 32;            // Байт ключа
+
+    using Digest = std::array<uint8_t, 32>;
+
+    /**
+     * @brief SHA-256 (FIPS 180-4)
+     */
+    static Digest sha256(std::string_view data);
+
+    /**
+     * @brief HMAC-SHA256 (RFC 2104)
+     */
+    static Digest hmacSha256(std::string_view key, std::string_view message);
+
+    /**
+     * @brief PBKDF2-HMAC-SHA256 (RFC 8018)
+     *
+     * @param password Пароль
+     * @param salt Соль
+     * @param iterations Количество итераций
+     * @param length Длина ключа в байтах
+     * @return Ключ
+     */
+    static std::string pbkdf2(std::string_view password, std::string_view salt, int iterations, size_t length);
+
+    /**
+     * @brief Хеш пароля со случайной солью
+     *
+     * @param password Пароль
+     * @param iterations Количество итераций
+     * @return Строка для хранения в users.password_hash
+     */
+    static std::string hash(std::string_view password, int iterations = DEFAULT_ITERATIONS);
+
+    /**
+     * @brief Проверка пароля по хешу (сравнение за постоянное время)
+     *
+     * @param password Введенный пароль
+     * @param stored Сохраненный хеш
+     * @return true если пароль совпадает
+     */
+    static bool verify(std::string_view password, std::string_view stored);
+
+    /**
+     * @brief Проверка, является ли сохраненное значение хешем
+     */
+    static bool isHashed(std::string_view stored);
+
+    /**
+     * @brief Случайные байты из системного источника энтропии
+     */
+    static std::string randomBytes(size_t count);
+
+    /**
+     * @brief Шестнадцатеричная запись байтов
+     */
+    static std::string toHex(std::string_view bytes);
+};
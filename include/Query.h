@@ -0,0 +1,427 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <sqlite3.h>
+
+/**
+ * @brief Количество параметров SQL-запроса на этапе компиляции
+ *
+ * Поддерживаются параметры ? и ?NNN: как и в SQLite, ?NNN задает номер явно,
+ * а ? получает номер на единицу больше наибольшего. Строковые литералы,
+ * идентификаторы в кавычках и комментарии пропускаются.
+ *
+ * @return Количество параметров или -1, если в запросе есть именованные параметры
+ */
+constexpr int sqlParameterCount(const char *sql) {
+    int count = 0;
+    for (std::size_t i = 0; sql[i] != '\0'; i++) {
+        char c = sql[i];
+        if (c == '\'' || c == '"' || c == '`' || c == '[') {
+            char close = c == '[' ? ']' : c;
+            for (i++; sql[i] != '\0' && sql[i] != close; i++) {
+            }
+            if (sql[i] == '\0') {
+                break;
+            }
+        } else if (c == '-' && sql[i + 1] == '-') {
+            for (; sql[i + 1] != '\0' && sql[i + 1] != '\n'; i++) {
+            }
+        } else if (c == '/' && sql[i + 1] == '*') {
+            for (i += 2; sql[i] != '\0' && !(sql[i] == '*' && sql[i + 1] == '/'); i++) {
+            }
+            if (sql[i] == '\0') {
+                break;
+            }
+            i++;
+        } else if (c == '?') {
+            int number = 0;
+            bool numbered = false;
+            for (; sql[i + 1] >= '0' && sql[i + 1] <= '9'; i++) {
+                number = number * 10 + (sql[i + 1] - '0');
+                numbered = true;
+            }
+            count = !numbered ? count + 1 : number > count ? number : count;
+        } else if ((c == ':' || c == '@' || c == '$') &&
+                   ((sql[i + 1] >= 'a' && sql[i + 1] <= 'z') || (sql[i + 1] >= 'A' && sql[i + 1] <= 'Z'))) {
+            return -1;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Привязка параметра (перегрузка выбирается на этапе компиляции)
+ *
+ * Строки привязываются без копирования: значения живут до конца выполнения запроса.
+ */
+inline int bindParameter(sqlite3_stmt *stmt, int index, int value) {
+    return sqlite3_bind_int(stmt, index, value);
+}
+
+inline int bindParameter(sqlite3_stmt *stmt, int index, long long value) {
+    return sqlite3_bind_int64(stmt, index, value);
+}
+
+inline int bindParameter(sqlite3_stmt *stmt, int index, double value) {
+    return sqlite3_bind_double(stmt, index, value);
+}
+
+inline int bindParameter(sqlite3_stmt *stmt, int index, std::string_view value) {
+    return sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+}
+
+inline int bindParameter(sqlite3_stmt *stmt, int index, std::nullptr_t) {
+    return sqlite3_bind_null(stmt, index);
+}
+
+template <typename T>
+int bindParameter(sqlite3_stmt *stmt, int index, const std::optional<T> &value) {
+    return value ? bindParameter(stmt, index, *value) : sqlite3_bind_null(stmt, index);
+}
+
+/**
+ * @brief Чтение столбца результата в значение типа T
+ */
+template <typename T>
+struct ColumnReader;
+
+template <>
+struct ColumnReader<int> {
+    static int read(sqlite3_stmt *stmt, int column) { return sqlite3_column_int(stmt, column); }
+};
+
+template <>
+struct ColumnReader<long long> {
+    static long long read(sqlite3_stmt *stmt, int column) { return sqlite3_column_int64(stmt, column); }
+};
+
+template <>
+struct ColumnReader<double> {
+    static double read(sqlite3_stmt *stmt, int column) { return sqlite3_column_double(stmt, column); }
+};
+
+template <>
+struct ColumnReader<bool> {
+    static bool read(sqlite3_stmt *stmt, int column) { return sqlite3_column_int(stmt, column) != 0; }
+};
+
+template <>
+struct ColumnReader<std::string> {
+    static std::string read(sqlite3_stmt *stmt, int column) {
+        const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, column));
+        return text ? std::string(text, static_cast<std::size_t>(sqlite3_column_bytes(stmt, column))) : std::string();
+    }
+};
+
+/**
+ * @brief Строка без копирования: значение действительно до следующего шага запроса
+ */
+template <>
+struct ColumnReader<std::string_view> {
+    static std::string_view read(sqlite3_stmt *stmt, int column) {
+        const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, column));
+        return text ? std::string_view(text, static_cast<std::size_t>(sqlite3_column_bytes(stmt, column)))
+                    : std::string_view();
+    }
+};
+
+template <typename T>
+struct ColumnReader<std::optional<T>> {
+    static std::optional<T> read(sqlite3_stmt *stmt, int column) {
+        if (sqlite3_column_type(stmt, column) == SQLITE_NULL) {
+            return std::nullopt;
+        }
+        return ColumnReader<T>::read(stmt, column);
+    }
+};
+
+/**
+ * @brief Чтение строки результата в кортеж
+ */
+template <typename Row>
+struct RowReader;
+
+template <typename... Columns>
+struct RowReader<std::tuple<Columns...>> {
+    static constexpr int columnCount = sizeof...(Columns);
+
+    static std::tuple<Columns...> read(sqlite3_stmt *stmt) {
+        return read(stmt, std::index_sequence_for<Columns...>{});
+    }
+
+private:
+    template <std::size_t... I>
+    static std::tuple<Columns...> read(sqlite3_stmt *stmt, std::index_sequence<I...>) {
+        return std::tuple<Columns...>{ColumnReader<Columns>::read(stmt, static_cast<int>(I))...};
+    }
+};
+
+/**
+ * @brief Кеш подготовленных запросов одного соединения
+ *
+ * Запрос берется из кеша на время выполнения и возвращается сброшенным,
+ * поэтому вложенное выполнение того же запроса подготавливает вторую копию.
+ * Кеш нужно очистить до закрытия соединения.
+ */
+class StatementCache {
+private:
+    sqlite3 *db;                                              // Соединение
+    std::unordered_map<const char *, sqlite3_stmt *> statements; // Запросы по адресу текста SQL
+
+public:
+    explicit StatementCache(sqlite3 *db = nullptr) : db(db) {}
+
+    ~StatementCache() { clear(); }
+
+    StatementCache(const StatementCache &) = delete;
+    StatementCache &operator=(const StatementCache &) = delete;
+
+    /**
+     * @brief Смена соединения (кеш очищается)
+     */
+    void reset(sqlite3 *connection) {
+        clear();
+        db = connection;
+    }
+
+    sqlite3 *connection() const { return db; }
+
+    /**
+     * @brief Получение подготовленного запроса
+     *
+     * @return Запрос или nullptr при ошибке подготовки
+     */
+    sqlite3_stmt *acquire(const char *sql) {
+        auto it = statements.find(sql);
+        if (it != statements.end()) {
+            sqlite3_stmt *stmt = it->second;
+            statements.erase(it);
+            return stmt;
+        }
+
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+            return nullptr;
+        }
+        return stmt;
+    }
+
+    /**
+     * @brief Возврат запроса в кеш
+     */
+    void release(const char *sql, sqlite3_stmt *stmt) {
+        sqlite3_reset(stmt);
+        if (!statements.emplace(sql, stmt).second) {
+            sqlite3_finalize(stmt);
+        }
+    }
+
+    /**
+     * @brief Финализация всех запросов
+     */
+    void clear() {
+        for (const auto &entry : statements) {
+            sqlite3_finalize(entry.second);
+        }
+        statements.clear();
+    }
+};
+
+/**
+ * @brief Типизированный SQL-запрос
+ *
+ * Количество параметров проверяется при компиляции, привязка и чтение
+ * столбцов разворачиваются в прямые вызовы sqlite3_bind_* и sqlite3_column_*.
+ *
+ * @tparam Sql Текст запроса (массив со статическим временем жизни)
+ * @tparam Row Кортеж типов столбцов результата (std::tuple<> - без результата)
+ * @tparam Params Типы параметров по порядку номеров
+ */
+template <const char *Sql, typename Row, typename... Params>
+class Query {
+    static_assert(sqlParameterCount(Sql) >= 0, "Используйте параметры ? и ?NNN вместо именованных");
+    static_assert(sqlParameterCount(Sql) == static_cast<int>(sizeof...(Params)),
+                  "Количество параметров не совпадает с SQL-запросом");
+
+private:
+    sqlite3 *db;           // Соединение
+    sqlite3_stmt *stmt;    // Подготовленный запрос
+    StatementCache *cache; // Кеш, из которого взят запрос (nullptr - свой запрос)
+    int lastResult;        // Результат последнего шага
+
+    bool checkColumns() {
+        if (stmt && sqlite3_column_count(stmt) != RowReader<Row>::columnCount) {
+            std::cerr << "SQL error: количество столбцов не совпадает с типом строки: " << Sql << std::endl;
+            sqlite3_finalize(stmt);
+            stmt = nullptr;
+        }
+        return stmt != nullptr;
+    }
+
+public:
+    /**
+     * @brief Подготовка запроса на соединении
+     */
+    explicit Query(sqlite3 *db) : db(db), stmt(nullptr), cache(nullptr), lastResult(SQLITE_OK) {
+        if (sqlite3_prepare_v2(db, Sql, -1, &stmt, nullptr) != SQLITE_OK) {
+            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+            stmt = nullptr;
+        }
+        checkColumns();
+    }
+
+    /**
+     * @brief Запрос из кеша подготовленных запросов
+     */
+    explicit Query(StatementCache &statements)
+        : db(statements.connection()), stmt(statements.acquire(Sql)), cache(&statements), lastResult(SQLITE_OK) {
+        if (!checkColumns()) {
+            cache = nullptr;
+        }
+    }
+
+    ~Query() {
+        if (stmt && cache) {
+            cache->release(Sql, stmt);
+        } else if (stmt) {
+            sqlite3_finalize(stmt);
+        }
+    }
+
+    Query(const Query &) = delete;
+    Query &operator=(const Query &) = delete;
+
+    /**
+     * @brief Запрос подготовлен
+     */
+    bool ok() const { return stmt != nullptr; }
+
+    /**
+     * @brief Сброс и привязка параметров
+     */
+    Query &bind(const Params &...params) {
+        if (stmt) {
+            sqlite3_reset(stmt);
+            int index = 0;
+            (bindParameter(stmt, ++index, params), ...);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Переход к следующей строке
+     *
+     * @return true, если строка получена
+     */
+    bool next() {
+        if (!stmt) {
+            lastResult = SQLITE_MISUSE;
+            return false;
+        }
+        lastResult = sqlite3_step(stmt);
+        if (lastResult != SQLITE_ROW && lastResult != SQLITE_DONE) {
+            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        }
+        return lastResult == SQLITE_ROW;
+    }
+
+    /**
+     * @brief Текущая строка
+     */
+    Row row() const { return RowReader<Row>::read(stmt); }
+
+    /**
+     * @brief Запрос выполнен до конца без ошибок
+     */
+    bool done() const { return lastResult == SQLITE_DONE; }
+
+    /**
+     * @brief Выполнение запроса без результата
+     */
+    bool execute() {
+        while (next()) {
+        }
+        return done();
+    }
+
+    /**
+     * @brief Выполнение изменяющего запроса с повтором, если база занята
+     *
+     * Запрос, получивший SQLITE_BUSY, ничего не изменил, поэтому его можно
+     * выполнить повторно с теми же параметрами.
+     *
+     * @param retries Количество повторов
+     * @param onRetry Вызывается перед каждым повтором
+     */
+    template <typename OnRetry>
+    bool execute(int retries, OnRetry &&onRetry) {
+        if (!stmt) {
+            lastResult = SQLITE_MISUSE;
+            return false;
+        }
+        lastResult = sqlite3_step(stmt);
+        for (int attempt = 0; (lastResult & 0xFF) == SQLITE_BUSY && attempt < retries; attempt++) {
+            sqlite3_reset(stmt);
+            onRetry();
+            lastResult = sqlite3_step(stmt);
+        }
+        if (lastResult == SQLITE_ROW) {
+            return execute();
+        }
+        if (lastResult != SQLITE_DONE) {
+            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        }
+        return done();
+    }
+
+    /**
+     * @brief Вызов onRow(столбцы...) для каждой строки
+     *
+     * @return true, если все строки прочитаны без ошибок
+     */
+    template <typename Func>
+    bool forEach(Func &&onRow) {
+        while (next()) {
+            std::apply(onRow, row());
+        }
+        return done();
+    }
+
+    /**
+     * @brief Первая строка результата; T создается из столбцов списком инициализации
+     */
+    template <typename T = Row>
+    std::optional<T> fetchOne() {
+        if (!next()) {
+            return std::nullopt;
+        }
+        T result = std::apply([](auto &&...columns) { return T{std::move(columns)...}; }, row());
+        sqlite3_reset(stmt);
+        return result;
+    }
+
+    /**
+     * @brief Все строки результата; T создается из столбцов списком инициализации
+     */
+    template <typename T = Row>
+    std::vector<T> fetchAll() {
+        std::vector<T> result;
+        forEach([&result](auto &&...columns) { result.push_back(T{std::move(columns)...}); });
+        return result;
+    }
+};
+
+/**
+ * @brief Запрос без результата (INSERT, UPDATE, DELETE)
+ */
+template <const char *Sql, typename... Params>
+using Command = Query<Sql, std::tuple<>, Params...>;
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "AsyncTask.h"
+#include "MusicStoreDB.h"
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Исполнитель асинхронных запросов на корутинах
+ *
+ * Небольшой пул потоков, каждый из которых владеет своим соединением
+ * MusicStoreDB. Корутина, ожидающая запрос, не занимает поток: она
+ * приостанавливается, запрос выполняется свободным рабочим потоком, после
+ * чего корутина продолжается в этом же потоке. Так сотня терминалов
+ * обслуживается несколькими потоками.
+ *
+ * @code
+ * QueryExecutor executor("music_store.db", 4);
+ * Task<std::vector<AuthorSales>> report = executor.authorSales();
+ * auto rows = syncWait(std::move(report));
+ * @endcode
+ */
+class QueryExecutor {
+private:
+    std::vector<std::unique_ptr<MusicStoreDB>> connections; // Соединения рабочих потоков
+    std::vector<std::thread> workers;                       // Рабочие потоки
+    std::mutex mutex;                                       // Защита очереди
+    std::condition_variable ready;                          // Сигнал о новой корутине в очереди
+    std::deque<std::coroutine_handle<>> queue;              // Корутины, ожидающие соединения
+    bool stopping;                                          // Исполнитель останавливается
+
+    /**
+     * @brief Цикл рабочего потока
+     *
+     * @param index Номер потока и его соединения
+     */
+    void workerLoop(size_t index);
+
+    /**
+     * @brief Постановка корутины в очередь
+     */
+    void enqueue(std::coroutine_handle<> handle);
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * Соединения открываются последовательно в вызывающем потоке, поэтому
+     * создание схемы в новой базе выполняется один раз.
+     *
+     * @param dbPath Путь к файлу базы данных
+     * @param threads Количество рабочих потоков (и соединений)
+     * @param mode Режим открытия соединений
+     */
+    explicit QueryExecutor(const std::string &dbPath, size_t threads = 4, OpenMode mode = OpenMode::ReadWrite);
+
+    /**
+     * @brief Деструктор: корутины, уже стоящие в очереди, выполняются до конца
+     */
+    ~QueryExecutor();
+
+    QueryExecutor(const QueryExecutor &) = delete;
+    QueryExecutor &operator=(const QueryExecutor &) = delete;
+
+    /**
+     * @brief Количество рабочих потоков
+     */
+    size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Переход корутины в рабочий поток: co_await executor.schedule()
+     */
+    auto schedule() noexcept {
+        struct Awaiter {
+            QueryExecutor &executor;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor.enqueue(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    /**
+     * @brief Соединение текущего рабочего потока
+     *
+     * Доступно только внутри корутины после co_await schedule().
+     */
+    static MusicStoreDB &connection();
+
+    /**
+     * @brief Выполнение функции над соединением рабочего потока
+     *
+     * @param func Функция вида R(MusicStoreDB&)
+     * @return Задача с результатом функции
+     */
+    template <typename Func>
+    Task<std::invoke_result_t<Func &, MusicStoreDB &>> query(Func func) {
+        co_await schedule();
+        co_return func(connection());
+    }
+
+    /**
+     * @brief Продажи по авторам
+     */
+    Task<std::vector<AuthorSales>> authorSales();
+
+    /**
+     * @brief Продажи по исполнителям
+     */
+    Task<std::vector<PerformerSales>> performerSales();
+
+    /**
+     * @brief Текущий остаток компакт-диска
+     */
+    Task<long long> stockLevel(int compactId);
+
+    /**
+     * @brief Поступления и продажи компакт-диска за период
+     */
+    Task<PeriodTotals> periodTotals(int compactId, std::string startDate, std::string endDate);
+
+    /**
+     * @brief Регистрация продажи
+     *
+     * @return Идентификатор операции или -1 при ошибке
+     */
+    Task<int> registerSale(int compactId, int quantity, std::string operationDate = "");
+
+    /**
+     * @brief Регистрация поступления
+     *
+     * @return Идентификатор операции или -1 при ошибке
+     */
+    Task<int> registerReceipt(int compactId, int quantity, std::string operationDate = "");
+
+    /**
+     * @brief Потоковое чтение складского отчета
+     *
+     * Строки читаются страницами по ключу; между страницами соединение
+     * освобождается, поэтому долгий обход не занимает рабочий поток.
+     *
+     * @param pageSize Количество строк в одном запросе
+     */
+    AsyncGenerator<InventoryRow> inventory(int pageSize = 100);
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * @brief Счетчики выделений памяти отчета
+ */
+struct ReportArenaStats {
+    size_t reports;         // Количество отчетов (только в общих итогах)
+    size_t allocations;     // Выделений из арены
+    size_t bytes;           // Байт выделено из арены
+    size_t heapAllocations; // Блоков, запрошенных у кучи
+    size_t heapBytes;       // Байт, запрошенных у кучи
+};
+
+/**
+ * @brief Ресурс памяти, считающий выделения вышестоящего ресурса
+ */
+class CountingResource : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource *upstream; // Вышестоящий ресурс
+    size_t allocations;                  // Количество выделений
+    size_t bytes;                        // Выделено байт
+
+protected:
+    void *do_allocate(size_t size, size_t alignment) override;
+    void do_deallocate(void *pointer, size_t size, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+public:
+    explicit CountingResource(std::pmr::memory_resource *upstream);
+
+    size_t allocationCount() const { return allocations; }
+    size_t allocatedBytes() const { return bytes; }
+};
+
+/**
+ * @brief Арена памяти одного отчета
+ *
+ * Строки результата, ячейки таблицы и буфер вывода отчета выделяются
+ * последовательно из буфера внутри объекта, а при его заполнении - блоками
+ * растущего размера из кучи. Отдельные освобождения ничего не делают, вся
+ * память возвращается разом при уничтожении арены, поэтому параллельные
+ * отчеты почти не обращаются к общему распределителю.
+ *
+ * Объект не потокобезопасен: одна арена - один отчет в одном потоке.
+ */
+class ReportArena {
+public:
+    static constexpr size_t INITIAL_BUFFER_SIZE = 16 * 1024; // Буфер внутри объекта
+
+private:
+    alignas(std::max_align_t) std::byte buffer[INITIAL_BUFFER_SIZE];
+    CountingResource heap;                       // Обращения к куче
+    std::pmr::monotonic_buffer_resource arena;   // Последовательное выделение
+    CountingResource counted;                    // Обращения к арене
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * @param upstream Источник блоков при заполнении буфера
+     */
+    explicit ReportArena(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+
+    /**
+     * @brief Деструктор (счетчики добавляются в общие итоги)
+     */
+    ~ReportArena();
+
+    ReportArena(const ReportArena &) = delete;
+    ReportArena &operator=(const ReportArena &) = delete;
+
+    /**
+     * @brief Ресурс памяти для контейнеров std::pmr
+     */
+    std::pmr::memory_resource *resource() { return &counted; }
+
+    /**
+     * @brief Счетчики этой арены
+     */
+    ReportArenaStats stats() const;
+
+    /**
+     * @brief Общие итоги по всем завершенным отчетам процесса
+     */
+    static ReportArenaStats totals();
+};
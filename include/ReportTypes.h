@@ -0,0 +1,230 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Продажи одного исполнителя
+ */
+struct PerformerSales {
+    std::string performer; // Исполнитель
+    long long totalSold;   // Количество проданных экземпляров
+};
+
+/**
+ * @brief Продажи одного автора
+ */
+struct AuthorSales {
+    std::string author;   // Автор
+    long long totalSold;  // Количество проданных экземпляров
+    long long worksCount; // Количество произведений автора
+    double totalRevenue;  // Выручка
+};
+
+/**
+ * @brief Сводная стоимость запасов
+ */
+struct InventoryValue {
+    long long discCount;     // Количество компакт-дисков в каталоге
+    long long totalReceived; // Всего поступило
+    long long totalSold;     // Всего продано
+    long long remaining;     // Остаток
+    double stockValue;       // Стоимость остатка
+};
+
+/**
+ * @brief Поступления и продажи компакт-диска за период
+ */
+struct PeriodTotals {
+    long long received; // Поступило
+    long long sold;     // Продано
+};
+
+/**
+ * @brief Остаток компакт-диска
+ */
+struct StockLevel {
+    int compactId;       // Идентификатор компакт-диска
+    long long remaining; // Остаток
+};
+
+/**
+ * @brief Продажи компакт-диска за период в отчете по нескольким дискам
+ */
+struct DiscSales {
+    int compactId;              // Идентификатор компакт-диска
+    std::string company;        // Компания-производитель
+    std::string productionDate; // Дата выпуска
+    double price;               // Цена
+    long long sold;             // Продано за период
+    double revenue;             // Выручка за период
+};
+
+/**
+ * @brief Продажи нескольких компакт-дисков за период с итогами
+ */
+struct DiscSalesReport {
+    std::vector<DiscSales> discs; // Диски по возрастанию идентификатора
+    long long totalSold;          // Всего продано
+    double totalRevenue;          // Общая выручка
+};
+
+/**
+ * @brief Период отчета (границы включаются)
+ */
+struct ReportPeriod {
+    std::string startDate; // Начальная дата
+    std::string endDate;   // Конечная дата
+};
+
+/**
+ * @brief Показатели компакт-диска за один период сравнения
+ */
+struct PeriodMetrics {
+    long long received; // Поступило
+    long long sold;     // Продано
+    double revenue;     // Выручка
+};
+
+/**
+ * @brief Изменение показателей относительно предыдущего периода
+ */
+struct PeriodChange {
+    long long soldDelta;                 // Разница продаж
+    double revenueDelta;                 // Разница выручки
+    std::optional<double> soldGrowth;    // Рост продаж (доля; нет, если в предыдущем периоде продаж не было)
+    std::optional<double> revenueGrowth; // Рост выручки (доля; нет, если предыдущая выручка нулевая)
+};
+
+/**
+ * @brief Строка сравнительного отчета по компакт-диску
+ */
+struct PeriodComparisonRow {
+    int compactId;                      // Идентификатор компакт-диска
+    std::string company;                // Компания-производитель
+    std::vector<PeriodMetrics> periods; // Показатели в порядке периодов
+    std::vector<PeriodChange> changes;  // Изменения: changes[i] - период i + 1 относительно периода i
+};
+
+/**
+ * @brief Сравнение нескольких периодов по всем компакт-дискам
+ */
+struct PeriodComparison {
+    std::vector<ReportPeriod> periods;      // Сравниваемые периоды
+    std::vector<PeriodComparisonRow> rows;  // Диски по возрастанию идентификатора
+    std::vector<PeriodMetrics> totals;      // Итоги по периодам
+    std::vector<PeriodChange> totalChanges; // Изменения итогов
+};
+
+/**
+ * @brief Операции по компакт-диску за период из аналитического снимка
+ */
+struct DiscPeriodTotals {
+    int compactId;      // Идентификатор компакт-диска
+    long long received; // Поступило
+    long long sold;     // Продано
+    double revenue;     // Выручка от продаж
+};
+
+/**
+ * @brief Интервал временного ряда продаж
+ */
+enum class SeriesBucket {
+    Day,  // День
+    Week, // Неделя с понедельника
+    Month // Календарный месяц
+};
+
+/**
+ * @brief Группировка временного ряда продаж
+ */
+enum class SeriesGrouping {
+    Disc,      // По компакт-дискам
+    Performer, // По исполнителям (продажа диска учитывается у каждого его исполнителя)
+    Author     // По авторам (продажа диска учитывается у каждого его автора)
+};
+
+/**
+ * @brief Точка временного ряда продаж
+ */
+struct SalesSeriesPoint {
+    std::string key;       // Идентификатор компакт-диска, исполнитель или автор
+    std::string bucket;    // Начало интервала (ГГГГ-ММ-ДД)
+    long long sold;        // Продано за интервал
+    double revenue;        // Выручка за интервал
+    double averageSold;    // Скользящее среднее продаж
+    double averageRevenue; // Скользящее среднее выручки
+    long long runningSold; // Продано с начала ряда
+    double runningRevenue; // Выручка с начала ряда
+};
+
+/**
+ * @brief Результат поиска по каталогу
+ */
+struct CatalogSearchResult {
+    int workId;                 // Идентификатор произведения
+    std::string title;          // Название произведения
+    std::string author;         // Автор
+    std::string performer;      // Исполнитель
+    int compactId;              // Идентификатор компакт-диска
+    std::string company;        // Компания-производитель
+    std::string productionDate; // Дата изготовления
+    double price;               // Цена
+    double score;               // Релевантность bm25 (меньше - выше)
+};
+
+/**
+ * @brief Строка складского отчета по компакт-диску
+ */
+struct InventoryRow {
+    int compactId;              // Идентификатор компакт-диска
+    std::string company;        // Компания-производитель
+    std::string productionDate; // Дата изготовления
+    double price;               // Цена
+    long long totalReceived;    // Всего поступило
+    long long totalSold;        // Всего продано
+    long long remaining;        // Остаток
+    double stockValue;          // Стоимость остатка
+};
+
+/**
+ * @brief Строка каталога произведений
+ */
+struct CatalogRow {
+    int workId;            // Идентификатор произведения
+    std::string title;     // Название произведения
+    std::string author;    // Автор
+    std::string performer; // Исполнитель
+    int compactId;         // Идентификатор компакт-диска
+    std::string company;   // Компания-производитель
+    double price;          // Цена
+};
+
+/**
+ * @brief Страница результатов с токеном продолжения
+ */
+template <typename Row>
+struct Page {
+    std::vector<Row> rows; // Строки страницы
+    std::string nextToken; // Токен следующей страницы (пустой - страница последняя)
+};
+
+/**
+ * @brief Вид импортируемых данных
+ */
+enum class ImportKind {
+    Discs,     // Компакт-диски: disc_key, production_date, company, price
+    Works,     // Произведения: disc_key, title, author, performer
+    Operations // Операции: disc_key, operation_date, operation_type, quantity
+};
+
+/**
+ * @brief Итог импорта CSV
+ */
+struct ImportResult {
+    bool completed;     // Файл прочитан и все пакеты зафиксированы
+    long long imported; // Добавлено записей
+    long long skipped;  // Пропущено (компакт-диск с таким ключом уже импортирован)
+    long long rejected; // Отклонено из-за ошибок в данных
+};
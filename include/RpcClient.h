@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ReportTypes.h"
+#include "RpcProtocol.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Клиент сервера RPC (music_store_app --server)
+ *
+ * Запросы выполняются синхронно по одному соединению; после входа токен
+ * сессии добавляется к каждому запросу. Ошибка соединения
+ * приводит к исключению std::runtime_error; ошибки методов возвращаются
+ * в ответе (ok = false), а вспомогательные методы сообщают о них
+ * значением -1 или false.
+ */
+class RpcClient {
+private:
+    int fd;            // Сокет
+    long long next;    // Номер следующего запроса
+    std::string token; // Токен сессии после входа
+
+public:
+    /**
+     * @brief Подключение к серверу
+     *
+     * @param socketPath Путь к Unix-сокету сервера
+     */
+    explicit RpcClient(const std::string &socketPath);
+
+    ~RpcClient();
+
+    RpcClient(const RpcClient &) = delete;
+    RpcClient &operator=(const RpcClient &) = delete;
+
+    /**
+     * @brief Вызов метода
+     *
+     * @param method Название метода
+     * @param params Параметры (объект JSON)
+     * @return Ответ сервера: поля ok, result или error
+     */
+    JsonValue call(const std::string &method, JsonValue params = JsonValue::object());
+
+    /**
+     * @brief Вход пользователя (получение токена сессии)
+     */
+    bool login(const std::string &username, const std::string &password);
+
+    /**
+     * @brief Завершение сессии на сервере
+     */
+    bool logout();
+
+    /**
+     * @brief Токен текущей сессии (пусто до входа)
+     */
+    const std::string &getToken() const { return token; }
+
+    /**
+     * @brief Продолжение сессии, полученной другим соединением
+     */
+    void setToken(const std::string &sessionToken) { token = sessionToken; }
+
+    /**
+     * @brief Регистрация продажи
+     *
+     * @return Идентификатор операции или -1 при ошибке
+     */
+    int registerSale(int compactId, int quantity, const std::string &operationDate = "");
+
+    /**
+     * @brief Регистрация поступления
+     *
+     * @return Идентификатор операции или -1 при ошибке
+     */
+    int registerReceipt(int compactId, int quantity, const std::string &operationDate = "");
+
+    /**
+     * @brief Текущий остаток компакт-диска
+     *
+     * @return Остаток или -1 при ошибке
+     */
+    long long stockLevel(int compactId);
+
+    /**
+     * @brief Продажи по авторам
+     */
+    std::vector<AuthorSales> authorSales();
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Значение JSON для сообщений RPC
+ *
+ * Объект хранит поля в порядке добавления; при разборе повторяющиеся
+ * ключи сохраняются, поиск возвращает первое совпадение.
+ */
+class JsonValue {
+public:
+    /**
+     * @brief Тип значения
+     */
+    enum class Type {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+private:
+    Type type;                                              // Тип значения
+    bool boolean;                                           // Значение Bool
+    double number;                                          // Значение Number
+    std::string text;                                       // Значение String
+    std::vector<JsonValue> items;                           // Элементы Array
+    std::vector<std::pair<std::string, JsonValue>> members; // Поля Object
+
+    void dumpTo(std::string &out) const;
+
+public:
+    JsonValue() : type(Type::Null), boolean(false), number(0) {}
+    JsonValue(std::nullptr_t) : JsonValue() {}
+    JsonValue(bool value) : type(Type::Bool), boolean(value), number(0) {}
+    JsonValue(int value) : type(Type::Number), boolean(false), number(value) {}
+    JsonValue(long long value) : type(Type::Number), boolean(false), number(static_cast<double>(value)) {}
+    JsonValue(double value) : type(Type::Number), boolean(false), number(value) {}
+    JsonValue(const char *value) : type(Type::String), boolean(false), number(0), text(value) {}
+    JsonValue(std::string value) : type(Type::String), boolean(false), number(0), text(std::move(value)) {}
+
+    /**
+     * @brief Пустой массив
+     */
+    static JsonValue array();
+
+    /**
+     * @brief Пустой объект
+     */
+    static JsonValue object();
+
+    Type getType() const { return type; }
+    bool isNull() const { return type == Type::Null; }
+    bool isNumber() const { return type == Type::Number; }
+    bool isString() const { return type == Type::String; }
+    bool isObject() const { return type == Type::Object; }
+    bool isArray() const { return type == Type::Array; }
+
+    /**
+     * @brief Чтение значения с заменой при несовпадении типа
+     */
+    bool asBool(bool fallback = false) const { return type == Type::Bool ? boolean : fallback; }
+    long long asInt(long long fallback = 0) const;
+    double asDouble(double fallback = 0) const { return type == Type::Number ? number : fallback; }
+    std::string asString(const std::string &fallback = "") const { return type == Type::String ? text : fallback; }
+
+    /**
+     * @brief Элементы массива (пусто для других типов)
+     */
+    const std::vector<JsonValue> &asArray() const { return items; }
+
+    /**
+     * @brief Поле объекта или null, если поля нет
+     */
+    const JsonValue &operator[](std::string_view key) const;
+
+    /**
+     * @brief Проверка наличия поля
+     */
+    bool has(std::string_view key) const;
+
+    /**
+     * @brief Добавление поля в объект
+     *
+     * @return Ссылка на этот объект для цепочки вызовов
+     */
+    JsonValue &set(std::string key, JsonValue value);
+
+    /**
+     * @brief Добавление элемента в массив
+     *
+     * @return Ссылка на этот массив для цепочки вызовов
+     */
+    JsonValue &push(JsonValue value);
+
+    /**
+     * @brief Сериализация в компактную строку JSON
+     */
+    std::string dump() const;
+
+    /**
+     * @brief Разбор текста JSON
+     *
+     * @param text Текст (весь текст должен быть одним значением)
+     * @return Значение или std::nullopt при синтаксической ошибке
+     */
+    static std::optional<JsonValue> parse(std::string_view text);
+};
+
+/**
+ * @brief Кадры протокола RPC: 4 байта длины (big-endian) и тело JSON
+ */
+class RpcFrame {
+public:
+    static constexpr uint32_t MAX_SIZE = 16 * 1024 * 1024; // Максимальный размер тела кадра
+
+    /**
+     * @brief Дописывание кадра (длина и тело) в буфер
+     *
+     * @return true если кадр сформирован; false если тело больше MAX_SIZE
+     */
+    static bool encode(std::string_view body, std::string &out);
+
+    /**
+     * @brief Запись кадра в сокет целиком
+     *
+     * @return true если кадр записан
+     */
+    static bool write(int fd, std::string_view body);
+
+    /**
+     * @brief Чтение одного кадра из сокета (блокирующее)
+     *
+     * @return true если кадр прочитан; false при закрытии соединения или ошибке
+     */
+    static bool read(int fd, std::string &body);
+
+    /**
+     * @brief Извлечение готового кадра из накопленных байтов
+     *
+     * @param buffer Принятые байты; извлеченный кадр удаляется из начала
+     * @param body Тело кадра
+     * @return 1 - кадр извлечен, 0 - данных недостаточно, -1 - превышен размер кадра
+     */
+    static int extract(std::string &buffer, std::string &body);
+};
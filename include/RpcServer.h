@@ -0,0 +1,136 @@
+#pragma once
+
+#include "QueryExecutor.h"
+#include "RpcProtocol.h"
+#include "SessionManager.h"
+#include "StockLedger.h"
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+
+/**
+ * @brief Сервер RPC на Unix-сокете
+ *
+ * Терминалы подключаются к одному процессу вместо того, чтобы каждый
+ * открывал файл базы сам. Запросы - кадры с JSON-объектом
+ * {"id": N, "method": "...", "params": {...}}, ответы - {"id": N, "ok": true,
+ * "result": ...} или {"id": N, "ok": false, "error": "..."}.
+ *
+ * Один поток принимает соединения и читает кадры (poll), запросы
+ * выполняются пулом QueryExecutor на его соединениях. Сокеты клиентов
+ * неблокирующие: ответ, который сокет не принял сразу, остается в очереди
+ * клиента и досылается по POLLOUT, а клиент, не принимающий ответы дольше
+ * setSendTimeout(), отключается. Поэтому терминал, переставший читать, не
+ * занимает рабочий поток и не останавливает цикл. Запись в базу
+ * выполняется монопольно, чтение - параллельно, поэтому соединения пула
+ * не конкурируют за блокировку файла.
+ *
+ * Метод login возвращает токен сессии; остальные запросы передают его в
+ * поле "token" и проверяются по SessionManager без обращения к базе,
+ * поэтому токен действует и после переподключения.
+ *
+ * Продажа резервируется в StockLedger до записи в базу: распроданный диск
+ * отклоняется без блокировки записи, а после записи или ошибки остаток
+ * сверяется с базой.
+ *
+ * Методы: ping, login, logout, inventory, stock, periodTotals, authorSales,
+ * performerSales, inventoryValue; sale и receipt - только администратору.
+ */
+class RpcServer {
+private:
+    struct Client;
+
+    std::string socketPath;          // Путь к сокету
+    int listenFd;                    // Слушающий сокет
+    int wakeFds[2];                  // Канал для пробуждения цикла из stop()
+    std::atomic<bool> running;       // Цикл обработки запущен
+    std::atomic<long long> requests; // Обработано запросов
+    std::chrono::milliseconds sendTimeout; // Наибольшее время без приема ответов клиентом
+    std::shared_mutex databaseLock;  // Запись - монопольно, чтение - совместно
+    SessionManager sessions;         // Сессии по токенам
+    StockLedger stock;               // Остатки для резервирования продаж
+    QueryExecutor executor;          // Пул соединений (уничтожается первым)
+
+    /**
+     * @brief Выполнение запроса в рабочем потоке и отправка ответа
+     */
+    Task<void> handle(std::shared_ptr<Client> client, JsonValue request);
+
+    /**
+     * @brief Выполнение метода
+     *
+     * @return Ответ без поля id
+     */
+    JsonValue dispatch(const JsonValue &request, MusicStoreDB &db);
+
+    /**
+     * @brief Постановка ответа в очередь клиента и попытка отправить его сразу
+     */
+    void reply(Client &client, const JsonValue &id, JsonValue response);
+
+    /**
+     * @brief Пробуждение цикла обработки (новая очередь на отправку или остановка)
+     */
+    void wake();
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * @param dbPath Путь к файлу базы данных
+     * @param socketPath Путь к Unix-сокету
+     * @param workers Количество рабочих потоков и соединений
+     * @param mode Режим открытия базы
+     * @param sessionTtl Время жизни сессии без обращений
+     */
+    RpcServer(const std::string &dbPath, const std::string &socketPath, size_t workers = 4,
+              OpenMode mode = OpenMode::ReadWrite, std::chrono::seconds sessionTtl = std::chrono::minutes(30));
+
+    /**
+     * @brief Деструктор (сокет удаляется)
+     */
+    ~RpcServer();
+
+    RpcServer(const RpcServer &) = delete;
+    RpcServer &operator=(const RpcServer &) = delete;
+
+    /**
+     * @brief Создание слушающего сокета
+     *
+     * @return true если сокет создан
+     */
+    bool listen();
+
+    /**
+     * @brief Цикл обработки соединений до вызова stop()
+     */
+    void run();
+
+    /**
+     * @brief Остановка цикла (можно вызывать из другого потока и обработчика сигнала)
+     */
+    void stop();
+
+    /**
+     * @brief Время, после которого клиент, не принимающий ответы, отключается
+     *
+     * Задается до вызова run(); по умолчанию 30 секунд.
+     */
+    void setSendTimeout(std::chrono::milliseconds timeout) { sendTimeout = timeout; }
+
+    /**
+     * @brief Количество обработанных запросов
+     */
+    long long requestCount() const { return requests.load(); }
+
+    /**
+     * @brief Доступный остаток по данным StockLedger (-1 - диск не загружен)
+     */
+    long long ledgerStock(int compactId) const { return stock.available(compactId); }
+
+    /**
+     * @brief Количество сессий
+     */
+    size_t sessionCount() const { return sessions.size(); }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Сессия пользователя после входа
+ */
+struct Session {
+    int userId;                                    // Идентификатор пользователя
+    std::string username;                          // Имя пользователя
+    bool admin;                                    // Пользователь - администратор
+    std::chrono::steady_clock::time_point expires; // Время истечения
+};
+
+/**
+ * @brief Кеш сессий с непрозрачными токенами
+ *
+ * После проверки пароля (дорогой KDF) пользователь получает случайный
+ * токен; последующие запросы проверяются поиском токена в хеш-таблице за
+ * O(1) без обращения к SQLite. Таблица разделена на сегменты по хешу
+ * токена, каждый со своей блокировкой чтения-записи. Проверка берет
+ * блокировку чтения; монопольная нужна, только когда сессия продлевается
+ * (прошло больше половины срока) или удаляется.
+ */
+class SessionManager {
+public:
+    static constexpr size_t SHARD_COUNT = 16; // Количество сегментов таблицы
+    static constexpr size_t TOKEN_BYTES = 32; // Случайных байт в токене
+
+private:
+    struct Shard {
+        mutable std::shared_mutex mutex;                   // Блокировка сегмента
+        std::unordered_map<std::string, Session> sessions; // Сессии по токену
+    };
+
+    std::array<Shard, SHARD_COUNT> shards; // Сегменты таблицы
+    std::chrono::seconds ttl;              // Время жизни сессии без обращений
+
+    Shard &shardFor(const std::string &token);
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * @param ttl Время жизни сессии без обращений
+     */
+    explicit SessionManager(std::chrono::seconds ttl = std::chrono::minutes(30));
+
+    /**
+     * @brief Создание сессии
+     *
+     * @return Токен сессии (64 шестнадцатеричных символа)
+     */
+    std::string create(int userId, const std::string &username, bool admin);
+
+    /**
+     * @brief Проверка токена с продлением сессии
+     *
+     * @return Сессия или std::nullopt, если токен неизвестен или истек
+     */
+    std::optional<Session> validate(const std::string &token);
+
+    /**
+     * @brief Завершение сессии
+     *
+     * @return true если сессия существовала
+     */
+    bool revoke(const std::string &token);
+
+    /**
+     * @brief Завершение всех сессий пользователя (например, после смены пароля)
+     *
+     * @return Количество завершенных сессий
+     */
+    size_t revokeUser(int userId);
+
+    /**
+     * @brief Удаление истекших сессий
+     *
+     * @return Количество удаленных сессий
+     */
+    size_t purgeExpired();
+
+    /**
+     * @brief Количество активных (в том числе еще не удаленных истекших) сессий
+     */
+    size_t size() const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "MusicStoreDB.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Фасад над несколькими базами данных магазинов сети
+ *
+ * Каждая база (шард) обслуживается отдельным потоком; частичные
+ * агрегаты шардов объединяются в общий отчет по сети.
+ */
+class ShardSet {
+private:
+    std::vector<std::string> dbPaths;                  // Пути к файлам баз данных
+    std::vector<std::unique_ptr<MusicStoreDB>> shards; // Соединения с базами
+
+    /**
+     * @brief Параллельное выполнение функции на всех шардах
+     *
+     * @param task Функция, выполняемая для каждого шарда в отдельном потоке
+     * @return Результаты в порядке следования шардов
+     */
+    template <typename T>
+    std::vector<T> runOnShards(const std::function<T(MusicStoreDB&)>& task);
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * Базы магазинов открываются только для чтения (OpenMode::ReadOnly).
+     *
+     * @param dbPaths Пути к файлам баз данных магазинов
+     * @throws std::runtime_error если какой-либо из файлов не существует
+     */
+    explicit ShardSet(const std::vector<std::string>& dbPaths);
+
+    /**
+     * @brief Количество шардов
+     */
+    size_t size() const { return shards.size(); }
+
+    /**
+     * @brief Самые популярные исполнители по сети
+     *
+     * @param k Количество мест в рейтинге; исполнители с равными
+     *          продажами на последнем месте включаются все
+     * @return Исполнители, упорядоченные по убыванию продаж
+     */
+    std::vector<PerformerSales> topPerformers(size_t k);
+
+    /**
+     * @brief Продажи по авторам по всей сети
+     *
+     * @return Авторы, упорядоченные по убыванию продаж
+     */
+    std::vector<AuthorSales> authorSales();
+
+    /**
+     * @brief Суммарная стоимость запасов по всей сети
+     */
+    InventoryValue inventoryValue();
+
+    /**
+     * @brief Вывод сводного отчета по сети
+     *
+     * @param k Количество мест в рейтинге исполнителей
+     */
+    void showChainReport(size_t k = 3);
+};
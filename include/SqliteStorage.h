@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include "MusicStoreDB.h"
+#include "StorageBackend.h"
+
+/**
+ * @brief Хранилище на основе базы данных SQLite
+ *
+ * Делегирует вызовы MusicStoreDB, поэтому отчеты и меню приложения
+ * продолжают работать с той же базой.
+ */
+class SqliteStorage : public StorageBackend {
+private:
+    std::shared_ptr<MusicStoreDB> db; // База данных
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * @param db База данных
+     */
+    explicit SqliteStorage(std::shared_ptr<MusicStoreDB> db);
+
+    int addCompactDisc(const std::string &productionDate, const std::string &company, float price) override;
+    int addMusicalWork(const std::string &title, const std::string &author,
+                       const std::string &performer, int compactId) override;
+    bool updateCompactDisc(int compactId, const std::string &company, float price) override;
+    bool deleteCompactDisc(int compactId) override;
+    int registerOperation(const std::string &operationType, int compactId, int quantity,
+                          const std::string &operationDate) override;
+    long long getStockLevel(int compactId) override;
+    PeriodTotals getPeriodTotals(int compactId, const std::string &startDate,
+                                 const std::string &endDate) override;
+    std::vector<PerformerSales> getPerformerSales() override;
+    std::vector<AuthorSales> getAuthorSales() override;
+    InventoryValue getInventoryValue() override;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "ReportTypes.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Остатки компакт-дисков в памяти процесса
+ *
+ * Продажа сначала резервирует количество атомарным сравнением с обменом
+ * (CAS) счетчика диска и только затем записывается в базу. Поэтому
+ * распроданный диск отклоняется без блокировки записи, а продажи одного
+ * популярного диска с разных терминалов не ждут друг друга до записи.
+ *
+ * Счетчик диска - одно 64-битное слово: доступный остаток и количество,
+ * зарезервированное, но еще не записанное в базу. После записи или ошибки
+ * остаток сверяется с базой: доступно = остаток в базе - зарезервировано.
+ * Окончательную проверку остатка по-прежнему выполняет триггер
+ * check_sale_quantity. Счетчики не удаляются (у удаленного диска остаток
+ * 0), поэтому ссылки на них не нужно защищать блокировкой таблицы.
+ *
+ * Таблица счетчиков публикуется как неизменяемый снимок (как в CatalogCache):
+ * резервирование находит счетчик одной атомарной загрузкой указателя без
+ * блокировок, а новый диск копирует таблицу и подменяет ее. Загрузка
+ * остатков добавляет все диски одной копией.
+ */
+class StockLedger {
+public:
+    /**
+     * @brief Результат резервирования
+     */
+    enum class Reservation {
+        Reserved,     // Количество зарезервировано
+        Insufficient, // Остатка недостаточно
+        Unknown       // Диск не загружен (нужна сверка с базой)
+    };
+
+private:
+    // Отдельная линия кеша на счетчик: соседние диски не мешают друг другу
+    struct alignas(64) Counter {
+        std::atomic<uint64_t> state; // Доступно (младшие 32 бита) и зарезервировано (старшие)
+        
+        explicit Counter(uint64_t state) : state(state) {}
+    };
+
+    using Table = std::unordered_map<int, Counter *>;
+
+    std::atomic<std::shared_ptr<const Table>> table; // Счетчики по компакт-диску (снимок)
+    std::vector<std::unique_ptr<Counter>> storage;   // Владение счетчиками (под writeMutex)
+    std::mutex writeMutex;                           // Добавление дисков выполняется по одному
+
+    Counter *find(int compactId) const;
+    Counter &findOrCreate(int compactId);
+
+    /**
+     * @brief Добавление недостающих счетчиков одной подменой таблицы
+     */
+    void insert(const std::vector<int> &compactIds);
+
+    static uint64_t pack(int32_t available, uint32_t pending);
+    static int32_t availableOf(uint64_t state);
+    static uint32_t pendingOf(uint64_t state);
+
+public:
+    StockLedger();
+
+    StockLedger(const StockLedger &) = delete;
+    StockLedger &operator=(const StockLedger &) = delete;
+
+    /**
+     * @brief Загрузка остатков из базы
+     */
+    void load(const std::vector<StockLevel> &levels);
+
+    /**
+     * @brief Резервирование количества для продажи
+     */
+    Reservation reserve(int compactId, int quantity);
+
+    /**
+     * @brief Продажа записана в базу: резерв снимается, остаток уже уменьшен
+     */
+    void commit(int compactId, int quantity);
+
+    /**
+     * @brief Продажа не записана: резерв возвращается в остаток
+     */
+    void release(int compactId, int quantity);
+
+    /**
+     * @brief Сверка с остатком в базе
+     *
+     * Вызывается под блокировкой записи, чтобы в базе были все продажи,
+     * кроме еще зарезервированных.
+     *
+     * @param compactId Идентификатор компакт-диска
+     * @param remaining Остаток в базе (-1 - диск удален, остаток 0)
+     */
+    void reconcile(int compactId, long long remaining);
+
+    /**
+     * @brief Доступный остаток (-1 - диск не загружен)
+     */
+    long long available(int compactId) const;
+
+    /**
+     * @brief Количество дисков в таблице
+     */
+    size_t size() const;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "ReportTypes.h"
+
+/**
+ * @brief Интерфейс хранилища каталога, операций и сводных отчетов
+ *
+ * Реализации: SqliteStorage (база данных SQLite через MusicStoreDB) и
+ * MemoryStorage (структуры в памяти с журналом на диске).
+ */
+class StorageBackend {
+public:
+    virtual ~StorageBackend() = default;
+
+    /**
+     * @brief Добавление компакт-диска
+     *
+     * @return Идентификатор компакт-диска или -1 при ошибке
+     */
+    virtual int addCompactDisc(const std::string &productionDate, const std::string &company, float price) = 0;
+
+    /**
+     * @brief Добавление музыкального произведения
+     *
+     * @return Идентификатор произведения или -1 при ошибке
+     */
+    virtual int addMusicalWork(const std::string &title, const std::string &author,
+                               const std::string &performer, int compactId) = 0;
+
+    /**
+     * @brief Обновление компании и цены компакт-диска
+     */
+    virtual bool updateCompactDisc(int compactId, const std::string &company, float price) = 0;
+
+    /**
+     * @brief Удаление компакт-диска
+     */
+    virtual bool deleteCompactDisc(int compactId) = 0;
+
+    /**
+     * @brief Регистрация операции (поступление/продажа)
+     *
+     * Продажа больше остатка отклоняется.
+     *
+     * @param operationDate Дата операции (YYYY-MM-DD; пустая строка - текущая дата)
+     * @return Идентификатор операции или -1 при ошибке
+     */
+    virtual int registerOperation(const std::string &operationType, int compactId, int quantity,
+                                  const std::string &operationDate) = 0;
+
+    /**
+     * @brief Текущий остаток компакт-диска
+     *
+     * @return Остаток или -1, если компакт-диск не найден
+     */
+    virtual long long getStockLevel(int compactId) = 0;
+
+    /**
+     * @brief Поступления и продажи компакт-диска за период (границы включаются)
+     */
+    virtual PeriodTotals getPeriodTotals(int compactId, const std::string &startDate,
+                                         const std::string &endDate) = 0;
+
+    /**
+     * @brief Продажи по исполнителям
+     */
+    virtual std::vector<PerformerSales> getPerformerSales() = 0;
+
+    /**
+     * @brief Продажи по авторам
+     */
+    virtual std::vector<AuthorSales> getAuthorSales() = 0;
+
+    /**
+     * @brief Сводная стоимость запасов
+     */
+    virtual InventoryValue getInventoryValue() = 0;
+};
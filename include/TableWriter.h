@@ -0,0 +1,140 @@
+#pragma once
+
+#include <initializer_list>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Буферизованный вывод табличных отчетов
+ *
+ * Строки накапливаются в памяти, ширина колонок вычисляется по
+ * количеству отображаемых символов UTF-8, а весь отчет выводится
+ * одной операцией записи в поток. Ячейки и буфер вывода размещаются в
+ * переданном ресурсе памяти (например, в арене отчета ReportArena).
+ */
+class TableWriter {
+public:
+    /**
+     * @brief Формат вывода
+     */
+    enum class Format {
+        Text, // Выровненная таблица для консоли
+        Csv,  // CSV (RFC 4180)
+        Tsv,  // Значения, разделенные табуляцией
+        Json  // Массив JSON-объектов
+    };
+
+private:
+    Format format;                                             // Формат вывода
+    std::pmr::memory_resource *resource;                       // Память ячеек и вывода
+    std::pmr::vector<std::pmr::string> header;                 // Заголовки колонок
+    std::pmr::vector<std::pmr::vector<std::pmr::string>> rows; // Строки таблицы
+
+    template <typename String>
+    void renderTo(String &out) const;
+    template <typename String>
+    void renderText(String &out) const;
+    template <typename String>
+    void renderDelimited(String &out, char delimiter) const;
+    template <typename String>
+    void renderJson(String &out) const;
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * @param format Формат вывода
+     * @param resource Ресурс памяти для ячеек и буфера вывода
+     */
+    explicit TableWriter(Format format = Format::Text,
+                         std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Установка заголовков колонок
+     */
+    void setHeader(std::initializer_list<std::string_view> columns);
+    void setHeader(const std::vector<std::string> &columns);
+
+    /**
+     * @brief Добавление заголовка следующей колонки
+     */
+    void addHeaderColumn(std::string_view column);
+
+    /**
+     * @brief Проверка, заданы ли заголовки
+     */
+    bool hasHeader() const { return !header.empty(); }
+
+    /**
+     * @brief Добавление строки
+     */
+    void addRow(std::initializer_list<std::string_view> cells);
+    void addRow(const std::vector<std::string> &cells);
+
+    /**
+     * @brief Начало новой строки, ячейки которой добавляются addCell()
+     */
+    void beginRow();
+
+    /**
+     * @brief Добавление ячейки в последнюю строку
+     */
+    void addCell(std::string_view cell);
+
+    /**
+     * @brief Количество строк
+     */
+    size_t rowCount() const { return rows.size(); }
+
+    /**
+     * @brief Формирование отчета в памяти
+     */
+    std::string render() const;
+
+    /**
+     * @brief Вывод отчета в поток одной операцией записи
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Ширина строки UTF-8 в позициях терминала
+     *
+     * Продолжающие байты не учитываются, широкие символы (CJK) занимают две позиции.
+     */
+    static size_t displayWidth(std::string_view text);
+
+    /**
+     * @brief Форматирование числа кратчайшей записью, которая читается обратно без потерь
+     */
+    static std::string formatNumber(double value);
+
+    /**
+     * @brief Разбор названия формата ("text", "csv", "tsv", "json")
+     *
+     * @param name Название формата
+     * @param format Результат разбора
+     * @return true если название распознано
+     */
+    static bool parseFormat(const std::string &name, Format &format);
+
+    /**
+     * @brief Дописывание значения CSV (в кавычках, если нужно)
+     */
+    static void appendCsvField(std::string &out, std::string_view value);
+    static void appendCsvField(std::pmr::string &out, std::string_view value);
+
+    /**
+     * @brief Дописывание строки JSON в кавычках с экранированием
+     */
+    static void appendJsonString(std::string &out, std::string_view value);
+    static void appendJsonString(std::pmr::string &out, std::string_view value);
+
+    /**
+     * @brief Дописывание значения JSON: число без кавычек, иначе строка
+     */
+    static void appendJsonValue(std::string &out, std::string_view value);
+    static void appendJsonValue(std::pmr::string &out, std::string_view value);
+};
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "MusicStoreDB.h"
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 /**
  * @brief Класс пользовательского интерфейса консольного приложения
@@ -43,6 +47,61 @@ private:
      * @param choice Выбранная команда
      */
     void processUserCommand(int choice);
+    
+    /**
+     * @brief Поиск по каталогу с постраничным просмотром результатов
+     */
+    void searchCatalog();
+    
+    /**
+     * @brief Выполнение долгого отчета в рабочем потоке
+     * 
+     * Пока отчет выполняется, выводится ход выполнения с подсказкой об
+     * отмене. Отчет отменяет строка "q": ввод читается построчно, поэтому
+     * после q нужно нажать Enter. Если стандартный ввод не терминал, отчет
+     * выполняется сразу.
+     * 
+     * @param report Функция, формирующая отчет
+     */
+    void runReport(const std::function<void()>& report);
+    
+    /**
+     * @brief Разбор строки пакетной команды на аргументы
+     * 
+     * Аргументы разделяются пробелами; значение с пробелами берется в кавычки.
+     * 
+     * @param line Строка команды
+     * @return Список аргументов (пустой для пустой строки и комментария)
+     */
+    static std::vector<std::string> splitCommand(const std::string& line);
+    
+    /**
+     * @brief Разбор списка идентификаторов через запятую ("1,5,12")
+     * 
+     * @param text Строка со списком
+     * @return Идентификаторы или std::nullopt, если хотя бы один элемент пуст,
+     *         не является числом или не помещается в int
+     */
+    static std::optional<std::vector<int>> parseIdList(const std::string& text);
+    
+    /**
+     * @brief Разбор выбора компакт-дисков для пакетных операций
+     * 
+     * Строка из цифр и запятых - список идентификаторов; название компании из
+     * одних цифр задается как company:<название>.
+     * 
+     * @param text "all", список идентификаторов через запятую, company:<название> или название компании
+     * @return Выбор компакт-дисков или std::nullopt, если список идентификаторов неверен
+     */
+    static std::optional<DiscSelection> parseDiscSelection(const std::string& text);
+    
+    /**
+     * @brief Выполнение одной пакетной команды
+     * 
+     * @param args Команда и ее аргументы
+     * @return true если команда выполнена успешно
+     */
+    bool executeBatchCommand(const std::vector<std::string>& args);
 
 public:
     /**
@@ -64,4 +123,23 @@ public:
      * @return true если аутентификация успешна
      */
     bool authenticate();
+    
+    /**
+     * @brief Пакетный режим: выполнение команд без интерактивного меню
+     * 
+     * Команды читаются по одной в строке (например, "sale 12 3",
+     * "report 2024-01-01 2024-01-31"); первой должна идти команда
+     * "login <пользователь> <пароль>". Вывод буферизуется и сбрасывается
+     * крупными блоками.
+     * 
+     * @param in Поток команд
+     * @param out Поток для вывода результатов
+     * Если транзакцию не удалось начать, команда не выполняется; если ее не
+     * удалось зафиксировать или SQLite откатил ее сам, все команды транзакции
+     * считаются невыполненными и перечисляются в stderr с номерами строк.
+     * 
+     * @param transactionSize Количество команд в одной транзакции (0 - без транзакций)
+     * @return Количество команд, завершившихся ошибкой
+     */
+    int runBatch(std::istream& in, std::ostream& out, int transactionSize = 0);
 };
\ No newline at end of file
@@ -0,0 +1,371 @@
+#include "../include/AnalyticsSnapshot.h"
+#include "../include/MemoryStorage.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MUSIC_STORE_X86 1
+#endif
+
+namespace {
+
+// Отсортированный словарь без повторов
+std::vector<std::string> buildDictionary(std::vector<std::string> names) {
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+uint32_t dictionaryCode(const std::vector<std::string>& dictionary, const std::string& name) {
+    return static_cast<uint32_t>(std::lower_bound(dictionary.begin(), dictionary.end(), name) - dictionary.begin());
+}
+
+// Суммы без векторных инструкций
+void aggregateScalar(const int32_t* day, const uint8_t* type, const int32_t* quantity, const double* price,
+                     size_t n, int32_t from, int32_t to, DiscPeriodTotals& totals) {
+    for (size_t i = 0; i < n; i++) {
+        if (day[i] < from || day[i] > to) {
+            continue;
+        }
+        if (type[i]) {
+            totals.sold += quantity[i];
+            totals.revenue += quantity[i] * price[i];
+        } else {
+            totals.received += quantity[i];
+        }
+    }
+}
+
+#ifdef MUSIC_STORE_X86
+
+// Суммы по 4 строки за шаг (SSE2)
+__attribute__((target("sse2")))
+void aggregateSse2(const int32_t* day, const uint8_t* type, const int32_t* quantity, const double* price,
+                   size_t n, int32_t from, int32_t to, DiscPeriodTotals& totals) {
+    const __m128i fromV = _mm_set1_epi32(from);
+    const __m128i toV = _mm_set1_epi32(to);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i zero = _mm_setzero_si128();
+    // Количества накапливаются в double: целые до 2^53 складываются точно
+    __m128d sold = _mm_setzero_pd();
+    __m128d received = _mm_setzero_pd();
+    __m128d revenue = _mm_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(day + i));
+        __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i*>(quantity + i));
+        int32_t packed;
+        std::memcpy(&packed, type + i, sizeof(packed));
+        __m128i t = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+        
+        __m128i outside = _mm_or_si128(_mm_cmplt_epi32(d, fromV), _mm_cmpgt_epi32(d, toV));
+        __m128i sale = _mm_cmpeq_epi32(t, one);
+        __m128i soldQ = _mm_andnot_si128(outside, _mm_and_si128(sale, q));
+        __m128i receivedQ = _mm_andnot_si128(_mm_or_si128(outside, sale), q);
+        
+        __m128d soldLo = _mm_cvtepi32_pd(soldQ);
+        __m128d soldHi = _mm_cvtepi32_pd(_mm_shuffle_epi32(soldQ, _MM_SHUFFLE(1, 0, 3, 2)));
+        sold = _mm_add_pd(sold, _mm_add_pd(soldLo, soldHi));
+        received = _mm_add_pd(received, _mm_add_pd(_mm_cvtepi32_pd(receivedQ),
+            _mm_cvtepi32_pd(_mm_shuffle_epi32(receivedQ, _MM_SHUFFLE(1, 0, 3, 2)))));
+        revenue = _mm_add_pd(revenue, _mm_add_pd(_mm_mul_pd(soldLo, _mm_loadu_pd(price + i)),
+                                                 _mm_mul_pd(soldHi, _mm_loadu_pd(price + i + 2))));
+    }
+    
+    double lanes[2];
+    _mm_storeu_pd(lanes, sold);
+    totals.sold += static_cast<long long>(lanes[0] + lanes[1]);
+    _mm_storeu_pd(lanes, received);
+    totals.received += static_cast<long long>(lanes[0] + lanes[1]);
+    _mm_storeu_pd(lanes, revenue);
+    totals.revenue += lanes[0] + lanes[1];
+    
+    aggregateScalar(day + i, type + i, quantity + i, price + i, n - i, from, to, totals);
+}
+
+// Суммы по 8 строк за шаг (AVX2)
+__attribute__((target("avx2")))
+void aggregateAvx2(const int32_t* day, const uint8_t* type, const int32_t* quantity, const double* price,
+                   size_t n, int32_t from, int32_t to, DiscPeriodTotals& totals) {
+    const __m256i fromV = _mm256_set1_epi32(from);
+    const __m256i toV = _mm256_set1_epi32(to);
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i sold = _mm256_setzero_si256();
+    __m256i received = _mm256_setzero_si256();
+    __m256d revenue = _mm256_setzero_pd();
+    
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(day + i));
+        __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(quantity + i));
+        __m256i t = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(type + i)));
+        
+        __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(fromV, d), _mm256_cmpgt_epi32(d, toV));
+        __m256i sale = _mm256_cmpeq_epi32(t, one);
+        __m256i soldQ = _mm256_andnot_si256(outside, _mm256_and_si256(sale, q));
+        __m256i receivedQ = _mm256_andnot_si256(_mm256_or_si256(outside, sale), q);
+        
+        __m128i soldLo = _mm256_castsi256_si128(soldQ);
+        __m128i soldHi = _mm256_extracti128_si256(soldQ, 1);
+        sold = _mm256_add_epi64(sold, _mm256_add_epi64(_mm256_cvtepi32_epi64(soldLo), _mm256_cvtepi32_epi64(soldHi)));
+        received = _mm256_add_epi64(received,
+            _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(receivedQ)),
+                             _mm256_cvtepi32_epi64(_mm256_extracti128_si256(receivedQ, 1))));
+        revenue = _mm256_add_pd(revenue,
+            _mm256_add_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(soldLo), _mm256_loadu_pd(price + i)),
+                          _mm256_mul_pd(_mm256_cvtepi32_pd(soldHi), _mm256_loadu_pd(price + i + 4))));
+    }
+    
+    long long counts[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(counts), sold);
+    totals.sold += counts[0] + counts[1] + counts[2] + counts[3];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(counts), received);
+    totals.received += counts[0] + counts[1] + counts[2] + counts[3];
+    double lanes[4];
+    _mm256_storeu_pd(lanes, revenue);
+    totals.revenue += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    
+    aggregateScalar(day + i, type + i, quantity + i, price + i, n - i, from, to, totals);
+}
+
+#endif
+
+} // namespace
+
+// Конструктор
+AnalyticsSnapshot::AnalyticsSnapshot() : operations(0), simdLevel(detectSimdLevel()) {
+}
+
+void AnalyticsSnapshot::addDisc(int compactId, double price) {
+    stagedPrices[compactId] = price;
+}
+
+void AnalyticsSnapshot::addWork(int workId, int compactId, const std::string& author, const std::string& performer) {
+    stagedWorks.push_back({workId, compactId, author, performer});
+}
+
+void AnalyticsSnapshot::addOperation(int compactId, int32_t day, bool sale, int32_t quantity) {
+    stagedOperations.push_back({compactId, day, static_cast<uint8_t>(sale ? 1 : 0), quantity});
+}
+
+// Построение столбцов
+void AnalyticsSnapshot::build() {
+    discIds.clear();
+    for (const auto& entry : stagedPrices) {
+        discIds.push_back(entry.first);
+    }
+    std::sort(discIds.begin(), discIds.end());
+    
+    std::unordered_map<int, size_t> discIndex;
+    for (size_t i = 0; i < discIds.size(); i++) {
+        discIndex[discIds[i]] = i;
+    }
+    
+    // Операции компакт-дисков, которых нет в каталоге, в отчеты не попадают
+    stagedOperations.erase(std::remove_if(stagedOperations.begin(), stagedOperations.end(),
+        [&](const StagedOperation& op) { return !discIndex.count(op.compactId); }), stagedOperations.end());
+    std::stable_sort(stagedOperations.begin(), stagedOperations.end(),
+        [](const StagedOperation& a, const StagedOperation& b) {
+            return a.compactId != b.compactId ? a.compactId < b.compactId : a.day < b.day;
+        });
+    operations = stagedOperations.size();
+    
+    std::vector<size_t> discStart(discIds.size() + 1, 0);
+    for (const StagedOperation& op : stagedOperations) {
+        discStart[discIndex[op.compactId] + 1]++;
+    }
+    for (size_t i = 0; i < discIds.size(); i++) {
+        discStart[i + 1] += discStart[i];
+    }
+    
+    auto appendSegment = [&](Projection& projection, uint32_t group, size_t disc) {
+        projection.segmentGroup.push_back(group);
+        double price = stagedPrices[discIds[disc]];
+        for (size_t i = discStart[disc]; i < discStart[disc + 1]; i++) {
+            projection.day.push_back(stagedOperations[i].day);
+            projection.type.push_back(stagedOperations[i].type);
+            projection.quantity.push_back(stagedOperations[i].quantity);
+            projection.price.push_back(price);
+        }
+        projection.segmentStart.push_back(projection.day.size());
+    };
+    
+    byDisc = Projection();
+    byDisc.segmentStart.push_back(0);
+    for (size_t disc = 0; disc < discIds.size(); disc++) {
+        appendSegment(byDisc, static_cast<uint32_t>(disc), disc);
+    }
+    
+    stagedWorks.erase(std::remove_if(stagedWorks.begin(), stagedWorks.end(),
+        [&](const StagedWork& work) { return !discIndex.count(work.compactId); }), stagedWorks.end());
+    
+    std::vector<std::string> authorNames;
+    std::vector<std::string> performerNames;
+    for (const StagedWork& work : stagedWorks) {
+        authorNames.push_back(work.author);
+        performerNames.push_back(work.performer);
+    }
+    authors = buildDictionary(std::move(authorNames));
+    performers = buildDictionary(std::move(performerNames));
+    
+    auto buildWorkProjection = [&](Projection& projection, const std::vector<std::string>& dictionary,
+                                   std::string StagedWork::*name) {
+        std::vector<std::pair<uint32_t, size_t>> order;
+        for (size_t i = 0; i < stagedWorks.size(); i++) {
+            order.emplace_back(dictionaryCode(dictionary, stagedWorks[i].*name), i);
+        }
+        std::sort(order.begin(), order.end());
+        
+        projection = Projection();
+        projection.segmentStart.push_back(0);
+        for (const auto& entry : order) {
+            appendSegment(projection, entry.first, discIndex[stagedWorks[entry.second].compactId]);
+        }
+    };
+    
+    buildWorkProjection(byAuthor, authors, &StagedWork::author);
+    buildWorkProjection(byPerformer, performers, &StagedWork::performer);
+    
+    stagedPrices.clear();
+    stagedWorks.clear();
+    stagedWorks.shrink_to_fit();
+    stagedOperations.clear();
+    stagedOperations.shrink_to_fit();
+}
+
+size_t AnalyticsSnapshot::operationCount() const {
+    return operations;
+}
+
+// Границы периода
+bool AnalyticsSnapshot::parseRange(const std::string& startDate, const std::string& endDate,
+                                   int32_t& from, int32_t& to) {
+    from = startDate.empty() ? INT32_MIN : MemoryStorage::parseDate(startDate);
+    to = endDate.empty() ? INT32_MAX : MemoryStorage::parseDate(endDate);
+    return from != -1 && to != -1;
+}
+
+// Суммы по диапазону строк
+DiscPeriodTotals AnalyticsSnapshot::aggregate(const Projection& projection, size_t begin, size_t end,
+                                              int32_t from, int32_t to) const {
+    DiscPeriodTotals totals{0, 0, 0, 0.0};
+    const int32_t* day = projection.day.data() + begin;
+    const uint8_t* type = projection.type.data() + begin;
+    const int32_t* quantity = projection.quantity.data() + begin;
+    const double* price = projection.price.data() + begin;
+    size_t n = end - begin;
+    
+    switch (simdLevel) {
+#ifdef MUSIC_STORE_X86
+        case SimdLevel::Avx2:
+            aggregateAvx2(day, type, quantity, price, n, from, to, totals);
+            break;
+        case SimdLevel::Sse2:
+            aggregateSse2(day, type, quantity, price, n, from, to, totals);
+            break;
+#endif
+        default:
+            aggregateScalar(day, type, quantity, price, n, from, to, totals);
+    }
+    return totals;
+}
+
+// Продажи по авторам
+std::vector<AuthorSales> AnalyticsSnapshot::authorSales(const std::string& startDate, const std::string& endDate) const {
+    std::vector<AuthorSales> result;
+    int32_t from, to;
+    if (!parseRange(startDate, endDate, from, to)) {
+        return result;
+    }
+    
+    std::vector<AuthorSales> rows(authors.size(), AuthorSales{"", 0, 0, 0.0});
+    for (size_t s = 0; s < byAuthor.segmentGroup.size(); s++) {
+        DiscPeriodTotals totals = aggregate(byAuthor, byAuthor.segmentStart[s], byAuthor.segmentStart[s + 1], from, to);
+        if (totals.sold > 0) {
+            AuthorSales& row = rows[byAuthor.segmentGroup[s]];
+            row.totalSold += totals.sold;
+            row.worksCount++;
+            row.totalRevenue += totals.revenue;
+        }
+    }
+    
+    for (size_t code = 0; code < rows.size(); code++) {
+        if (rows[code].totalSold > 0) {
+            rows[code].author = authors[code];
+            result.push_back(rows[code]);
+        }
+    }
+    return result;
+}
+
+// Продажи по исполнителям
+std::vector<PerformerSales> AnalyticsSnapshot::performerSales(const std::string& startDate,
+                                                              const std::string& endDate) const {
+    std::vector<PerformerSales> result;
+    int32_t from, to;
+    if (!parseRange(startDate, endDate, from, to)) {
+        return result;
+    }
+    
+    std::vector<long long> sold(performers.size(), 0);
+    for (size_t s = 0; s < byPerformer.segmentGroup.size(); s++) {
+        sold[byPerformer.segmentGroup[s]] +=
+            aggregate(byPerformer, byPerformer.segmentStart[s], byPerformer.segmentStart[s + 1], from, to).sold;
+    }
+    
+    for (size_t code = 0; code < sold.size(); code++) {
+        if (sold[code] > 0) {
+            result.push_back({performers[code], sold[code]});
+        }
+    }
+    return result;
+}
+
+// Поступления и продажи по компакт-дискам
+std::vector<DiscPeriodTotals> AnalyticsSnapshot::periodStatistics(const std::string& startDate,
+                                                                  const std::string& endDate) const {
+    std::vector<DiscPeriodTotals> result;
+    int32_t from, to;
+    if (!parseRange(startDate, endDate, from, to)) {
+        return result;
+    }
+    
+    for (size_t s = 0; s < byDisc.segmentGroup.size(); s++) {
+        DiscPeriodTotals totals = aggregate(byDisc, byDisc.segmentStart[s], byDisc.segmentStart[s + 1], from, to);
+        totals.compactId = discIds[byDisc.segmentGroup[s]];
+        result.push_back(totals);
+    }
+    return result;
+}
+
+void AnalyticsSnapshot::setSimdLevel(SimdLevel level) {
+    simdLevel = std::min(level, detectSimdLevel());
+}
+
+SimdLevel AnalyticsSnapshot::getSimdLevel() const {
+    return simdLevel;
+}
+
+// Определение поддерживаемых инструкций
+SimdLevel AnalyticsSnapshot::detectSimdLevel() {
+#ifdef MUSIC_STORE_X86
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::Avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::Sse2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+const char* AnalyticsSnapshot::simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2: return "avx2";
+        case SimdLevel::Sse2: return "sse2";
+        default: return "scalar";
+    }
+}
@@ -0,0 +1,106 @@
+#include "../include/CatalogCache.h"
+
+// Добавление компакт-диска в снимок
+void CatalogSnapshot::addDisc(CatalogDisc disc) {
+    int compactId = disc.compactId;
+    discs[compactId] = std::move(disc);
+}
+
+// Добавление произведения в снимок
+bool CatalogSnapshot::addWork(int compactId, CatalogWork work) {
+    auto it = discs.find(compactId);
+    if (it == discs.end()) {
+        return false;
+    }
+    it->second.works.push_back(std::move(work));
+    return true;
+}
+
+// Поиск компакт-диска
+const CatalogDisc* CatalogSnapshot::find(int compactId) const {
+    auto it = discs.find(compactId);
+    return it == discs.end() ? nullptr : &it->second;
+}
+
+// Идентификаторы компакт-дисков компании
+std::vector<int> CatalogSnapshot::discsOf(const std::string& company) const {
+    std::vector<int> compactIds;
+    for (const auto& entry : discs) {
+        if (entry.second.company == company) {
+            compactIds.push_back(entry.first);
+        }
+    }
+    return compactIds;
+}
+
+// Конструктор
+CatalogCache::CatalogCache() : current(nullptr), generation(0), swaps(0) {
+}
+
+// Изменение копии снимка и ее публикация
+void CatalogCache::update(const std::function<void(CatalogSnapshot&)>& change) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    generation++;
+    
+    // Не загруженный кеш не меняется: загрузка прочитает изменение из базы
+    std::shared_ptr<const CatalogSnapshot> previous = current.load(std::memory_order_acquire);
+    if (!previous) {
+        return;
+    }
+    
+    auto next = std::make_shared<CatalogSnapshot>(*previous);
+    change(*next);
+    current.store(std::move(next), std::memory_order_release);
+    swaps++;
+}
+
+// Публикация загруженного снимка
+bool CatalogCache::publish(std::shared_ptr<const CatalogSnapshot> snapshot, uint64_t startGeneration) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (generation.load() != startGeneration) {
+        return false;
+    }
+    current.store(std::move(snapshot), std::memory_order_release);
+    swaps++;
+    return true;
+}
+
+// Добавление или замена компакт-диска
+void CatalogCache::putDisc(int compactId, const std::string& productionDate, const std::string& company,
+                           double price) {
+    update([&](CatalogSnapshot& snapshot) {
+        CatalogDisc& disc = snapshot.discs[compactId];
+        disc.compactId = compactId;
+        disc.productionDate = productionDate;
+        disc.company = company;
+        disc.price = price;
+    });
+}
+
+// Изменение компании и цены
+void CatalogCache::updateDisc(int compactId, const std::string& company, double price) {
+    update([&](CatalogSnapshot& snapshot) {
+        auto it = snapshot.discs.find(compactId);
+        if (it != snapshot.discs.end()) {
+            it->second.company = company;
+            it->second.price = price;
+        }
+    });
+}
+
+// Удаление компакт-диска
+void CatalogCache::removeDisc(int compactId) {
+    update([&](CatalogSnapshot& snapshot) { snapshot.discs.erase(compactId); });
+}
+
+// Добавление произведения
+void CatalogCache::addWork(int compactId, CatalogWork work) {
+    update([&](CatalogSnapshot& snapshot) { snapshot.addWork(compactId, std::move(work)); });
+}
+
+// Сброс кеша
+void CatalogCache::invalidate() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    generation++;
+    current.store(nullptr, std::memory_order_release);
+}
@@ -0,0 +1,205 @@
+#include "../include/ChangeLog.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Формат файла: заголовок, затем записи фиксированного размера
+const char LOG_MAGIC[8] = {'M', 'S', 'C', 'D', 'C', '0', '0', '1'};
+const size_t HEADER_SIZE = 64;
+const size_t COUNT_OFFSET = 8;
+const size_t RECORD_SIZE = 24;
+const size_t INITIAL_CAPACITY = 64 * 1024;
+
+size_t recordOffset(uint64_t sequence) {
+    return HEADER_SIZE + (sequence - 1) * RECORD_SIZE;
+}
+
+void encodeRecord(char* dst, const ChangeRecord& record) {
+    std::memset(dst, 0, RECORD_SIZE);
+    std::memcpy(dst, &record.sequence, sizeof(record.sequence));
+    std::memcpy(dst + 8, &record.rowId, sizeof(record.rowId));
+    dst[16] = static_cast<char>(record.op);
+    dst[17] = static_cast<char>(record.table);
+}
+
+ChangeRecord decodeRecord(const char* src) {
+    ChangeRecord record;
+    std::memcpy(&record.sequence, src, sizeof(record.sequence));
+    std::memcpy(&record.rowId, src + 8, sizeof(record.rowId));
+    record.op = static_cast<ChangeOp>(src[16]);
+    record.table = static_cast<ChangeTable>(src[17]);
+    return record;
+}
+
+} // namespace
+
+// Конструктор
+ChangeLog::ChangeLog(const std::string& path, bool readOnly)
+    : fd(-1), base(nullptr), mappedSize(0), readOnly(readOnly) {
+    fd = readOnly ? ::open(path.c_str(), O_RDONLY) : ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+
+    if (fd < 0) {
+        std::cerr << "Не удалось открыть журнал изменений: " << path << std::endl;
+        return;
+    }
+
+    // Два писателя дописывали бы записи по одному и тому же смещению
+    if (!readOnly && flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        std::cerr << "Журнал изменений уже открыт для записи другим процессом: " << path << std::endl;
+        ::close(fd);
+        fd = -1;
+        return;
+    }
+
+    struct stat st;
+    fstat(fd, &st);
+    size_t size = static_cast<size_t>(st.st_size);
+
+    // Новый журнал: резервируем место и записываем заголовок
+    if (size < HEADER_SIZE) {
+        if (readOnly) {
+            std::cerr << "Журнал изменений пуст: " << path << std::endl;
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+        size = INITIAL_CAPACITY;
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0 || !remap(size)) {
+            std::cerr << "Не удалось создать журнал изменений: " << path << std::endl;
+            return;
+        }
+        std::memcpy(base, LOG_MAGIC, sizeof(LOG_MAGIC));
+        return;
+    }
+
+    if (!remap(size)) {
+        std::cerr << "Не удалось отобразить журнал изменений: " << path << std::endl;
+        return;
+    }
+
+    if (std::memcmp(base, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+        std::cerr << "Файл не является журналом изменений: " << path << std::endl;
+        munmap(base, mappedSize);
+        base = nullptr;
+        mappedSize = 0;
+    }
+}
+
+// Деструктор
+ChangeLog::~ChangeLog() {
+    if (base) {
+        if (!readOnly) {
+            msync(base, mappedSize, MS_ASYNC);
+        }
+        munmap(base, mappedSize);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+// Отображение файла в память
+bool ChangeLog::remap(size_t size) const {
+    if (base) {
+        munmap(base, mappedSize);
+        base = nullptr;
+        mappedSize = 0;
+    }
+
+    int prot = readOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* addr = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    base = static_cast<char*>(addr);
+    mappedSize = size;
+    return true;
+}
+
+// Количество опубликованных записей
+uint64_t ChangeLog::publishedCount() const {
+    return __atomic_load_n(reinterpret_cast<uint64_t*>(base + COUNT_OFFSET), __ATOMIC_ACQUIRE);
+}
+
+// Дозапись пакета изменений
+uint64_t ChangeLog::append(std::vector<ChangeRecord>& batch) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!base || readOnly) {
+        return 0;
+    }
+
+    uint64_t count = publishedCount();
+    if (batch.empty()) {
+        return count;
+    }
+
+    // Рост файла удвоением, чтобы дозапись оставалась амортизированно O(1)
+    size_t required = recordOffset(count + batch.size() + 1);
+    if (required > mappedSize) {
+        size_t capacity = mappedSize;
+        while (capacity < required) {
+            capacity *= 2;
+        }
+        if (ftruncate(fd, static_cast<off_t>(capacity)) != 0 || !remap(capacity)) {
+            std::cerr << "Не удалось расширить журнал изменений" << std::endl;
+            return 0;
+        }
+    }
+
+    for (auto& record : batch) {
+        record.sequence = ++count;
+        encodeRecord(base + recordOffset(record.sequence), record);
+    }
+
+    // Публикация пакета после записи всех его записей
+    __atomic_store_n(reinterpret_cast<uint64_t*>(base + COUNT_OFFSET), count, __ATOMIC_RELEASE);
+    return count;
+}
+
+// Номер последней опубликованной записи
+uint64_t ChangeLog::lastSequence() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return base ? publishedCount() : 0;
+}
+
+// Чтение изменений после заданного номера
+std::vector<ChangeRecord> ChangeLog::readFrom(uint64_t afterSequence, size_t maxRecords) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<ChangeRecord> result;
+
+    if (!base) {
+        return result;
+    }
+
+    uint64_t count = publishedCount();
+    if (afterSequence >= count || maxRecords == 0) {
+        return result;
+    }
+
+    uint64_t last = std::min<uint64_t>(count, afterSequence + maxRecords);
+
+    // Писатель в другом процессе мог расширить файл
+    if (recordOffset(last + 1) > mappedSize) {
+        struct stat st;
+        fstat(fd, &st);
+        if (!remap(static_cast<size_t>(st.st_size))) {
+            return result;
+        }
+    }
+
+    result.reserve(static_cast<size_t>(last - afterSequence));
+    for (uint64_t seq = afterSequence + 1; seq <= last; seq++) {
+        result.push_back(decodeRecord(base + recordOffset(seq)));
+    }
+
+    return result;
+}
@@ -0,0 +1,107 @@
+#include "../include/CsvParser.h"
+#include <algorithm>
+#include <cstring>
+
+// Разбор одной записи
+bool CsvParser::parseRecord(const char*& pos, const char* end, Record& fields) {
+    fields.clear();
+    if (pos >= end) {
+        return false;
+    }
+
+    std::string field;
+    bool quoted = false;
+
+    while (pos < end) {
+        char c = *pos++;
+
+        if (quoted) {
+            if (c != '"') {
+                field += c;
+            } else if (pos < end && *pos == '"') {
+                // Удвоенная кавычка внутри значения
+                field += '"';
+                pos++;
+            } else {
+                quoted = false;
+            }
+            continue;
+        }
+
+        if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.push_back(std::move(field));
+            field.clear();
+        } else if (c == '\n') {
+            break;
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+
+    fields.push_back(std::move(field));
+    return true;
+}
+
+// Разбиение данных на части по границам записей
+std::vector<std::pair<size_t, size_t>> CsvParser::splitChunks(const char* data, size_t size, size_t parts) {
+    std::vector<std::pair<size_t, size_t>> chunks;
+    parts = std::max<size_t>(parts, 1);
+
+    size_t start = 0;
+    size_t scanned = 0;
+    size_t quotes = 0;
+
+    for (size_t i = 1; i < parts && start < size; i++) {
+        size_t target = std::max(size * i / parts, start);
+
+        // Четность кавычек перед позицией показывает, находимся ли мы внутри значения
+        quotes += static_cast<size_t>(std::count(data + scanned, data + target, '"'));
+        scanned = target;
+
+        size_t pos = target;
+        while (pos < size) {
+            const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+            if (!newline) {
+                pos = size;
+                break;
+            }
+            size_t offset = static_cast<size_t>(newline - data);
+            quotes += static_cast<size_t>(std::count(data + pos, newline, '"'));
+            pos = offset + 1;
+            scanned = pos;
+            if (quotes % 2 == 0) {
+                break;
+            }
+        }
+
+        if (pos >= size) {
+            break;
+        }
+        chunks.emplace_back(start, pos);
+        start = pos;
+    }
+
+    if (start < size) {
+        chunks.emplace_back(start, size);
+    }
+    return chunks;
+}
+
+// Разбор части данных
+std::vector<CsvParser::Record> CsvParser::parseChunk(const char* begin, const char* end) {
+    std::vector<Record> records;
+    // Оценка по средней длине строки каталога, чтобы избежать частых перераспределений
+    records.reserve(static_cast<size_t>(end - begin) / 48 + 1);
+
+    Record fields;
+    const char* pos = begin;
+    while (parseRecord(pos, end, fields)) {
+        if (fields.size() == 1 && fields[0].empty()) {
+            continue;
+        }
+        records.push_back(std::move(fields));
+    }
+    return records;
+}
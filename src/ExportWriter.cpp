@@ -0,0 +1,225 @@
+#include "../include/ExportWriter.h"
+#include "../include/TableWriter.h"
+#include <iostream>
+
+#ifdef MUSIC_STORE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+// Конструктор
+ExportWriter::ExportWriter(const std::string& path, Format format, bool compress, size_t bufferSize)
+    : format(format), path(path), tempPath(path + ".part"), file(nullptr), gzHandle(nullptr),
+      bufferSize(bufferSize), fieldIndex(0), rowsWritten(0), failed(false), closed(false) {
+    buffer.reserve(bufferSize + 4096);
+
+    if (compress) {
+#ifdef MUSIC_STORE_HAVE_ZLIB
+        gzHandle = gzopen(tempPath.c_str(), "wb6");
+        if (gzHandle) {
+            gzbuffer(static_cast<gzFile>(gzHandle), 256 * 1024);
+        }
+#else
+        std::cerr << "Сжатие недоступно: программа собрана без zlib" << std::endl;
+        failed = true;
+        closed = true;
+        return;
+#endif
+    } else {
+        file = std::fopen(tempPath.c_str(), "wb");
+        if (file) {
+            // Буферизацию выполняет сам писатель
+            std::setvbuf(file, nullptr, _IONBF, 0);
+        }
+    }
+
+    if (!isOpen()) {
+        std::cerr << "Не удалось открыть файл выгрузки: " << path << std::endl;
+        failed = true;
+        closed = true;
+    }
+}
+
+// Деструктор
+ExportWriter::~ExportWriter() {
+    discard();
+}
+
+// Сброс буфера в файл
+void ExportWriter::flush() {
+    if (buffer.empty() || failed) {
+        buffer.clear();
+        return;
+    }
+
+    if (file) {
+        failed = std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size();
+    }
+#ifdef MUSIC_STORE_HAVE_ZLIB
+    else if (gzHandle) {
+        failed = gzwrite(static_cast<gzFile>(gzHandle), buffer.data(),
+                         static_cast<unsigned>(buffer.size())) != static_cast<int>(buffer.size());
+    }
+#endif
+
+    if (failed) {
+        std::cerr << "Ошибка записи файла выгрузки" << std::endl;
+    }
+    buffer.clear();
+}
+
+// Установка названий колонок
+void ExportWriter::setColumns(const std::vector<std::string>& names) {
+    columns.clear();
+
+    if (format == Format::Csv) {
+        for (size_t i = 0; i < names.size(); i++) {
+            if (i > 0) {
+                buffer += ',';
+            }
+            TableWriter::appendCsvField(buffer, names[i]);
+        }
+        buffer += "\r\n";
+        return;
+    }
+
+    // Ключи JSON экранируются один раз, а не для каждой строки
+    for (const auto& name : names) {
+        std::string key;
+        TableWriter::appendJsonString(key, name);
+        key += ':';
+        columns.push_back(std::move(key));
+    }
+}
+
+// Начало строки
+void ExportWriter::beginRow() {
+    fieldIndex = 0;
+    if (format == Format::Ndjson) {
+        buffer += '{';
+    }
+}
+
+// Начало очередного поля строки
+void ExportWriter::beginField() {
+    if (fieldIndex > 0) {
+        buffer += ',';
+    }
+    if (format == Format::Ndjson) {
+        if (fieldIndex < columns.size()) {
+            buffer += columns[fieldIndex];
+        } else {
+            buffer += "\"column" + std::to_string(fieldIndex + 1) + "\":";
+        }
+    }
+    fieldIndex++;
+}
+
+// Текстовое значение поля
+void ExportWriter::addText(std::string_view value) {
+    beginField();
+    if (format == Format::Csv) {
+        TableWriter::appendCsvField(buffer, value);
+    } else {
+        TableWriter::appendJsonString(buffer, value);
+    }
+}
+
+// Числовое значение поля
+void ExportWriter::addNumber(std::string_view value) {
+    beginField();
+    buffer += value;
+}
+
+// Отсутствующее значение
+void ExportWriter::addNull() {
+    beginField();
+    if (format == Format::Ndjson) {
+        buffer += "null";
+    }
+}
+
+// Завершение строки
+void ExportWriter::endRow() {
+    buffer += format == Format::Csv ? "\r\n" : "}\n";
+    rowsWritten++;
+
+    if (buffer.size() >= bufferSize) {
+        flush();
+    }
+}
+
+// Сброс буфера и закрытие файла
+bool ExportWriter::close() {
+    if (closed) {
+        return !failed;
+    }
+    flush();
+
+    if (file) {
+        failed = std::fclose(file) != 0 || failed;
+        file = nullptr;
+    }
+#ifdef MUSIC_STORE_HAVE_ZLIB
+    if (gzHandle) {
+        failed = gzclose(static_cast<gzFile>(gzHandle)) != Z_OK || failed;
+        gzHandle = nullptr;
+    }
+#endif
+    closed = true;
+
+    // Итоговый файл появляется только целиком
+    if (!failed && std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Не удалось записать файл выгрузки: " << path << std::endl;
+        failed = true;
+    }
+    if (failed) {
+        std::remove(tempPath.c_str());
+    }
+    return !failed;
+}
+
+// Отмена выгрузки
+void ExportWriter::discard() {
+    if (closed) {
+        return;
+    }
+    failed = true;
+    buffer.clear();
+    close();
+}
+
+// Проверка поддержки сжатия
+bool ExportWriter::compressionAvailable() {
+#ifdef MUSIC_STORE_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Определение формата по имени файла
+bool ExportWriter::formatFromPath(const std::string& path, Format& format, bool& compress) {
+    std::string name = path;
+    compress = endsWith(name, ".gz");
+    if (compress) {
+        name.resize(name.size() - 3);
+    }
+
+    if (endsWith(name, ".csv")) {
+        format = Format::Csv;
+    } else if (endsWith(name, ".ndjson") || endsWith(name, ".jsonl")) {
+        format = Format::Ndjson;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,421 @@
+#include "../include/MemoryStorage.h"
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+// Экранирование поля журнала (поля разделяются табуляцией)
+std::string escapeField(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '\t': out += "\\t"; break;
+            case '\n': out += "\\n"; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+
+// Разбор строки журнала на поля
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields(1);
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (c == '\t') {
+            fields.emplace_back();
+        } else if (c == '\\' && i + 1 < line.size()) {
+            char next = line[++i];
+            fields.back() += next == 't' ? '\t' : next == 'n' ? '\n' : next;
+        } else {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+std::string formatPrice(float price) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", price);
+    return buffer;
+}
+
+std::string today() {
+    std::time_t t = std::time(nullptr);
+    char dateStr[11];
+    std::strftime(dateStr, sizeof(dateStr), "%Y-%m-%d", std::localtime(&t));
+    return dateStr;
+}
+
+} // namespace
+
+// Конструктор
+MemoryStorage::MemoryStorage(const std::string& journalPath)
+    : nextDiscId(1), nextWorkId(1), nextOperationId(1), journal(nullptr) {
+    if (journalPath.empty()) {
+        return;
+    }
+    
+    replayJournal(journalPath);
+    
+    journal = std::fopen(journalPath.c_str(), "ab");
+    if (!journal) {
+        std::cerr << "Не удалось открыть журнал хранилища: " << journalPath << std::endl;
+    }
+}
+
+// Деструктор
+MemoryStorage::~MemoryStorage() {
+    if (journal) {
+        std::fclose(journal);
+    }
+}
+
+// Разбор даты YYYY-MM-DD
+int MemoryStorage::parseDate(const std::string& date) {
+    if (date.size() != 10 || date[4] != '-' || date[7] != '-') {
+        return -1;
+    }
+    
+    int value = 0;
+    for (size_t i = 0; i < date.size(); i++) {
+        if (i == 4 || i == 7) {
+            continue;
+        }
+        if (date[i] < '0' || date[i] > '9') {
+            return -1;
+        }
+        value = value * 10 + (date[i] - '0');
+    }
+    
+    int month = value / 100 % 100;
+    int day = value % 100;
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        return -1;
+    }
+    return value;
+}
+
+// Дописывание записи в журнал
+void MemoryStorage::writeJournal(const std::vector<std::string>& fields) {
+    if (!journal) {
+        return;
+    }
+    
+    std::string line;
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (i > 0) {
+            line += '\t';
+        }
+        line += escapeField(fields[i]);
+    }
+    line += '\n';
+    
+    // Запись строкой целиком: при сбое в журнале может оборваться только последняя запись
+    std::fwrite(line.data(), 1, line.size(), journal);
+    std::fflush(journal);
+}
+
+// Воспроизведение журнала
+size_t MemoryStorage::replayJournal(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return 0;
+    }
+    
+    std::stringstream content;
+    content << in.rdbuf();
+    std::string data = content.str();
+    in.close();
+    
+    size_t applied = 0;
+    size_t start = 0;
+    size_t end;
+    
+    while ((end = data.find('\n', start)) != std::string::npos) {
+        std::vector<std::string> f = splitFields(data.substr(start, end - start));
+        start = end + 1;
+        
+        try {
+            if (f[0] == "disc" && f.size() == 5) {
+                applyAddDisc(std::stoi(f[1]), f[2], f[3], std::stof(f[4]));
+            } else if (f[0] == "work" && f.size() == 6) {
+                applyAddWork(std::stoi(f[1]), f[3], f[4], f[5], std::stoi(f[2]));
+            } else if (f[0] == "op" && f.size() == 6) {
+                applyOperation(std::stoi(f[1]), std::stoi(f[2]), f[3] == "r", std::stoi(f[4]), std::stoi(f[5]));
+            } else if (f[0] == "update" && f.size() == 4) {
+                applyUpdateDisc(std::stoi(f[1]), f[2], std::stof(f[3]));
+            } else if (f[0] == "delete" && f.size() == 2) {
+                applyDeleteDisc(std::stoi(f[1]));
+            } else {
+                std::cerr << "Пропущена неизвестная запись журнала: " << f[0] << std::endl;
+                continue;
+            }
+            applied++;
+        } catch (const std::exception&) {
+            std::cerr << "Пропущена поврежденная запись журнала" << std::endl;
+        }
+    }
+    
+    // Оборванная последняя запись (сбой во время записи) отбрасывается
+    if (start < data.size()) {
+        std::error_code error;
+        std::filesystem::resize_file(path, start, error);
+    }
+    
+    return applied;
+}
+
+int MemoryStorage::applyAddDisc(int compactId, const std::string& productionDate,
+                                const std::string& company, float price) {
+    discs[compactId] = Disc{productionDate, company, price};
+    Ledger& ledger = ledgers[compactId];
+    ledger.receivedPrefix.assign(1, 0);
+    ledger.soldPrefix.assign(1, 0);
+    nextDiscId = std::max(nextDiscId, compactId + 1);
+    return compactId;
+}
+
+int MemoryStorage::applyAddWork(int workId, const std::string& title, const std::string& author,
+                                const std::string& performer, int compactId) {
+    works[workId] = Work{title, author, performer, compactId};
+    ledgers[compactId].workIds.push_back(workId);
+    nextWorkId = std::max(nextWorkId, workId + 1);
+    return workId;
+}
+
+bool MemoryStorage::applyUpdateDisc(int compactId, const std::string& company, float price) {
+    auto it = discs.find(compactId);
+    if (it == discs.end()) {
+        return false;
+    }
+    it->second.company = company;
+    it->second.price = price;
+    return true;
+}
+
+bool MemoryStorage::applyDeleteDisc(int compactId) {
+    auto ledger = ledgers.find(compactId);
+    if (ledger == ledgers.end() || !ledger->second.dates.empty()) {
+        return false;
+    }
+    for (int workId : ledger->second.workIds) {
+        works.erase(workId);
+    }
+    ledgers.erase(ledger);
+    discs.erase(compactId);
+    return true;
+}
+
+int MemoryStorage::applyOperation(int operationId, int date, bool receipt, int compactId, int quantity) {
+    Ledger& ledger = ledgers[compactId];
+    
+    // Операции обычно приходят по порядку дат, тогда вставка - это дозапись в конец
+    size_t pos = static_cast<size_t>(std::upper_bound(ledger.dates.begin(), ledger.dates.end(), date) -
+                                     ledger.dates.begin());
+    long long received = receipt ? quantity : 0;
+    long long sold = receipt ? 0 : quantity;
+    
+    ledger.dates.insert(ledger.dates.begin() + static_cast<std::ptrdiff_t>(pos), date);
+    ledger.receivedPrefix.insert(ledger.receivedPrefix.begin() + static_cast<std::ptrdiff_t>(pos) + 1,
+                                 ledger.receivedPrefix[pos] + received);
+    ledger.soldPrefix.insert(ledger.soldPrefix.begin() + static_cast<std::ptrdiff_t>(pos) + 1,
+                             ledger.soldPrefix[pos] + sold);
+    for (size_t i = pos + 2; i < ledger.receivedPrefix.size(); i++) {
+        ledger.receivedPrefix[i] += received;
+        ledger.soldPrefix[i] += sold;
+    }
+    
+    nextOperationId = std::max(nextOperationId, operationId + 1);
+    return operationId;
+}
+
+// Добавление компакт-диска
+int MemoryStorage::addCompactDisc(const std::string& productionDate, const std::string& company, float price) {
+    if (parseDate(productionDate) < 0 || price <= 0) {
+        return -1;
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    int compactId = applyAddDisc(nextDiscId, productionDate, company, price);
+    writeJournal({"disc", std::to_string(compactId), productionDate, company, formatPrice(price)});
+    return compactId;
+}
+
+// Добавление произведения
+int MemoryStorage::addMusicalWork(const std::string& title, const std::string& author,
+                                  const std::string& performer, int compactId) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (!discs.count(compactId)) {
+        return -1;
+    }
+    
+    int workId = applyAddWork(nextWorkId, title, author, performer, compactId);
+    writeJournal({"work", std::to_string(workId), std::to_string(compactId), title, author, performer});
+    return workId;
+}
+
+// Обновление компакт-диска
+bool MemoryStorage::updateCompactDisc(int compactId, const std::string& company, float price) {
+    if (price <= 0) {
+        return false;
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (!applyUpdateDisc(compactId, company, price)) {
+        return false;
+    }
+    writeJournal({"update", std::to_string(compactId), company, formatPrice(price)});
+    return true;
+}
+
+// Удаление компакт-диска
+bool MemoryStorage::deleteCompactDisc(int compactId) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (!applyDeleteDisc(compactId)) {
+        return false;
+    }
+    writeJournal({"delete", std::to_string(compactId)});
+    return true;
+}
+
+// Регистрация операции
+int MemoryStorage::registerOperation(const std::string& operationType, int compactId, int quantity,
+                                     const std::string& operationDate) {
+    bool receipt = operationType == "поступление";
+    if ((!receipt && operationType != "продажа") || quantity <= 0) {
+        return -1;
+    }
+    
+    int date = parseDate(operationDate.empty() ? today() : operationDate);
+    if (date < 0) {
+        return -1;
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto ledger = ledgers.find(compactId);
+    if (ledger == ledgers.end() || !discs.count(compactId)) {
+        return -1;
+    }
+    
+    if (!receipt && ledger->second.receivedPrefix.back() - ledger->second.soldPrefix.back() < quantity) {
+        std::cerr << "Невозможно продать больше компактов, чем имеется в наличии" << std::endl;
+        return -1;
+    }
+    
+    int operationId = applyOperation(nextOperationId, date, receipt, compactId, quantity);
+    writeJournal({"op", std::to_string(operationId), std::to_string(date), receipt ? "r" : "s",
+                  std::to_string(compactId), std::to_string(quantity)});
+    return operationId;
+}
+
+// Текущий остаток
+long long MemoryStorage::getStockLevel(int compactId) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto ledger = ledgers.find(compactId);
+    if (ledger == ledgers.end()) {
+        return -1;
+    }
+    return ledger->second.receivedPrefix.back() - ledger->second.soldPrefix.back();
+}
+
+// Поступления и продажи за период
+PeriodTotals MemoryStorage::getPeriodTotals(int compactId, const std::string& startDate,
+                                            const std::string& endDate) {
+    PeriodTotals result{0, 0};
+    int start = parseDate(startDate);
+    int end = parseDate(endDate);
+    if (start < 0 || end < 0) {
+        return result;
+    }
+    
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = ledgers.find(compactId);
+    if (it == ledgers.end()) {
+        return result;
+    }
+    
+    const Ledger& ledger = it->second;
+    size_t first = static_cast<size_t>(std::lower_bound(ledger.dates.begin(), ledger.dates.end(), start) -
+                                       ledger.dates.begin());
+    size_t last = static_cast<size_t>(std::upper_bound(ledger.dates.begin(), ledger.dates.end(), end) -
+                                      ledger.dates.begin());
+    if (first < last) {
+        result.received = ledger.receivedPrefix[last] - ledger.receivedPrefix[first];
+        result.sold = ledger.soldPrefix[last] - ledger.soldPrefix[first];
+    }
+    return result;
+}
+
+// Продажи по исполнителям
+std::vector<PerformerSales> MemoryStorage::getPerformerSales() {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::map<std::string, long long> totals;
+    
+    // Как и в SQL-отчете, продажи диска засчитываются каждому произведению на нем,
+    // а строки упорядочены по имени (std::map дает тот же порядок, что GROUP BY)
+    for (const auto& entry : works) {
+        const Ledger& ledger = ledgers.at(entry.second.compactId);
+        long long sold = ledger.soldPrefix.back();
+        if (sold > 0) {
+            totals[entry.second.performer] += sold;
+        }
+    }
+    
+    std::vector<PerformerSales> result;
+    for (const auto& entry : totals) {
+        result.push_back({entry.first, entry.second});
+    }
+    return result;
+}
+
+// Продажи по авторам
+std::vector<AuthorSales> MemoryStorage::getAuthorSales() {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::map<std::string, AuthorSales> totals;
+    
+    for (const auto& entry : works) {
+        const Ledger& ledger = ledgers.at(entry.second.compactId);
+        long long sold = ledger.soldPrefix.back();
+        if (sold == 0) {
+            continue;
+        }
+        
+        AuthorSales& row = totals.emplace(entry.second.author,
+                                          AuthorSales{entry.second.author, 0, 0, 0.0}).first->second;
+        row.totalSold += sold;
+        row.worksCount++;
+        row.totalRevenue += sold * static_cast<double>(discs.at(entry.second.compactId).price);
+    }
+    
+    std::vector<AuthorSales> result;
+    for (const auto& entry : totals) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+// Сводная стоимость запасов
+InventoryValue MemoryStorage::getInventoryValue() {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    InventoryValue result{static_cast<long long>(discs.size()), 0, 0, 0, 0.0};
+    
+    for (const auto& entry : discs) {
+        const Ledger& ledger = ledgers.at(entry.first);
+        long long received = ledger.receivedPrefix.back();
+        long long sold = ledger.soldPrefix.back();
+        result.totalReceived += received;
+        result.totalSold += sold;
+        result.remaining += received - sold;
+        result.stockValue += (received - sold) * static_cast<double>(entry.second.price);
+    }
+    return result;
+}
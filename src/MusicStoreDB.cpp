@@ -1,14 +1,503 @@
 #include "../include/MusicStoreDB.h"
+#include "../include/PasswordHash.h"
 #include <iostream>
-#include <iomanip>
 #include <ctime>
+#include <cstring>
 #include <stdexcept>
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <cstdio>
+#include <future>
+#include <random>
+#include <thread>
 
+#ifdef MUSIC_STORE_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
-bool MusicStoreDB::headers = true;
+
+
+namespace {
+
+// Цена float как double с той же десятичной записью: 19.99f сохраняется как 19.99,
+// а не 19.989999771118164, который отчеты вывели бы всеми знаками
+double decimalPrice(float price) {
+    char buffer[32];
+    auto written = std::to_chars(buffer, buffer + sizeof(buffer), price);
+    double value = price;
+    std::from_chars(buffer, written.ptr, value);
+    return value;
+}
+
+const char TOKEN_SEPARATOR = '\x1f';
+const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// Токен продолжения: base64url от вида страницы и значений ключа последней строки
+std::string encodePageToken(const std::vector<std::string>& parts) {
+    std::string raw;
+    for (size_t i = 0; i < parts.size(); i++) {
+        if (i > 0) {
+            raw += TOKEN_SEPARATOR;
+        }
+        raw += parts[i];
+    }
+    
+    std::string token;
+    int value = 0;
+    int bits = 0;
+    for (unsigned char c : raw) {
+        value = (value << 8) | c;
+        bits += 8;
+        while (bits >= 6) {
+            bits -= 6;
+            token += BASE64_ALPHABET[(value >> bits) & 0x3F];
+        }
+    }
+    if (bits > 0) {
+        token += BASE64_ALPHABET[(value << (6 - bits)) & 0x3F];
+    }
+    
+    return token;
+}
+
+// Разбор токена продолжения; пустой результат - токен поврежден
+std::vector<std::string> decodePageToken(const std::string& token) {
+    std::string raw;
+    int value = 0;
+    int bits = 0;
+    for (char c : token) {
+        const char* pos = std::strchr(BASE64_ALPHABET, c);
+        if (c == '\0' || pos == nullptr) {
+            return {};
+        }
+        value = ((value << 6) | static_cast<int>(pos - BASE64_ALPHABET)) & 0xFFFFFF;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            raw += static_cast<char>((value >> bits) & 0xFF);
+        }
+    }
+    
+    std::vector<std::string> parts(1);
+    for (char c : raw) {
+        if (c == TOKEN_SEPARATOR) {
+            parts.emplace_back();
+        } else {
+            parts.back() += c;
+        }
+    }
+    
+    return parts;
+}
+
+// URI файла базы данных с параметрами (символы, значимые в URI, кодируются)
+std::string fileUri(const std::string& path, const std::string& query) {
+    std::string uri = "file:";
+    for (unsigned char c : path) {
+        if (c == '%' || c == '?' || c == '#' || c < 0x20) {
+            char escaped[4];
+            std::snprintf(escaped, sizeof(escaped), "%%%02X", c);
+            uri += escaped;
+        } else {
+            uri += static_cast<char>(c);
+        }
+    }
+    return uri + "?" + query;
+}
+
+// Количество шагов виртуальной машины между вызовами обработчика хода выполнения
+const int PROGRESS_INTERVAL = 10000;
+
+// Триггер индексации новых произведений (при массовом импорте временно снимается)
+const char FTS_INSERT_TRIGGER[] =
+    "CREATE TRIGGER IF NOT EXISTS musical_works_fts_insert AFTER INSERT ON musical_works "
+    "BEGIN "
+    "    INSERT INTO musical_works_fts(rowid, title, author, performer) "
+    "    VALUES (NEW.work_id, NEW.title, NEW.author, NEW.performer); "
+    "END;";
+
+// Запросы горячих путей (количество параметров проверяется при компиляции, см. Query.h)
+constexpr char INSERT_OPERATION_SQL[] =
+    "INSERT INTO operations (operation_date, operation_type, compact_id, quantity) "
+    "VALUES (?, ?, ?, ?);";
+
+constexpr char STOCK_LEVEL_SQL[] =
+    "SELECT remaining FROM stock_levels WHERE compact_id = ?;";
+
+constexpr char CATALOG_DISCS_SQL[] =
+    "SELECT compact_id, production_date, company, price FROM compact_discs;";
+constexpr char CATALOG_WORKS_SQL[] =
+    "SELECT compact_id, work_id, title, author, performer FROM musical_works ORDER BY work_id;";
+
+constexpr char CATALOG_DISC_SQL[] =
+    "SELECT production_date, company, price FROM compact_discs WHERE compact_id = ?;";
+constexpr char CATALOG_DISC_WORKS_SQL[] =
+    "SELECT work_id, title, author, performer FROM musical_works WHERE compact_id = ? ORDER BY work_id;";
+constexpr char DATA_VERSION_SQL[] = "PRAGMA data_version;";
+constexpr char CATALOG_VERSION_SQL[] = "SELECT version FROM catalog_version WHERE id = 1;";
+constexpr char JOURNAL_MODE_SQL[] = "PRAGMA journal_mode;";
+
+constexpr char MOST_POPULAR_COMPACT_SQL[] =
+    "SELECT compact_id, SUM(quantity) AS total_sold "
+    "FROM operations "
+    "WHERE operation_type = 'продажа' "
+    "GROUP BY compact_id "
+    "ORDER BY total_sold DESC "
+    "LIMIT 1;";
+
+constexpr char COMPACT_PERIOD_SALES_SQL[] =
+    "SELECT COUNT(*), COALESCE(SUM(quantity), 0) "
+    "FROM operations "
+    "WHERE operation_type = 'продажа' AND compact_id = ? AND operation_date BETWEEN ? AND ?;";
+
+constexpr char SELECTED_DISCS_CREATE_SQL[] =
+    "CREATE TEMP TABLE IF NOT EXISTS selected_discs (compact_id INTEGER PRIMARY KEY);";
+constexpr char SELECTED_DISCS_CLEAR_SQL[] = "DELETE FROM temp.selected_discs;";
+constexpr char SELECTED_DISC_INSERT_SQL[] = "INSERT OR IGNORE INTO temp.selected_discs (compact_id) VALUES (?);";
+constexpr char SELECTED_DISCS_SALES_SQL[] =
+    "SELECT s.compact_id, COALESCE(SUM(op.quantity), 0) "
+    "FROM temp.selected_discs s "
+    "LEFT JOIN operations op ON op.compact_id = s.compact_id "
+    "    AND op.operation_type = 'продажа' AND op.operation_date BETWEEN ? AND ? "
+    "GROUP BY s.compact_id "
+    "ORDER BY s.compact_id;";
+
+constexpr char BULK_COUNT_SQL[] =
+    "SELECT COUNT(*) FROM compact_discs "
+    "WHERE (?1 = 0 OR compact_id IN (SELECT compact_id FROM temp.selected_discs)) "
+    "    AND (?2 = '' OR company = ?2);";
+constexpr char BULK_COUNT_UNSOLD_SQL[] =
+    "SELECT COUNT(*) FROM compact_discs "
+    "WHERE (?1 = 0 OR compact_id IN (SELECT compact_id FROM temp.selected_discs)) "
+    "    AND (?2 = '' OR company = ?2) "
+    "    AND NOT EXISTS (SELECT 1 FROM operations op WHERE op.compact_id = compact_discs.compact_id);";
+constexpr char BULK_REPRICE_SQL[] =
+    "UPDATE compact_discs SET price = MAX(0.01, ROUND(price * (100.0 + ?3) / 100.0, 2)) "
+    "WHERE (?1 = 0 OR compact_id IN (SELECT compact_id FROM temp.selected_discs)) "
+    "    AND (?2 = '' OR company = ?2);";
+constexpr char BULK_REASSIGN_SQL[] =
+    "UPDATE compact_discs SET company = ?3 "
+    "WHERE (?1 = 0 OR compact_id IN (SELECT compact_id FROM temp.selected_discs)) "
+    "    AND (?2 = '' OR company = ?2);";
+constexpr char BULK_DELETE_UNSOLD_SQL[] =
+    "DELETE FROM compact_discs "
+    "WHERE (?1 = 0 OR compact_id IN (SELECT compact_id FROM temp.selected_discs)) "
+    "    AND (?2 = '' OR company = ?2) "
+    "    AND NOT EXISTS (SELECT 1 FROM operations op WHERE op.compact_id = compact_discs.compact_id);";
+
+constexpr char STOCK_LEVELS_SQL[] =
+    "SELECT compact_id, remaining FROM stock_levels;";
+
+constexpr char PERIOD_TOTALS_SQL[] =
+    "SELECT "
+    "    COALESCE(SUM(CASE WHEN operation_type = 'поступление' THEN quantity END), 0), "
+    "    COALESCE(SUM(CASE WHEN operation_type = 'продажа' THEN quantity END), 0) "
+    "FROM "
+    "    operations "
+    "WHERE "
+    "    compact_id = ?1 AND operation_date BETWEEN ?2 AND ?3;";
+
+constexpr char CLEAR_PERIOD_STATISTICS_SQL[] =
+    "DELETE FROM report_results WHERE start_date = ?1 AND end_date = ?2;";
+
+constexpr char STORE_PERIOD_STATISTICS_SQL[] =
+    "INSERT INTO report_results (start_date, end_date, compact_id, received_quantity, sold_quantity) "
+    "SELECT "
+    "    ?1, "
+    "    ?2, "
+    "    cd.compact_id, "
+    "    COALESCE((SELECT SUM(quantity) FROM operations "
+    "              WHERE compact_id = cd.compact_id "
+    "              AND operation_type = 'поступление' "
+    "              AND operation_date BETWEEN ?1 AND ?2), 0) AS received_quantity, "
+    "    COALESCE((SELECT SUM(quantity) FROM operations "
+    "              WHERE compact_id = cd.compact_id "
+    "              AND operation_type = 'продажа' "
+    "              AND operation_date BETWEEN ?1 AND ?2), 0) AS sold_quantity "
+    "FROM "
+    "    compact_discs cd;";
+
+constexpr char PERIOD_STATISTICS_SQL[] =
+    "SELECT "
+    "    cd.compact_id, "
+    "    cd.company, "
+    "    rr.received_quantity, "
+    "    rr.sold_quantity, "
+    "    rr.received_quantity - rr.sold_quantity AS remaining "
+    "FROM "
+    "    report_results rr "
+    "JOIN "
+    "    compact_discs cd ON rr.compact_id = cd.compact_id "
+    "WHERE "
+    "    rr.start_date = ?1 AND rr.end_date = ?2 "
+    "ORDER BY "
+    "    cd.compact_id;";
+
+// Без права записи статистика считается напрямую, без сохранения в report_results
+constexpr char PERIOD_STATISTICS_DIRECT_SQL[] =
+    "SELECT "
+    "    cd.compact_id, "
+    "    cd.company, "
+    "    COALESCE(SUM(CASE WHEN op.operation_type = 'поступление' THEN op.quantity END), 0) AS received_quantity, "
+    "    COALESCE(SUM(CASE WHEN op.operation_type = 'продажа' THEN op.quantity END), 0) AS sold_quantity, "
+    "    COALESCE(SUM(CASE WHEN op.operation_type = 'поступление' THEN op.quantity "
+    "                      ELSE -op.quantity END), 0) AS remaining "
+    "FROM "
+    "    compact_discs cd "
+    "LEFT JOIN "
+    "    operations op ON op.compact_id = cd.compact_id AND op.operation_date BETWEEN ?1 AND ?2 "
+    "GROUP BY "
+    "    cd.compact_id "
+    "ORDER BY "
+    "    cd.compact_id;";
+
+// Строка отчета за период: ID, компания, поступило, продано, остаток
+using PeriodStatisticsRow = std::tuple<int, std::string_view, long long, long long, long long>;
+
+constexpr char REPORT_PERIODS_CREATE_SQL[] =
+    "CREATE TEMP TABLE IF NOT EXISTS report_periods ("
+    "    period_index INTEGER PRIMARY KEY, "
+    "    start_date TEXT NOT NULL, "
+    "    end_date TEXT NOT NULL);";
+constexpr char REPORT_PERIODS_CLEAR_SQL[] = "DELETE FROM temp.report_periods;";
+constexpr char REPORT_PERIOD_INSERT_SQL[] =
+    "INSERT INTO temp.report_periods (period_index, start_date, end_date) VALUES (?, ?, ?);";
+
+// CROSS JOIN закрепляет порядок соединения: операции читаются один раз, для каждой перебираются периоды
+constexpr char PERIOD_COMPARISON_SQL[] =
+    "SELECT "
+    "    cd.compact_id, "
+    "    cd.company, "
+    "    cd.price, "
+    "    t.period_index, "
+    "    COALESCE(t.received, 0), "
+    "    COALESCE(t.sold, 0) "
+    "FROM "
+    "    compact_discs cd "
+    "LEFT JOIN ("
+    "    SELECT "
+    "        op.compact_id, "
+    "        p.period_index, "
+    "        SUM(CASE WHEN op.operation_type = 'поступление' THEN op.quantity ELSE 0 END) AS received, "
+    "        SUM(CASE WHEN op.operation_type = 'продажа' THEN op.quantity ELSE 0 END) AS sold "
+    "    FROM "
+    "        operations op "
+    "    CROSS JOIN "
+    "        temp.report_periods p "
+    "    WHERE "
+    "        op.operation_date BETWEEN (SELECT MIN(start_date) FROM temp.report_periods) "
+    "                              AND (SELECT MAX(end_date) FROM temp.report_periods) "
+    "        AND op.operation_date BETWEEN p.start_date AND p.end_date "
+    "    GROUP BY "
+    "        op.compact_id, p.period_index"
+    ") t ON t.compact_id = cd.compact_id "
+    "ORDER BY "
+    "    cd.compact_id, t.period_index;";
+
+// Строка сравнения: ID, компания, цена, номер периода (NULL - операций нет), поступило, продано
+using PeriodComparisonSqlRow =
+    std::tuple<int, std::string_view, double, std::optional<int>, long long, long long>;
+
+// Дневная сводка продаж для баз, открытых только для чтения без daily_sales
+constexpr char DAILY_SALES_VIEW_SQL[] =
+    "CREATE TEMP VIEW IF NOT EXISTS daily_sales AS "
+    "SELECT operation_date AS sale_date, compact_id, SUM(quantity) AS sold "
+    "FROM operations "
+    "WHERE operation_type = 'продажа' "
+    "GROUP BY compact_id, operation_date;";
+
+// Номер интервала (bucket_number) идет подряд для соседних интервалов: по нему строится окно RANGE
+constexpr char SALES_SERIES_SQL[] =
+    "WITH series_keys AS ("
+    "    SELECT compact_id, CAST(compact_id AS TEXT) AS series_key FROM compact_discs WHERE ?4 = 'disc' "
+    "    UNION ALL "
+    "    SELECT DISTINCT compact_id, performer FROM musical_works WHERE ?4 = 'performer' "
+    "    UNION ALL "
+    "    SELECT DISTINCT compact_id, author FROM musical_works WHERE ?4 = 'author'"
+    "), "
+    "buckets AS ("
+    "    SELECT "
+    "        k.series_key, "
+    "        CASE ?1 "
+    "            WHEN 'day' THEN ds.sale_date "
+    "            WHEN 'week' THEN date(ds.sale_date, '-6 days', 'weekday 1') "
+    "            ELSE strftime('%Y-%m-01', ds.sale_date) "
+    "        END AS bucket, "
+    "        SUM(ds.sold) AS sold, "
+    "        SUM(ds.sold * cd.price) AS revenue "
+    "    FROM "
+    "        daily_sales ds "
+    "    JOIN "
+    "        series_keys k ON k.compact_id = ds.compact_id "
+    "    JOIN "
+    "        compact_discs cd ON cd.compact_id = ds.compact_id "
+    "    WHERE "
+    "        ds.sale_date BETWEEN ?2 AND ?3 "
+    "    GROUP BY "
+    "        k.series_key, bucket"
+    "), "
+    "numbered AS ("
+    "    SELECT "
+    "        *, "
+    "        CASE ?1 "
+    "            WHEN 'month' THEN CAST(strftime('%Y', bucket) AS INTEGER) * 12 + CAST(strftime('%m', bucket) AS INTEGER) "
+    "            WHEN 'week' THEN CAST(julianday(bucket) AS INTEGER) / 7 "
+    "            ELSE CAST(julianday(bucket) AS INTEGER) "
+    "        END AS bucket_number "
+    "    FROM "
+    "        buckets"
+    ") "
+    "SELECT "
+    "    series_key, "
+    "    bucket, "
+    "    sold, "
+    "    revenue, "
+    "    SUM(sold) OVER recent * 1.0 / MIN(?5, bucket_number - MIN(bucket_number) OVER series + 1), "
+    "    SUM(revenue) OVER recent / MIN(?5, bucket_number - MIN(bucket_number) OVER series + 1), "
+    "    SUM(sold) OVER running, "
+    "    SUM(revenue) OVER running "
+    "FROM "
+    "    numbered "
+    "WINDOW "
+    "    series AS (PARTITION BY series_key), "
+    "    recent AS (PARTITION BY series_key ORDER BY bucket_number RANGE BETWEEN ?5 - 1 PRECEDING AND CURRENT ROW), "
+    "    running AS (PARTITION BY series_key ORDER BY bucket_number ROWS UNBOUNDED PRECEDING) "
+    "ORDER BY "
+    "    CASE WHEN ?4 = 'disc' THEN CAST(series_key AS INTEGER) END, series_key, bucket_number;";
+
+// Точка ряда: ключ, интервал, продано, выручка, средние продаж и выручки, накопленные продажи и выручка
+using SalesSeriesRow = std::tuple<std::string, std::string, long long, double, double, double, long long, double>;
+
+// Изменение показателей относительно предыдущего периода
+PeriodChange periodChange(const PeriodMetrics& previous, const PeriodMetrics& current) {
+    PeriodChange change{current.sold - previous.sold, current.revenue - previous.revenue, std::nullopt, std::nullopt};
+    if (previous.sold != 0) {
+        change.soldGrowth = static_cast<double>(change.soldDelta) / previous.sold;
+    }
+    if (previous.revenue != 0.0) {
+        change.revenueGrowth = change.revenueDelta / previous.revenue;
+    }
+    return change;
+}
+
+// Изменения по всем соседним периодам
+std::vector<PeriodChange> periodChanges(const std::vector<PeriodMetrics>& metrics) {
+    std::vector<PeriodChange> changes;
+    for (size_t i = 1; i < metrics.size(); i++) {
+        changes.push_back(periodChange(metrics[i - 1], metrics[i]));
+    }
+    return changes;
+}
+
+constexpr char PERFORMER_SALES_SQL[] =
+    "SELECT "
+    "    mw.performer, "
+    "    SUM(op.quantity) AS total_sold "
+    "FROM "
+    "    operations op "
+    "JOIN "
+    "    musical_works mw ON op.compact_id = mw.compact_id "
+    "WHERE "
+    "    op.operation_type = 'продажа' "
+    "GROUP BY "
+    "    mw.performer;";
+
+constexpr char AUTHOR_SALES_SQL[] =
+    "SELECT "
+    "    mw.author, "
+    "    SUM(op.quantity) AS total_sold, "
+    "    COUNT(DISTINCT mw.work_id) AS works_count, "
+    "    SUM(op.quantity * cd.price) AS total_revenue "
+    "FROM "
+    "    operations op "
+    "JOIN "
+    "    musical_works mw ON op.compact_id = mw.compact_id "
+    "JOIN "
+    "    compact_discs cd ON op.compact_id = cd.compact_id "
+    "WHERE "
+    "    op.operation_type = 'продажа' "
+    "GROUP BY "
+    "    mw.author;";
+
+constexpr char INVENTORY_VALUE_SQL[] =
+    "SELECT "
+    "    COUNT(*), "
+    "    COALESCE(SUM(received), 0), "
+    "    COALESCE(SUM(sold), 0), "
+    "    COALESCE(SUM(received - sold), 0), "
+    "    COALESCE(SUM((received - sold) * price), 0) "
+    "FROM ( "
+    "    SELECT "
+    "        cd.price AS price, "
+    "        COALESCE((SELECT SUM(quantity) FROM operations "
+    "                  WHERE compact_id = cd.compact_id "
+    "                  AND operation_type = 'поступление'), 0) AS received, "
+    "        COALESCE((SELECT SUM(quantity) FROM operations "
+    "                  WHERE compact_id = cd.compact_id "
+    "                  AND operation_type = 'продажа'), 0) AS sold "
+    "    FROM "
+    "        compact_discs cd "
+    ");";
+
+constexpr char AUTHENTICATE_SQL[] = "SELECT user_id, role, password_hash FROM users WHERE username = ?;";
+constexpr char UPDATE_PASSWORD_HASH_SQL[] = "UPDATE users SET password_hash = ? WHERE user_id = ?;";
+
+constexpr char SNAPSHOT_DISCS_SQL[] = "SELECT compact_id, price FROM compact_discs;";
+constexpr char SNAPSHOT_WORKS_SQL[] = "SELECT work_id, compact_id, author, performer FROM musical_works;";
+constexpr char SNAPSHOT_OPERATIONS_SQL[] =
+    "SELECT compact_id, CAST(REPLACE(operation_date, '-', '') AS INTEGER), "
+    "operation_type = 'продажа', quantity FROM operations;";
+
+#ifdef MUSIC_STORE_HAVE_ZLIB
+// Сжатие файла gzip
+bool gzipFile(const std::string& sourcePath, const std::string& targetPath) {
+    std::FILE* source = std::fopen(sourcePath.c_str(), "rb");
+    if (!source) {
+        return false;
+    }
+    
+    gzFile target = gzopen(targetPath.c_str(), "wb6");
+    if (!target) {
+        std::fclose(source);
+        return false;
+    }
+    
+    std::vector<char> buffer(1 << 20);
+    bool ok = true;
+    size_t read;
+    while ((read = std::fread(buffer.data(), 1, buffer.size(), source)) > 0) {
+        if (gzwrite(target, buffer.data(), static_cast<unsigned>(read)) != static_cast<int>(read)) {
+            ok = false;
+            break;
+        }
+    }
+    
+    ok = !std::ferror(source) && ok;
+    std::fclose(source);
+    return gzclose(target) == Z_OK && ok;
+}
+#endif
+
+} // namespace
 // Конструктор
-MusicStoreDB::MusicStoreDB(const std::string& dbPath) : dbPath(dbPath), isAdmin(false), userId(-1) {
-    int rc = sqlite3_open(dbPath.c_str(), &db);
+MusicStoreDB::MusicStoreDB(const std::string& dbPath, OpenMode mode)
+    : dbPath(dbPath), openMode(mode), isAdmin(false), userId(-1), outputFormat(TableWriter::Format::Text),
+      changeFeedWal(false), queryTimeout(0), progressSteps(0), cancelRequested(false), timedOut(false),
+      lockWaits(0), busyCalls(0), lockWaitMicros(0), lockTimeouts(0), writeRetries(0),
+      catalog(std::make_shared<CatalogCache>()), catalogDataVersion(-1), catalogVersion(-1), catalogDirty(false),
+      catalogChecked(false) {
+    int rc;
+    if (mode == OpenMode::ReadWrite) {
+        rc = sqlite3_open(dbPath.c_str(), &db);
+    } else if (mode == OpenMode::ReadOnly) {
+        rc = sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+    } else {
+        // Неизменяемый файл: SQLite не берет блокировки и не проверяет журнал
+        rc = sqlite3_open_v2(fileUri(dbPath, "immutable=1").c_str(), &db,
+                             SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, nullptr);
+    }
     
     if (rc != SQLITE_OK) {
         std::cerr << "Не удалось открыть базу данных: " << sqlite3_errmsg(db) << std::endl;
@@ -16,14 +505,424 @@ MusicStoreDB::MusicStoreDB(const std::string& dbPath) : dbPath(dbPath), isAdmin(
         exit(1);
     }
     
-    initializeDB();
+    statements.reset(db);
+    
+    // Неизменяемый файл не блокируется, остальным режимам нужно ожидание блокировок
+    if (mode != OpenMode::Immutable) {
+        sqlite3_busy_handler(db, busyHandler, this);
+    }
+    
+    // Схема копии для отчетов не изменяется
+    if (mode == OpenMode::ReadWrite) {
+        // WAL: читатели из других процессов не блокируют запись и не ждут ее
+        executeQuery("PRAGMA journal_mode = WAL;");
+        initializeDB();
+    }
+}
+
+// Проверка, что база данных открыта для записи
+bool MusicStoreDB::ensureWritable() {
+    if (openMode != OpenMode::ReadWrite) {
+        std::cerr << "База данных открыта только для чтения" << std::endl;
+        return false;
+    }
+    return true;
 }
 
 // Деструктор
 MusicStoreDB::~MusicStoreDB() {
+    // Подготовленные запросы должны быть финализированы до закрытия соединения
+    statements.clear();
     sqlite3_close(db);
 }
 
+// Начало транзакции
+bool MusicStoreDB::beginTransaction() {
+    // Только для чтения блокировка записи не нужна и недоступна
+    return openMode == OpenMode::ReadWrite ? executeWrite("BEGIN IMMEDIATE;") : executeQuery("BEGIN;");
+}
+
+// Фиксация транзакции
+bool MusicStoreDB::commitTransaction() {
+    bool committed = executeWrite("COMMIT;");
+    
+    // Отложенные изменения каталога: кеш перечитывается уже со сфиксированными данными
+    if (committed && catalogDirty) {
+        catalogDirty = false;
+        catalog->invalidate();
+    }
+    return committed;
+}
+
+// Откат транзакции
+bool MusicStoreDB::rollbackTransaction() {
+    // Кеш мог получить изменения отмененной транзакции
+    catalogDirty = false;
+    catalog->invalidate();
+    return executeQuery("ROLLBACK;");
+}
+
+// Включение журнала изменений
+bool MusicStoreDB::enableChangeFeed(const std::string& logPath) {
+    if (!ensureWritable()) {
+        return false;
+    }
+    
+    auto log = std::make_unique<ChangeLog>(logPath);
+    if (!log->isOpen()) {
+        return false;
+    }
+    
+    changeLog = std::move(log);
+    pendingChanges.clear();
+    committingChanges.clear();
+    
+    // В WAL успешная фиксация видна по walHook; без WAL остается только commit hook
+    auto journalMode = Query<JOURNAL_MODE_SQL, std::tuple<std::string>>(statements).bind().fetchOne();
+    changeFeedWal = journalMode && std::get<0>(*journalMode) == "wal";
+    
+    sqlite3_update_hook(db, updateHook, this);
+    sqlite3_commit_hook(db, commitHook, this);
+    sqlite3_rollback_hook(db, rollbackHook, this);
+    if (changeFeedWal) {
+        sqlite3_wal_hook(db, walHook, this);
+    }
+    return true;
+}
+
+// Ограничение времени выполнения запроса
+void MusicStoreDB::setQueryTimeout(std::chrono::milliseconds timeout) {
+    queryTimeout = timeout;
+    updateProgressHandler();
+}
+
+// Уведомление о ходе выполнения запросов
+void MusicStoreDB::setProgressCallback(std::function<void(long long)> callback) {
+    progressCallback = std::move(callback);
+    updateProgressHandler();
+}
+
+// Установка или снятие обработчиков хода выполнения
+void MusicStoreDB::updateProgressHandler() {
+    // Без ограничения времени и уведомлений обработчики не нужны,
+    // отмена через sqlite3_interrupt работает и без них
+    if (queryTimeout.count() > 0 || progressCallback) {
+        sqlite3_progress_handler(db, PROGRESS_INTERVAL, progressHandler, this);
+        sqlite3_trace_v2(db, SQLITE_TRACE_STMT, traceHandler, this);
+    } else {
+        sqlite3_progress_handler(db, 0, nullptr, nullptr);
+        sqlite3_trace_v2(db, 0, nullptr, nullptr);
+    }
+}
+
+// Отметка начала запроса
+int MusicStoreDB::traceHandler(unsigned type, void* self, void* stmt, void* sql) {
+    (void)stmt;
+    const char* text = static_cast<const char*>(sql);
+    
+    // Подпрограммы триггеров ("-- TRIGGER ...") относятся к уже выполняющемуся запросу
+    if (type != SQLITE_TRACE_STMT || (text && std::strncmp(text, "--", 2) == 0)) {
+        return 0;
+    }
+    
+    auto* store = static_cast<MusicStoreDB*>(self);
+    store->queryStart = std::chrono::steady_clock::now();
+    store->progressSteps = 0;
+    return 0;
+}
+
+// Проверка отмены и ограничения времени во время выполнения запроса
+int MusicStoreDB::progressHandler(void* self) {
+    auto* store = static_cast<MusicStoreDB*>(self);
+    store->progressSteps += PROGRESS_INTERVAL;
+    
+    if (store->progressCallback) {
+        store->progressCallback(store->progressSteps);
+    }
+    
+    if (store->cancelRequested) {
+        return 1;
+    }
+    
+    if (store->queryTimeout.count() > 0 &&
+        std::chrono::steady_clock::now() - store->queryStart > store->queryTimeout) {
+        store->timedOut = true;
+        return 1;
+    }
+    
+    return 0;
+}
+
+// Отмена выполняющегося запроса
+void MusicStoreDB::cancelQuery() {
+    cancelRequested = true;
+    sqlite3_interrupt(db);
+}
+
+// Сброс признаков прерывания
+void MusicStoreDB::resetInterrupt() {
+    cancelRequested = false;
+    timedOut = false;
+}
+
+// Причина прерывания запросов
+QueryInterrupt MusicStoreDB::lastInterrupt() const {
+    if (cancelRequested) {
+        return QueryInterrupt::Cancelled;
+    }
+    if (timedOut) {
+        return QueryInterrupt::Timeout;
+    }
+    return QueryInterrupt::None;
+}
+
+// Ожидание занятой блокировки
+int MusicStoreDB::busyHandler(void* self, int count) {
+    auto* store = static_cast<MusicStoreDB*>(self);
+    const BusyPolicy& policy = store->busyPolicy;
+    auto now = std::chrono::steady_clock::now();
+    
+    // count == 0 - первая попытка очередного запроса
+    if (count == 0) {
+        store->busyStart = now;
+        store->lockWaits++;
+    }
+    
+    auto waited = now - store->busyStart;
+    if (waited >= policy.timeout) {
+        store->lockTimeouts++;
+        return 0;
+    }
+    
+    // Экспоненциальный рост паузы со случайным разбросом, не дольше оставшегося времени
+    std::chrono::milliseconds delay = policy.initialDelay * (1 << std::min(count, 20));
+    delay = std::clamp(delay, std::chrono::milliseconds(1), std::max(policy.maxDelay, std::chrono::milliseconds(1)));
+    static thread_local std::minstd_rand random(std::random_device{}());
+    std::uniform_int_distribution<long long> jitter(delay.count() * 500, delay.count() * 1000);
+    auto pause = std::min<std::chrono::steady_clock::duration>(std::chrono::microseconds(jitter(random)),
+                                                                policy.timeout - waited);
+    
+    std::this_thread::sleep_for(pause);
+    store->busyCalls++;
+    store->lockWaitMicros += std::chrono::duration_cast<std::chrono::microseconds>(pause).count();
+    return 1;
+}
+
+// Счетчики ожидания блокировок
+LockStats MusicStoreDB::getLockStats() const {
+    return LockStats{lockWaits.load(), busyCalls.load(), lockWaitMicros.load(), lockTimeouts.load(), writeRetries.load()};
+}
+
+// Обнуление счетчиков ожидания блокировок
+void MusicStoreDB::resetLockStats() {
+    lockWaits = 0;
+    busyCalls = 0;
+    lockWaitMicros = 0;
+    lockTimeouts = 0;
+    writeRetries = 0;
+}
+
+// Горячее резервное копирование
+bool MusicStoreDB::backupTo(const std::string& path, bool compress, int pagesPerStep,
+                            std::chrono::milliseconds pause, std::function<void(int, int)> progress) {
+#ifndef MUSIC_STORE_HAVE_ZLIB
+    if (compress) {
+        std::cerr << "Сжатие недоступно: программа собрана без zlib" << std::endl;
+        return false;
+    }
+#endif
+
+    // Внутри транзакции этого же соединения sqlite3_backup_step отвечает SQLITE_BUSY, пока она не завершится
+    if (!sqlite3_get_autocommit(db)) {
+        std::cerr << "Резервное копирование недоступно внутри открытой транзакции" << std::endl;
+        return false;
+    }
+    
+    std::string tempPath = path + ".part";
+    std::remove(tempPath.c_str());
+    
+    sqlite3* target = nullptr;
+    if (sqlite3_open(tempPath.c_str(), &target) != SQLITE_OK) {
+        std::cerr << "Не удалось создать файл резервной копии: " << sqlite3_errmsg(target) << std::endl;
+        sqlite3_close(target);
+        return false;
+    }
+    
+    // Источник - это же соединение: изменения, сделанные через него во время
+    // копирования, переносятся в копию без перезапуска
+    sqlite3_backup* backup = sqlite3_backup_init(target, "main", db, "main");
+    if (!backup) {
+        std::cerr << "SQL error: " << sqlite3_errmsg(target) << std::endl;
+        sqlite3_close(target);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    
+    int step = std::max(pagesPerStep, 1);
+    int lastRemaining = -1;
+    int rc;
+    
+    // Блокировка, которую держат дольше busyPolicy.timeout, прерывает копирование
+    std::optional<std::chrono::steady_clock::time_point> busySince;
+    
+    do {
+        rc = sqlite3_backup_step(backup, step);
+        
+        if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+            auto now = std::chrono::steady_clock::now();
+            if (!busySince) {
+                busySince = now;
+            } else if (now - *busySince >= busyPolicy.timeout) {
+                break;
+            }
+        } else {
+            busySince.reset();
+        }
+        
+        int remaining = sqlite3_backup_remaining(backup);
+        int total = sqlite3_backup_pagecount(backup);
+        
+        // Рост остатка означает перезапуск из-за записи другим соединением:
+        // увеличиваем порцию, чтобы копирование успевало завершиться
+        if (lastRemaining >= 0 && remaining > lastRemaining) {
+            step *= 2;
+        }
+        lastRemaining = remaining;
+        
+        if (progress) {
+            progress(remaining, total);
+        }
+        
+        if (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+            std::this_thread::sleep_for(pause);
+        }
+    } while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+    
+    sqlite3_backup_finish(backup);
+    
+    if (rc != SQLITE_DONE) {
+        std::cerr << "Ошибка резервного копирования: " << sqlite3_errstr(rc) << std::endl;
+        sqlite3_close(target);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    
+    // Копия получает заголовок WAL источника; реплику в режиме WAL нельзя открыть
+    // только для чтения на разделе, где не создаются файлы -wal и -shm
+    std::vector<std::vector<std::string>> journal;
+    rc = sqlite3_exec(target, "PRAGMA journal_mode = DELETE;", callback, &journal, nullptr);
+    if (rc != SQLITE_OK || journal.size() != 1 || journal[0][0] != "delete") {
+        std::cerr << "Не удалось перевести резервную копию из режима WAL: " << sqlite3_errmsg(target) << std::endl;
+        sqlite3_close(target);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    
+    // Проверка целостности копии
+    std::vector<std::vector<std::string>> check;
+    char* errMsg = nullptr;
+    rc = sqlite3_exec(target, "PRAGMA integrity_check;", callback, &check, &errMsg);
+    sqlite3_close(target);
+    
+    if (rc != SQLITE_OK || check.size() != 1 || check[0][0] != "ok") {
+        std::cerr << "Резервная копия не прошла проверку целостности";
+        if (errMsg) {
+            std::cerr << ": " << errMsg;
+            sqlite3_free(errMsg);
+        } else if (!check.empty()) {
+            std::cerr << ": " << check[0][0];
+        }
+        std::cerr << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    
+    bool ok;
+#ifdef MUSIC_STORE_HAVE_ZLIB
+    if (compress) {
+        ok = gzipFile(tempPath, path);
+        std::remove(tempPath.c_str());
+    } else {
+        ok = std::rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+#else
+    ok = std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+
+    if (!ok) {
+        std::cerr << "Не удалось записать файл резервной копии: " << path << std::endl;
+        std::remove(tempPath.c_str());
+    }
+    return ok;
+}
+
+// Фиксация изменения строки в текущей транзакции
+void MusicStoreDB::updateHook(void* self, int op, const char* dbName, const char* table, sqlite3_int64 rowId) {
+    auto* store = static_cast<MusicStoreDB*>(self);
+    
+    if (std::strcmp(dbName, "main") != 0) {
+        return;
+    }
+    
+    ChangeTable changedTable;
+    if (std::strcmp(table, "operations") == 0) {
+        changedTable = ChangeTable::Operations;
+    } else if (std::strcmp(table, "compact_discs") == 0) {
+        changedTable = ChangeTable::CompactDiscs;
+    } else if (std::strcmp(table, "musical_works") == 0) {
+        changedTable = ChangeTable::MusicalWorks;
+    } else {
+        return;
+    }
+    
+    ChangeOp changeOp = op == SQLITE_INSERT ? ChangeOp::Insert
+                      : op == SQLITE_UPDATE ? ChangeOp::Update
+                      : ChangeOp::Delete;
+    
+    store->pendingChanges.push_back({0, rowId, changeOp, changedTable});
+}
+
+// Подготовка изменений транзакции к переносу в журнал
+int MusicStoreDB::commitHook(void* self) {
+    auto* store = static_cast<MusicStoreDB*>(self);
+    
+    // COMMIT, прерванный SQLITE_BUSY, повторяется с уже отложенными изменениями
+    store->committingChanges.insert(store->committingChanges.end(),
+                                    store->pendingChanges.begin(), store->pendingChanges.end());
+    store->pendingChanges.clear();
+    
+    if (!store->changeFeedWal && !store->committingChanges.empty()) {
+        store->changeLog->append(store->committingChanges);
+        store->committingChanges.clear();
+    }
+    
+    // 0 - разрешить фиксацию
+    return 0;
+}
+
+// Перенос изменений зафиксированной транзакции в журнал
+int MusicStoreDB::walHook(void* self, sqlite3* db, const char* dbName, int pages) {
+    auto* store = static_cast<MusicStoreDB*>(self);
+    
+    if (!store->committingChanges.empty()) {
+        store->changeLog->append(store->committingChanges);
+        store->committingChanges.clear();
+    }
+    
+    // Порог автоматической контрольной точки SQLite по умолчанию
+    if (pages >= 1000) {
+        sqlite3_wal_checkpoint_v2(db, dbName, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+    }
+    return SQLITE_OK;
+}
+
+// Отмена изменений транзакции
+void MusicStoreDB::rollbackHook(void* self) {
+    auto* store = static_cast<MusicStoreDB*>(self);
+    store->pendingChanges.clear();
+    store->committingChanges.clear();
+}
+
 // Инициализация базы данных
 void MusicStoreDB::initializeDB() {
     std::vector<std::string> tables = {
@@ -118,51 +1017,291 @@ void MusicStoreDB::initializeDB() {
         executeQuery(sql);
     }
     
-    // Проверка наличия администратора, и создание дефолтного если нет
-    std::string checkAdmin = "SELECT COUNT(*) FROM users WHERE role = 'admin';";
-    std::vector<std::vector<std::string>> results;
+    // Полнотекстовый индекс каталога (внешнее содержимое - musical_works)
+    bool ftsExists = tableExists("musical_works_fts");
     
-    char* errMsg = nullptr;
-    int rc = sqlite3_exec(db, checkAdmin.c_str(), callback, &results, &errMsg);
+    std::vector<std::string> fullText = {
+        "CREATE VIRTUAL TABLE IF NOT EXISTS musical_works_fts USING fts5("
+        "    title, author, performer, "
+        "    content='musical_works', content_rowid='work_id', "
+        "    tokenize='unicode61 remove_diacritics 2'"
+        ");",
+        
+        // Синхронизация индекса с таблицей произведений
+        FTS_INSERT_TRIGGER,
+        
+        "CREATE TRIGGER IF NOT EXISTS musical_works_fts_delete AFTER DELETE ON musical_works "
+        "BEGIN "
+        "    INSERT INTO musical_works_fts(musical_works_fts, rowid, title, author, performer) "
+        "    VALUES ('delete', OLD.work_id, OLD.title, OLD.author, OLD.performer); "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS musical_works_fts_update AFTER UPDATE ON musical_works "
+        "BEGIN "
+        "    INSERT INTO musical_works_fts(musical_works_fts, rowid, title, author, performer) "
+        "    VALUES ('delete', OLD.work_id, OLD.title, OLD.author, OLD.performer); "
+        "    INSERT INTO musical_works_fts(rowid, title, author, performer) "
+        "    VALUES (NEW.work_id, NEW.title, NEW.author, NEW.performer); "
+        "END;"
+    };
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
-        return;
+    for (const auto& sql : fullText) {
+        executeQuery(sql);
     }
     
-    if (results.size() > 0 && results[0].size() > 0 && results[0][0] == "0") {
-        // Создание дефолтного администратора (пароль: admin)
-        std::string createAdmin = 
-            "INSERT INTO users (username, password_hash, role) "
-            "VALUES ('admin', 'admin', 'admin');";
-        executeQuery(createAdmin);
-        
-        std::cout << "Создан дефолтный администратор. Логин: admin, Пароль: admin" << std::endl;
+    // Индекс создан для уже заполненной базы - строим его по существующим данным
+    if (!ftsExists) {
+        executeQuery("INSERT INTO musical_works_fts(musical_works_fts) VALUES ('rebuild');");
     }
-    std::string checkUser = "SELECT COUNT(*) FROM users WHERE role = 'user';";
-results.clear(); // Очищаем предыдущие результаты
-rc = sqlite3_exec(db, checkUser.c_str(), callback, &results, &errMsg);
-
-if (rc != SQLITE_OK) {
-    std::cerr << "SQL error: " << errMsg << std::endl;
-    sqlite3_free(errMsg);
-    return;
-}
-
-if (results.size() > 0 && results[0].size() > 0 && results[0][0] == "0") {
-    // Создание дефолтного пользователя (пароль: user)
-    std::string createUser = 
-        "INSERT INTO users (username, password_hash, role) "
-        "VALUES ('user', 'user', 'user');";
-    executeQuery(createUser);
     
-    std::cout << "Создан дефолтный пользователь. Логин: user, Пароль: user" << std::endl;
+    // Сводные остатки по компакт-дискам, поддерживаемые триггерами.
+    // Индекс по остатку позволяет листать складской отчет без полного пересчета.
+    bool stockExists = tableExists("stock_levels");
+    
+    std::vector<std::string> stock = {
+        "CREATE TABLE IF NOT EXISTS stock_levels ("
+        "    compact_id INTEGER PRIMARY KEY,"
+        "    received INTEGER NOT NULL DEFAULT 0,"
+        "    sold INTEGER NOT NULL DEFAULT 0,"
+        "    remaining INTEGER GENERATED ALWAYS AS (received - sold) VIRTUAL,"
+        "    FOREIGN KEY (compact_id) REFERENCES compact_discs(compact_id) ON DELETE CASCADE"
+        ");",
+        
+        "CREATE INDEX IF NOT EXISTS idx_stock_levels_remaining ON stock_levels(remaining, compact_id);",
+        "CREATE INDEX IF NOT EXISTS idx_musical_works_title ON musical_works(title);",
+        
+        "CREATE TRIGGER IF NOT EXISTS stock_levels_disc_insert AFTER INSERT ON compact_discs "
+        "BEGIN "
+        "    INSERT OR IGNORE INTO stock_levels (compact_id) VALUES (NEW.compact_id); "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS stock_levels_disc_delete AFTER DELETE ON compact_discs "
+        "BEGIN "
+        "    DELETE FROM stock_levels WHERE compact_id = OLD.compact_id; "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS stock_levels_operation_insert AFTER INSERT ON operations "
+        "BEGIN "
+        "    INSERT OR IGNORE INTO stock_levels (compact_id) VALUES (NEW.compact_id); "
+        "    UPDATE stock_levels SET "
+        "        received = received + CASE WHEN NEW.operation_type = 'поступление' THEN NEW.quantity ELSE 0 END, "
+        "        sold = sold + CASE WHEN NEW.operation_type = 'продажа' THEN NEW.quantity ELSE 0 END "
+        "    WHERE compact_id = NEW.compact_id; "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS stock_levels_operation_delete AFTER DELETE ON operations "
+        "BEGIN "
+        "    UPDATE stock_levels SET "
+        "        received = received - CASE WHEN OLD.operation_type = 'поступление' THEN OLD.quantity ELSE 0 END, "
+        "        sold = sold - CASE WHEN OLD.operation_type = 'продажа' THEN OLD.quantity ELSE 0 END "
+        "    WHERE compact_id = OLD.compact_id; "
+        "END;",
+        
+        // Исправление операции: отменяется старая строка и учитывается новая
+        "CREATE TRIGGER IF NOT EXISTS stock_levels_operation_update "
+        "AFTER UPDATE OF operation_type, compact_id, quantity ON operations "
+        "BEGIN "
+        "    UPDATE stock_levels SET "
+        "        received = received - CASE WHEN OLD.operation_type = 'поступление' THEN OLD.quantity ELSE 0 END, "
+        "        sold = sold - CASE WHEN OLD.operation_type = 'продажа' THEN OLD.quantity ELSE 0 END "
+        "    WHERE compact_id = OLD.compact_id; "
+        "    INSERT OR IGNORE INTO stock_levels (compact_id) VALUES (NEW.compact_id); "
+        "    UPDATE stock_levels SET "
+        "        received = received + CASE WHEN NEW.operation_type = 'поступление' THEN NEW.quantity ELSE 0 END, "
+        "        sold = sold + CASE WHEN NEW.operation_type = 'продажа' THEN NEW.quantity ELSE 0 END "
+        "    WHERE compact_id = NEW.compact_id; "
+        "END;"
+    };
+    
+    for (const auto& sql : stock) {
+        executeQuery(sql);
+    }
+    
+    if (!stockExists) {
+        executeQuery(
+            "INSERT OR REPLACE INTO stock_levels (compact_id, received, sold) "
+            "SELECT "
+            "    cd.compact_id, "
+            "    COALESCE((SELECT SUM(quantity) FROM operations "
+            "              WHERE compact_id = cd.compact_id AND operation_type = 'поступление'), 0), "
+            "    COALESCE((SELECT SUM(quantity) FROM operations "
+            "              WHERE compact_id = cd.compact_id AND operation_type = 'продажа'), 0) "
+            "FROM compact_discs cd;");
+    }
+    
+    // Счетчик изменений каталога: по нему другие процессы узнают, что кеш каталога устарел
+    std::vector<std::string> catalogVersionSchema = {
+        "CREATE TABLE IF NOT EXISTS catalog_version ("
+        "    id INTEGER PRIMARY KEY CHECK(id = 1),"
+        "    version INTEGER NOT NULL"
+        ");",
+        
+        "INSERT OR IGNORE INTO catalog_version (id, version) VALUES (1, 0);",
+        
+        "CREATE TRIGGER IF NOT EXISTS catalog_version_compact_discs_insert AFTER INSERT ON compact_discs "
+        "BEGIN "
+        "    UPDATE catalog_version SET version = version + 1 WHERE id = 1; "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS catalog_version_compact_discs_update AFTER UPDATE ON compact_discs "
+        "BEGIN "
+        "    UPDATE catalog_version SET version = version + 1 WHERE id = 1; "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS catalog_version_compact_discs_delete AFTER DELETE ON compact_discs "
+        "BEGIN "
+        "    UPDATE catalog_version SET version = version + 1 WHERE id = 1; "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS catalog_version_musical_works_insert AFTER INSERT ON musical_works "
+        "BEGIN "
+        "    UPDATE catalog_version SET version = version + 1 WHERE id = 1; "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS catalog_version_musical_works_update AFTER UPDATE ON musical_works "
+        "BEGIN "
+        "    UPDATE catalog_version SET version = version + 1 WHERE id = 1; "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS catalog_version_musical_works_delete AFTER DELETE ON musical_works "
+        "BEGIN "
+        "    UPDATE catalog_version SET version = version + 1 WHERE id = 1; "
+        "END;"
+    };
+    
+    for (const auto& sql : catalogVersionSchema) {
+        executeQuery(sql);
+    }
+    
+    // Дневная сводка продаж для временных рядов, поддерживаемая триггерами
+    bool dailySalesExists = tableExists("daily_sales");
+    
+    std::vector<std::string> dailySales = {
+        "CREATE TABLE IF NOT EXISTS daily_sales ("
+        "    compact_id INTEGER NOT NULL,"
+        "    sale_date DATE NOT NULL,"
+        "    sold INTEGER NOT NULL,"
+        "    PRIMARY KEY (compact_id, sale_date),"
+        "    FOREIGN KEY (compact_id) REFERENCES compact_discs(compact_id) ON DELETE CASCADE"
+        ") WITHOUT ROWID;",
+        
+        "CREATE INDEX IF NOT EXISTS idx_daily_sales_date ON daily_sales(sale_date);",
+        
+        "CREATE TRIGGER IF NOT EXISTS daily_sales_operation_insert AFTER INSERT ON operations "
+        "WHEN NEW.operation_type = 'продажа' "
+        "BEGIN "
+        "    INSERT INTO daily_sales (compact_id, sale_date, sold) "
+        "    VALUES (NEW.compact_id, NEW.operation_date, NEW.quantity) "
+        "    ON CONFLICT (compact_id, sale_date) DO UPDATE SET sold = sold + excluded.sold; "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS daily_sales_operation_delete AFTER DELETE ON operations "
+        "WHEN OLD.operation_type = 'продажа' "
+        "BEGIN "
+        "    UPDATE daily_sales SET sold = sold - OLD.quantity "
+        "    WHERE compact_id = OLD.compact_id AND sale_date = OLD.operation_date; "
+        "    DELETE FROM daily_sales "
+        "    WHERE compact_id = OLD.compact_id AND sale_date = OLD.operation_date AND sold <= 0; "
+        "END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS daily_sales_operation_update "
+        "AFTER UPDATE OF operation_date, operation_type, compact_id, quantity ON operations "
+        "BEGIN "
+        "    UPDATE daily_sales SET sold = sold - OLD.quantity "
+        "    WHERE OLD.operation_type = 'продажа' "
+        "      AND compact_id = OLD.compact_id AND sale_date = OLD.operation_date; "
+        "    DELETE FROM daily_sales "
+        "    WHERE compact_id = OLD.compact_id AND sale_date = OLD.operation_date AND sold <= 0; "
+        "    INSERT INTO daily_sales (compact_id, sale_date, sold) "
+        "    SELECT NEW.compact_id, NEW.operation_date, NEW.quantity "
+        "    WHERE NEW.operation_type = 'продажа' "
+        "    ON CONFLICT (compact_id, sale_date) DO UPDATE SET sold = sold + excluded.sold; "
+        "END;"
+    };
+    
+    for (const auto& sql : dailySales) {
+        executeQuery(sql);
+    }
+    
+    if (!dailySalesExists) {
+        executeQuery(
+            "INSERT INTO daily_sales (compact_id, sale_date, sold) "
+            "SELECT compact_id, operation_date, SUM(quantity) "
+            "FROM operations "
+            "WHERE operation_type = 'продажа' "
+            "GROUP BY compact_id, operation_date;");
+    }
+    
+    // Соответствие внешних ключей импорта идентификаторам компакт-дисков
+    std::vector<std::string> importKeys = {
+        "CREATE TABLE IF NOT EXISTS import_keys ("
+        "    external_key TEXT PRIMARY KEY,"
+        "    compact_id INTEGER NOT NULL,"
+        "    FOREIGN KEY (compact_id) REFERENCES compact_discs(compact_id) ON DELETE CASCADE"
+        ") WITHOUT ROWID;",
+        
+        "CREATE INDEX IF NOT EXISTS idx_import_keys_compact_id ON import_keys(compact_id);",
+        
+        "CREATE TRIGGER IF NOT EXISTS import_keys_disc_delete AFTER DELETE ON compact_discs "
+        "BEGIN "
+        "    DELETE FROM import_keys WHERE compact_id = OLD.compact_id; "
+        "END;"
+    };
+    
+    for (const auto& sql : importKeys) {
+        executeQuery(sql);
+    }
+    
+    // Проверка наличия администратора, и создание дефолтного если нет
+    std::string checkAdmin = "SELECT COUNT(*) FROM users WHERE role = 'admin';";
+    std::vector<std::vector<std::string>> results;
+    
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(db, checkAdmin.c_str(), callback, &results, &errMsg);
+    
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return;
+    }
+    
+    if (results.size() > 0 && results[0].size() > 0 && results[0][0] == "0") {
+        // Создание дефолтного администратора (пароль: admin)
+        std::string createAdmin = 
+            "INSERT INTO users (username, password_hash, role) "
+            "VALUES ('admin', 'admin', 'admin');";
+        executeQuery(createAdmin);
+        
+        std::cout << "Создан дефолтный администратор. Логин: admin, Пароль: admin" << std::endl;
+    }
+    std::string checkUser = "SELECT COUNT(*) FROM users WHERE role = 'user';";
+results.clear(); // Очищаем предыдущие результаты
+rc = sqlite3_exec(db, checkUser.c_str(), callback, &results, &errMsg);
+
+if (rc != SQLITE_OK) {
+    std::cerr << "SQL error: " << errMsg << std::endl;
+    sqlite3_free(errMsg);
+    return;
+}
+
+if (results.size() > 0 && results[0].size() > 0 && results[0][0] == "0") {
+    // Создание дефолтного пользователя (пароль: user)
+    std::string createUser = 
+        "INSERT INTO users (username, password_hash, role) "
+        "VALUES ('user', 'user', 'user');";
+    executeQuery(createUser);
+    
+    std::cout << "Создан дефолтный пользователь. Логин: user, Пароль: user" << std::endl;
 }
 }
 
 // Выполнение SQL-запроса
 bool MusicStoreDB::executeQuery(const std::string& sql) {
+    // Вне транзакции запрос может начать новую: версию каталога нужно проверить снова
+    if (sqlite3_get_autocommit(db)) {
+        catalogChecked = false;
+    }
+    
     char* errMsg = nullptr;
     int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
     
@@ -175,6 +1314,56 @@ bool MusicStoreDB::executeQuery(const std::string& sql) {
     return true;
 }
 
+// Выполнение записи с повтором при занятой базе
+bool MusicStoreDB::executeWrite(const std::string& sql) {
+    if (sqlite3_get_autocommit(db)) {
+        catalogChecked = false;
+    }
+    
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
+    for (int attempt = 0; (rc & 0xFF) == SQLITE_BUSY && attempt < busyPolicy.writeRetries; attempt++) {
+        sqlite3_free(errMsg);
+        errMsg = nullptr;
+        writeRetries++;
+        rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
+    }
+    
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error: " << (errMsg ? errMsg : sqlite3_errmsg(db)) << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    
+    return true;
+}
+
+// Шаг изменяющего запроса с повтором при занятой базе
+int MusicStoreDB::stepWrite(sqlite3_stmt* stmt) {
+    int rc = sqlite3_step(stmt);
+    for (int attempt = 0; (rc & 0xFF) == SQLITE_BUSY && attempt < busyPolicy.writeRetries; attempt++) {
+        sqlite3_reset(stmt);
+        writeRetries++;
+        rc = sqlite3_step(stmt);
+    }
+    return rc;
+}
+
+// Проверка существования таблицы
+bool MusicStoreDB::tableExists(const std::string& name) {
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE name = ?;", -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        return false;
+    }
+    
+    sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_STATIC);
+    bool exists = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
 // Callback-функция для обработки результатов запроса
 int MusicStoreDB::callback(void* data, int argc, char** argv, char** azColName) {
     auto* rows = static_cast<std::vector<std::vector<std::string>>*>(data);
@@ -188,61 +1377,78 @@ int MusicStoreDB::callback(void* data, int argc, char** argv, char** azColName)
     return 0;
 }
 
-// Callback-функция для вывода результатов запроса
-int MusicStoreDB::printCallback(void* notUsed, int argc, char** argv, char** azColName) {
-    // Вывод заголовков при первом вызове
+// Callback-функция для накопления результатов запроса в таблице
+int MusicStoreDB::tableCallback(void* writer, int argc, char** argv, char** azColName) {
+    auto* table = static_cast<TableWriter*>(writer);
     
-    if (headers) {
+    // Заголовки берутся из первой строки результата
+    if (!table->hasHeader()) {
         for (int i = 0; i < argc; i++) {
-            std::cout << std::left << std::setw(20) << azColName[i] << " | ";
+            table->addHeaderColumn(azColName[i]);
         }
-        std::cout << std::endl;
-        std::cout << std::string(argc * 23, '-') << std::endl;
-        headers = false;
     }
     
-    // Вывод данных
+    // Значения копируются сразу в память таблицы, без промежуточного вектора
+    table->beginRow();
     for (int i = 0; i < argc; i++) {
-        std::cout << std::left << std::setw(20) << (argv[i] ? argv[i] : "NULL") << " | ";
+        table->addCell(argv[i] ? argv[i] : "NULL");
     }
-    std::cout << std::endl;
-    
     return 0;
 }
 
-// Аутентификация пользователя
-bool MusicStoreDB::login(const std::string& username, const std::string& password) {
-    std::string sql = "SELECT user_id, role FROM users WHERE username = ? AND password_hash = ?;";
+// Вывод заголовка отчета (только в текстовом формате)
+void MusicStoreDB::printTitle(const std::string& title) {
+    if (outputFormat == TableWriter::Format::Text) {
+        std::cout << "\n=== " << title << " ===\n";
+    }
+}
+
+// Проверка имени и пароля
+std::optional<AuthenticatedUser> MusicStoreDB::authenticate(const std::string& username, const std::string& password) {
+    auto row = Query<AUTHENTICATE_SQL, std::tuple<int, std::string, std::string>, std::string_view>(statements)
+                   .bind(username).fetchOne();
+    if (!row) {
+        return std::nullopt;
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    const auto& [id, role, stored] = *row;
+    bool hashed = PasswordHash::isHashed(stored);
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        return false;
+    // Пароли, сохраненные до появления хеширования, сравниваются как есть и помечаются для замены хешем
+    if (hashed ? !PasswordHash::verify(password, stored) : stored != password) {
+        return std::nullopt;
     }
     
-    sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, password.c_str(), -1, SQLITE_STATIC);
-    
-    rc = sqlite3_step(stmt);
+    return AuthenticatedUser{id, username, role == "admin", !hashed};
+}
+
+// Сохранение хеша пароля
+bool MusicStoreDB::updatePasswordHash(int userId, const std::string& passwordHash) {
+    if (!ensureWritable()) {
+        return false;
+    }
+    return Command<UPDATE_PASSWORD_HASH_SQL, std::string_view, int>(statements).bind(passwordHash, userId).execute();
+}
+
+// Аутентификация пользователя
+bool MusicStoreDB::login(const std::string& username, const std::string& password) {
+    std::optional<AuthenticatedUser> user = authenticate(username, password);
+    if (!user) {
+        return false;
+    }
     
-    if (rc == SQLITE_ROW) {
-        userId = sqlite3_column_int(stmt, 0);
-        std::string role = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        isAdmin = (role == "admin");
-        
-        sqlite3_finalize(stmt);
-        return true;
+    // Открытый пароль заменяется хешем при первом успешном входе
+    if (user->needsRehash && openMode == OpenMode::ReadWrite) {
+        updatePasswordHash(user->userId, PasswordHash::hash(password));
     }
     
-    sqlite3_finalize(stmt);
-    return false;
+    userId = user->userId;
+    isAdmin = user->admin;
+    return true;
 }
 
 // Информация о компакт-дисках
 void MusicStoreDB::showCompactInventory() {
-    headers=true;
     std::string sql = 
         "SELECT "
         "    cd.compact_id, "
@@ -280,71 +1486,93 @@ void MusicStoreDB::showCompactInventory() {
         "ORDER BY "
         "    (COALESCE(received.total_received, 0) - COALESCE(sold.total_sold, 0)) DESC;";
     
-    std::cout << "\n=== Информация о запасах компакт-дисков ===" << std::endl;
+    printTitle("Информация о запасах компакт-дисков");
     
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
     char* errMsg = nullptr;
-    int rc = sqlite3_exec(db, sql.c_str(), printCallback, nullptr, &errMsg);
+    int rc = sqlite3_exec(db, sql.c_str(), tableCallback, &table, &errMsg);
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << errMsg << std::endl;
         sqlite3_free(errMsg);
+        return;
     }
+    
+    table.write(std::cout);
 }
 
-// Информация о продажах компакт-диска за период
-void MusicStoreDB::showCompactSales(int compactId, const std::string& startDate, const std::string& endDate) {
-    std::string sql = 
+// Страница складского отчета
+Page<InventoryRow> MusicStoreDB::getCompactInventoryPage(int pageSize, const std::string& token) {
+    Page<InventoryRow> page;
+    
+    // Ключ последней строки предыдущей страницы: (остаток, compact_id)
+    bool hasKey = !token.empty();
+    long long lastRemaining = 0;
+    int lastId = 0;
+    if (hasKey) {
+        auto parts = decodePageToken(token);
+        if (parts.size() != 3 || parts[0] != "inv") {
+            std::cerr << "Неверный токен продолжения" << std::endl;
+            return page;
+        }
+        try {
+            lastRemaining = std::stoll(parts[1]);
+            lastId = std::stoi(parts[2]);
+        } catch (const std::exception&) {
+            std::cerr << "Неверный токен продолжения" << std::endl;
+            return page;
+        }
+    }
+    
+    // Условие по ключу только для следующих страниц: с ним SQLite ищет по индексу
+    std::string keyFilter = hasKey ? "WHERE (sl.remaining, sl.compact_id) < (?2, ?3) " : "";
+    
+    std::string sql =
         "SELECT "
         "    cd.compact_id, "
         "    cd.company, "
         "    cd.production_date, "
         "    cd.price, "
-        "    SUM(op.quantity) AS quantity_sold, "
-        "    SUM(op.quantity * cd.price) AS total_value "
+        "    sl.received, "
+        "    sl.sold, "
+        "    sl.remaining, "
+        "    sl.remaining * cd.price AS stock_value "
         "FROM "
-        "    operations op "
+        "    stock_levels sl "
         "JOIN "
-        "    compact_discs cd ON op.compact_id = cd.compact_id "
-        "WHERE "
-        "    op.operation_type = 'продажа' "
-        "    AND op.compact_id = ? "
-        "    AND op.operation_date BETWEEN ? AND ? "
-        "GROUP BY "
-        "    cd.compact_id;";
+        "    compact_discs cd ON cd.compact_id = sl.compact_id "
+        + keyFilter +
+        "ORDER BY "
+        "    sl.remaining DESC, sl.compact_id DESC "
+        "LIMIT ?1;";
     
     sqlite3_stmt* stmt;
     int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        return;
+        return page;
     }
     
-    sqlite3_bind_int(stmt, 1, compactId);
-    sqlite3_bind_text(stmt, 2, startDate.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, endDate.c_str(), -1, SQLITE_STATIC);
-    
-    std::cout << "\n=== Информация о продажах компакта #" << compactId << " за период " 
-              << startDate << " - " << endDate << " ===" << std::endl;
-    
-    // Вывод заголовков
-    std::cout << std::left 
-              << std::setw(10) << "ID" << " | "
-              << std::setw(20) << "Компания" << " | "
-              << std::setw(15) << "Дата выпуска" << " | "
-              << std::setw(10) << "Цена" << " | "
-              << std::setw(15) << "Кол-во продано" << " | "
-              << std::setw(15) << "Общая сумма" << std::endl;
-    std::cout << std::string(95, '-') << std::endl;
+    // Запрашиваем на одну строку больше, чтобы узнать, есть ли следующая страница
+    sqlite3_bind_int(stmt, 1, pageSize + 1);
+    if (hasKey) {
+        sqlite3_bind_int64(stmt, 2, lastRemaining);
+        sqlite3_bind_int(stmt, 3, lastId);
+    }
     
     while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        std::cout << std::left 
-                  << std::setw(10) << sqlite3_column_int(stmt, 0) << " | "
-                  << std::setw(20) << sqlite3_column_text(stmt, 1) << " | "
-                  << std::setw(15) << sqlite3_column_text(stmt, 2) << " | "
-                  << std::setw(10) << sqlite3_column_double(stmt, 3) << " | "
-                  << std::setw(15) << sqlite3_column_int(stmt, 4) << " | "
-                  << std::setw(15) << sqlite3_column_double(stmt, 5) << std::endl;
+        page.rows.push_back({
+            sqlite3_column_int(stmt, 0),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)),
+            sqlite3_column_double(stmt, 3),
+            sqlite3_column_int64(stmt, 4),
+            sqlite3_column_int64(stmt, 5),
+            sqlite3_column_int64(stmt, 6),
+            sqlite3_column_double(stmt, 7)
+        });
     }
     
     if (rc != SQLITE_DONE) {
@@ -352,133 +1580,1023 @@ void MusicStoreDB::showCompactSales(int compactId, const std::string& startDate,
     }
     
     sqlite3_finalize(stmt);
+    
+    if (static_cast<int>(page.rows.size()) > pageSize) {
+        page.rows.pop_back();
+        const InventoryRow& last = page.rows.back();
+        page.nextToken = encodePageToken({"inv", std::to_string(last.remaining), std::to_string(last.compactId)});
+    }
+    
+    return page;
+}
+
+// Вывод страницы складского отчета
+std::string MusicStoreDB::showCompactInventoryPage(int pageSize, const std::string& token) {
+    Page<InventoryRow> page = getCompactInventoryPage(pageSize, token);
+    
+    printTitle("Информация о запасах компакт-дисков");
+    
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
+    table.setHeader({"ID", "Компания", "Дата выпуска", "Цена", "Поступило", "Продано", "Остаток", "Стоимость"});
+    
+    for (const auto& row : page.rows) {
+        table.addRow({
+            std::to_string(row.compactId),
+            row.company,
+            row.productionDate,
+            TableWriter::formatNumber(row.price),
+            std::to_string(row.totalReceived),
+            std::to_string(row.totalSold),
+            std::to_string(row.remaining),
+            TableWriter::formatNumber(row.stockValue)
+        });
+    }
+    
+    table.write(std::cout);
+    
+    return page.nextToken;
+}
+
+// Страница каталога произведений
+Page<CatalogRow> MusicStoreDB::getCatalogPage(int pageSize, const std::string& token) {
+    Page<CatalogRow> page;
+    
+    // Ключ последней строки предыдущей страницы: (название, work_id)
+    bool hasKey = !token.empty();
+    std::string lastTitle;
+    int lastId = 0;
+    if (hasKey) {
+        auto parts = decodePageToken(token);
+        if (parts.size() != 3 || parts[0] != "cat") {
+            std::cerr << "Неверный токен продолжения" << std::endl;
+            return page;
+        }
+        lastTitle = parts[1];
+        try {
+            lastId = std::stoi(parts[2]);
+        } catch (const std::exception&) {
+            std::cerr << "Неверный токен продолжения" << std::endl;
+            return page;
+        }
+    }
+    
+    std::string keyFilter = hasKey ? "WHERE (mw.title, mw.work_id) > (?2, ?3) " : "";
+    
+    std::string sql =
+        "SELECT "
+        "    mw.work_id, "
+        "    mw.title, "
+        "    mw.author, "
+        "    mw.performer, "
+        "    cd.compact_id, "
+        "    cd.company, "
+        "    cd.price "
+        "FROM "
+        "    musical_works mw "
+        "JOIN "
+        "    compact_discs cd ON cd.compact_id = mw.compact_id "
+        + keyFilter +
+        "ORDER BY "
+        "    mw.title, mw.work_id "
+        "LIMIT ?1;";
+    
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return page;
+    }
+    
+    sqlite3_bind_int(stmt, 1, pageSize + 1);
+    if (hasKey) {
+        sqlite3_bind_text(stmt, 2, lastTitle.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 3, lastId);
+    }
+    
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        page.rows.push_back({
+            sqlite3_column_int(stmt, 0),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)),
+            sqlite3_column_int(stmt, 4),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5)),
+            sqlite3_column_double(stmt, 6)
+        });
+    }
+    
+    if (rc != SQLITE_DONE) {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+    }
+    
+    sqlite3_finalize(stmt);
+    
+    if (static_cast<int>(page.rows.size()) > pageSize) {
+        page.rows.pop_back();
+        const CatalogRow& last = page.rows.back();
+        page.nextToken = encodePageToken({"cat", last.title, std::to_string(last.workId)});
+    }
+    
+    return page;
+}
+
+// Информация о продажах компакт-диска за период
+void MusicStoreDB::showCompactSales(int compactId, const std::string& startDate, const std::string& endDate) {
+    auto sales = Query<COMPACT_PERIOD_SALES_SQL, std::tuple<long long, long long>, int, std::string_view,
+                       std::string_view>(statements).bind(compactId, startDate, endDate).fetchOne();
+    
+    printTitle("Информация о продажах компакта #" + std::to_string(compactId) + " за период " +
+               startDate + " - " + endDate);
+    
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
+    table.setHeader({"ID", "Компания", "Дата выпуска", "Цена", "Кол-во продано", "Общая сумма"});
+    
+    // Данные компакт-диска берутся из кеша каталога, из базы - только сумма продаж
+    std::shared_ptr<const CatalogSnapshot> snapshot = catalogSnapshot();
+    CatalogDisc loaded;
+    const CatalogDisc* disc = findDisc(snapshot.get(), compactId, loaded);
+    if (sales && std::get<0>(*sales) > 0 && disc) {
+        long long sold = std::get<1>(*sales);
+        table.addRow({
+            std::to_string(compactId),
+            disc->company,
+            disc->productionDate,
+            TableWriter::formatNumber(disc->price),
+            std::to_string(sold),
+            TableWriter::formatNumber(sold * disc->price)
+        });
+    }
+    
+    table.write(std::cout);
+}
+
+// Сохранение статистики за период в report_results
+bool MusicStoreDB::storePeriodStatistics(const std::string& startDate, const std::string& endDate) {
+    // Очистка предыдущих результатов для этого периода и вставка новых
+    return Command<CLEAR_PERIOD_STATISTICS_SQL, std::string_view, std::string_view>(statements)
+               .bind(startDate, endDate).execute() &&
+           Command<STORE_PERIOD_STATISTICS_SQL, std::string_view, std::string_view>(statements)
+               .bind(startDate, endDate).execute();
 }
 
 // Расчет статистики за период
 void MusicStoreDB::calculatePeriodStatistics(const std::string& startDate, const std::string& endDate) {
-    // Очистка предыдущих результатов для этого периода
-    std::string clearSQL = 
-        "DELETE FROM report_results WHERE start_date = ? AND end_date = ?;";
+    if (openMode == OpenMode::ReadWrite && !storePeriodStatistics(startDate, endDate)) {
+        return;
+    }
+    
+    printTitle("Отчет по операциям за период " + startDate + " - " + endDate);
+    
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
+    table.setHeader({"ID", "Компания", "Поступило", "Продано", "Остаток"});
+    
+    auto addRow = [&table](int compactId, std::string_view company, long long received, long long sold,
+                           long long remaining) {
+        table.addRow({std::to_string(compactId), company, std::to_string(received), std::to_string(sold),
+                      std::to_string(remaining)});
+    };
+    
+    // Вывод отчета
+    if (openMode != OpenMode::ReadWrite) {
+        Query<PERIOD_STATISTICS_DIRECT_SQL, PeriodStatisticsRow, std::string_view, std::string_view>(statements)
+            .bind(startDate, endDate).forEach(addRow);
+    } else {
+        Query<PERIOD_STATISTICS_SQL, PeriodStatisticsRow, std::string_view, std::string_view>(statements)
+            .bind(startDate, endDate).forEach(addRow);
+    }
+    
+    table.write(std::cout);
+}
+
+// Сравнение нескольких периодов
+PeriodComparison MusicStoreDB::comparePeriods(const std::vector<ReportPeriod>& periods) {
+    PeriodComparison comparison{periods, {}, std::vector<PeriodMetrics>(periods.size(), PeriodMetrics{0, 0, 0.0}), {}};
+    if (periods.empty() || !executeQuery(REPORT_PERIODS_CREATE_SQL)) {
+        return comparison;
+    }
+    
+    // Периоды и запрос - в одной транзакции, как во временной таблице selected_discs
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownTransaction) {
+        executeQuery("BEGIN;");
+    }
+    
+    bool ok = Command<REPORT_PERIODS_CLEAR_SQL>(statements).bind().execute();
+    {
+        Command<REPORT_PERIOD_INSERT_SQL, int, std::string_view, std::string_view> insert(statements);
+        for (size_t i = 0; ok && i < periods.size(); i++) {
+            ok = insert.bind(static_cast<int>(i), periods[i].startDate, periods[i].endDate).execute();
+        }
+    }
+    
+    if (ok) {
+        Query<PERIOD_COMPARISON_SQL, PeriodComparisonSqlRow>(statements).bind().forEach(
+            [&](int compactId, std::string_view company, double price, std::optional<int> periodIndex,
+                long long received, long long sold) {
+                // Строки отсортированы по диску: новая строка отчета начинается со сменой идентификатора
+                if (comparison.rows.empty() || comparison.rows.back().compactId != compactId) {
+                    comparison.rows.push_back(PeriodComparisonRow{
+                        compactId, std::string(company),
+                        std::vector<PeriodMetrics>(periods.size(), PeriodMetrics{0, 0, 0.0}), {}});
+                }
+                if (!periodIndex) {
+                    return;
+                }
+                
+                PeriodMetrics& metrics = comparison.rows.back().periods[*periodIndex];
+                metrics = PeriodMetrics{received, sold, sold * price};
+                PeriodMetrics& total = comparison.totals[*periodIndex];
+                total.received += received;
+                total.sold += sold;
+                total.revenue += metrics.revenue;
+            });
+    }
+    
+    Command<REPORT_PERIODS_CLEAR_SQL>(statements).bind().execute();
+    if (ownTransaction) {
+        executeQuery("COMMIT;");
+    }
+    
+    for (auto& row : comparison.rows) {
+        row.changes = periodChanges(row.periods);
+    }
+    comparison.totalChanges = periodChanges(comparison.totals);
+    return comparison;
+}
+
+// Вывод сравнения периодов
+void MusicStoreDB::showPeriodComparison(const std::vector<ReportPeriod>& periods) {
+    PeriodComparison comparison = comparePeriods(periods);
+    
+    std::string title = "Сравнение периодов";
+    for (size_t i = 0; i < periods.size(); i++) {
+        title += (i == 0 ? ": " : ", ") + std::to_string(i + 1) + ") " + periods[i].startDate + " - " +
+                 periods[i].endDate;
+    }
+    printTitle(title);
+    
+    // Для каждого периода - продажи и выручка, начиная со второго - изменение к предыдущему
+    std::vector<std::string> header = {"ID", "Компания"};
+    for (size_t i = 0; i < periods.size(); i++) {
+        std::string suffix = " " + std::to_string(i + 1);
+        header.push_back("Продано" + suffix);
+        header.push_back("Выручка" + suffix);
+        if (i > 0) {
+            header.push_back("Изменение" + suffix);
+            header.push_back("Рост, %" + suffix);
+        }
+    }
+    
+    auto cellsOf = [&](std::vector<std::string> cells, const std::vector<PeriodMetrics>& metrics,
+                       const std::vector<PeriodChange>& changes) {
+        for (size_t i = 0; i < metrics.size(); i++) {
+            cells.push_back(std::to_string(metrics[i].sold));
+            cells.push_back(TableWriter::formatNumber(metrics[i].revenue));
+            if (i > 0) {
+                const PeriodChange& change = changes[i - 1];
+                cells.push_back(std::to_string(change.soldDelta));
+                cells.push_back(change.soldGrowth ? TableWriter::formatNumber(*change.soldGrowth * 100.0) : "-");
+            }
+        }
+        return cells;
+    };
+    
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
+    table.setHeader(header);
+    for (const auto& row : comparison.rows) {
+        table.addRow(cellsOf({std::to_string(row.compactId), row.company}, row.periods, row.changes));
+    }
+    table.addRow(cellsOf({"Итого", ""}, comparison.totals, comparison.totalChanges));
+    table.write(std::cout);
+}
+
+// Временной ряд продаж
+std::vector<SalesSeriesPoint> MusicStoreDB::getSalesSeries(SeriesBucket bucket, SeriesGrouping grouping,
+                                                           const std::string& startDate, const std::string& endDate,
+                                                           int window) {
+    std::vector<SalesSeriesPoint> points;
+    if (window < 1) {
+        std::cerr << "Окно скользящего среднего должно быть не меньше 1" << std::endl;
+        return points;
+    }
+    
+    // Копия базы со старой схемой открывается без записи: сводка заменяется представлением
+    if (!tableExists("daily_sales") && !executeQuery(DAILY_SALES_VIEW_SQL)) {
+        return points;
+    }
+    
+    const char* bucketName = bucket == SeriesBucket::Day ? "day" : bucket == SeriesBucket::Week ? "week" : "month";
+    const char* groupingName =
+        grouping == SeriesGrouping::Disc ? "disc" : grouping == SeriesGrouping::Performer ? "performer" : "author";
+    
+    Query<SALES_SERIES_SQL, SalesSeriesRow, std::string_view, std::string_view, std::string_view, std::string_view, int>(
+        statements)
+        .bind(bucketName, startDate, endDate, groupingName, window)
+        .forEach([&](std::string key, std::string start, long long sold, double revenue, double averageSold,
+                     double averageRevenue, long long runningSold, double runningRevenue) {
+            points.push_back(SalesSeriesPoint{std::move(key), std::move(start), sold, revenue, averageSold,
+                                              averageRevenue, runningSold, runningRevenue});
+        });
+    return points;
+}
+
+// Вывод временного ряда продаж
+void MusicStoreDB::showSalesSeries(SeriesBucket bucket, SeriesGrouping grouping, const std::string& startDate,
+                                   const std::string& endDate, int window) {
+    std::vector<SalesSeriesPoint> points = getSalesSeries(bucket, grouping, startDate, endDate, window);
+    
+    printTitle("Продажи по времени за период " + startDate + " - " + endDate + " (окно " + std::to_string(window) + ")");
+    
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
+    const char* keyColumn =
+        grouping == SeriesGrouping::Disc ? "ID" : grouping == SeriesGrouping::Performer ? "Исполнитель" : "Автор";
+    table.setHeader({keyColumn, "Начало", "Продано", "Выручка", "Среднее продаж", "Средняя выручка", "Продано всего",
+                     "Выручка всего"});
+    for (const auto& point : points) {
+        table.addRow({
+            point.key,
+            point.bucket,
+            std::to_string(point.sold),
+            TableWriter::formatNumber(point.revenue),
+            TableWriter::formatNumber(point.averageSold),
+            TableWriter::formatNumber(point.averageRevenue),
+            std::to_string(point.runningSold),
+            TableWriter::formatNumber(point.runningRevenue)
+        });
+    }
+    table.write(std::cout);
+}
+
+// Преобразование пользовательской строки в запрос FTS5
+std::string MusicStoreDB::buildMatchQuery(const std::string& text) {
+    std::string query;
+    std::string word;
+    
+    auto flush = [&]() {
+        if (word.empty()) {
+            return;
+        }
+        
+        // Префикс поля ограничивает поиск одной колонкой
+        std::string column;
+        size_t colon = word.find(':');
+        if (colon != std::string::npos) {
+            std::string field = word.substr(0, colon);
+            if (field == "title" || field == "author" || field == "performer") {
+                column = field;
+                word = word.substr(colon + 1);
+            }
+        }
         
-    sqlite3_stmt* clearStmt;
-    int rc = sqlite3_prepare_v2(db, clearSQL.c_str(), -1, &clearStmt, nullptr);
+        if (!word.empty()) {
+            if (!query.empty()) {
+                query += " ";
+            }
+            if (!column.empty()) {
+                query += column + " : ";
+            }
+            // Слово берется в кавычки, чтобы спецсимволы FTS5 не разбирались как синтаксис
+            query += "\"" + word + "\"*";
+        }
+        word.clear();
+    };
+    
+    for (char c : text) {
+        if (c == ' ' || c == '\t' || c == '\n') {
+            flush();
+        } else if (c != '"') {
+            word += c;
+        }
+    }
+    flush();
+    
+    return query;
+}
+
+// Полнотекстовый поиск по каталогу
+std::vector<CatalogSearchResult> MusicStoreDB::searchCatalog(const std::string& text, int limit, int offset) {
+    std::vector<CatalogSearchResult> result;
+    std::string match = buildMatchQuery(text);
+    
+    if (match.empty()) {
+        return result;
+    }
+    
+    // Совпадение в названии весит больше, чем в авторе или исполнителе
+    std::string sql =
+        "SELECT "
+        "    mw.work_id, "
+        "    mw.title, "
+        "    mw.author, "
+        "    mw.performer, "
+        "    cd.compact_id, "
+        "    cd.company, "
+        "    cd.production_date, "
+        "    cd.price, "
+        "    bm25(musical_works_fts, 10.0, 5.0, 5.0) AS score "
+        "FROM "
+        "    musical_works_fts "
+        "JOIN "
+        "    musical_works mw ON mw.work_id = musical_works_fts.rowid "
+        "JOIN "
+        "    compact_discs cd ON cd.compact_id = mw.compact_id "
+        "WHERE "
+        "    musical_works_fts MATCH ? "
+        "ORDER BY "
+        "    score, mw.work_id "
+        "LIMIT ? OFFSET ?;";
+    
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        return;
+        return result;
     }
     
-    sqlite3_bind_text(clearStmt, 1, startDate.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(clearStmt, 2, endDate.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 1, match.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, limit);
+    sqlite3_bind_int(stmt, 3, offset);
+    
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        result.push_back({
+            sqlite3_column_int(stmt, 0),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)),
+            sqlite3_column_int(stmt, 4),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5)),
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6)),
+            sqlite3_column_double(stmt, 7),
+            sqlite3_column_double(stmt, 8)
+        });
+    }
     
-    rc = sqlite3_step(clearStmt);
     if (rc != SQLITE_DONE) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(clearStmt);
-        return;
     }
     
-    sqlite3_finalize(clearStmt);
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+// Вывод страницы результатов поиска по каталогу
+bool MusicStoreDB::showCatalogSearch(const std::string& text, int page, int pageSize) {
+    if (page < 1) {
+        page = 1;
+    }
+    
+    // Лишняя строка показывает, есть ли следующая страница, без второго запроса
+    auto results = searchCatalog(text, pageSize + 1, (page - 1) * pageSize);
+    bool hasMore = results.size() > static_cast<size_t>(pageSize);
+    if (hasMore) {
+        results.pop_back();
+    }
+    
+    printTitle("Поиск по каталогу: \"" + text + "\" (страница " + std::to_string(page) + ")");
+    
+    if (results.empty() && outputFormat == TableWriter::Format::Text) {
+        std::cout << "Ничего не найдено." << std::endl;
+        return false;
+    }
+    
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
+    table.setHeader({"ID диска", "Название", "Автор", "Исполнитель", "Компания", "Цена"});
+    
+    for (const auto& row : results) {
+        table.addRow({
+            std::to_string(row.compactId),
+            row.title,
+            row.author,
+            row.performer,
+            row.company,
+            TableWriter::formatNumber(row.price)
+        });
+    }
+    
+    table.write(std::cout);
+    return hasMore;
+}
+
+// Потоковая выгрузка результата запроса
+long long MusicStoreDB::exportStatement(sqlite3_stmt* stmt, const std::string& path,
+                                        ExportWriter::Format format, bool compress) {
+    ExportWriter writer(path, format, compress);
+    if (!writer.isOpen()) {
+        sqlite3_finalize(stmt);
+        return -1;
+    }
     
-    // Вставка новых результатов
-    std::string insertSQL = 
-        "INSERT INTO report_results (start_date, end_date, compact_id, received_quantity, sold_quantity) "
+    int columnCount = sqlite3_column_count(stmt);
+    std::vector<std::string> columns;
+    for (int i = 0; i < columnCount; i++) {
+        columns.emplace_back(sqlite3_column_name(stmt, i));
+    }
+    writer.setColumns(columns);
+    
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        writer.beginRow();
+        for (int i = 0; i < columnCount; i++) {
+            int type = sqlite3_column_type(stmt, i);
+            if (type == SQLITE_NULL) {
+                writer.addNull();
+                continue;
+            }
+            
+            // Текстовое представление значения формирует сам SQLite
+            const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+            std::string_view value(text, static_cast<size_t>(sqlite3_column_bytes(stmt, i)));
+            if (type == SQLITE_INTEGER || type == SQLITE_FLOAT) {
+                writer.addNumber(value);
+            } else {
+                writer.addText(value);
+            }
+        }
+        writer.endRow();
+    }
+    
+    if (rc != SQLITE_DONE) {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+    }
+    
+    sqlite3_finalize(stmt);
+    
+    // Прерванный запрос не должен оставить усеченную выгрузку
+    if (rc != SQLITE_DONE) {
+        writer.discard();
+        return -1;
+    }
+    if (!writer.close()) {
+        return -1;
+    }
+    return writer.rowCount();
+}
+
+// Выгрузка операций за период
+long long MusicStoreDB::exportOperations(const std::string& path, const std::string& startDate,
+                                         const std::string& endDate, ExportWriter::Format format,
+                                         bool compress) {
+    std::string sql =
+        "SELECT "
+        "    op.operation_id, "
+        "    op.operation_date, "
+        "    op.operation_type, "
+        "    op.compact_id, "
+        "    cd.company, "
+        "    op.quantity, "
+        "    cd.price, "
+        "    op.quantity * cd.price AS amount "
+        "FROM "
+        "    operations op "
+        "JOIN "
+        "    compact_discs cd ON op.compact_id = cd.compact_id "
+        "WHERE "
+        "    op.operation_date BETWEEN ?1 AND ?2 "
+        "ORDER BY "
+        "    op.operation_date, op.operation_id;";
+    
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return -1;
+    }
+    
+    sqlite3_bind_text(stmt, 1, startDate.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, endDate.c_str(), -1, SQLITE_TRANSIENT);
+    
+    return exportStatement(stmt, path, format, compress);
+}
+
+// Выгрузка каталога
+long long MusicStoreDB::exportCatalog(const std::string& path, ExportWriter::Format format, bool compress) {
+    std::string sql =
         "SELECT "
-        "    ?, "
-        "    ?, "
         "    cd.compact_id, "
-        "    COALESCE((SELECT SUM(quantity) FROM operations "
-        "              WHERE compact_id = cd.compact_id "
-        "              AND operation_type = 'поступление' "
-        "              AND operation_date BETWEEN ? AND ?), 0) AS received_quantity, "
-        "    COALESCE((SELECT SUM(quantity) FROM operations "
-        "              WHERE compact_id = cd.compact_id "
-        "              AND operation_type = 'продажа' "
-        "              AND operation_date BETWEEN ? AND ?), 0) AS sold_quantity "
+        "    cd.production_date, "
+        "    cd.company, "
+        "    cd.price, "
+        "    mw.work_id, "
+        "    mw.title, "
+        "    mw.author, "
+        "    mw.performer "
         "FROM "
-        "    compact_discs cd;";
-        
-    sqlite3_stmt* insertStmt;
-    rc = sqlite3_prepare_v2(db, insertSQL.c_str(), -1, &insertStmt, nullptr);
+        "    compact_discs cd "
+        "LEFT JOIN "
+        "    musical_works mw ON mw.compact_id = cd.compact_id "
+        "ORDER BY "
+        "    cd.compact_id, mw.work_id;";
+    
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        return;
+        return -1;
+    }
+    
+    return exportStatement(stmt, path, format, compress);
+}
+
+// Выгрузка отчета
+long long MusicStoreDB::exportReport(const std::string& report, const std::string& path,
+                                     ExportWriter::Format format, bool compress) {
+    std::string sql;
+    
+    if (report == "inventory") {
+        // Остатки поддерживаются триггерами в stock_levels
+        sql =
+            "SELECT "
+            "    cd.compact_id, "
+            "    cd.company, "
+            "    cd.production_date, "
+            "    cd.price, "
+            "    sl.received AS total_received, "
+            "    sl.sold AS total_sold, "
+            "    sl.remaining, "
+            "    sl.remaining * cd.price AS stock_value "
+            "FROM "
+            "    stock_levels sl "
+            "JOIN "
+            "    compact_discs cd ON sl.compact_id = cd.compact_id "
+            "ORDER BY "
+            "    sl.remaining DESC, sl.compact_id DESC;";
+    } else if (report == "performers") {
+        sql =
+            "SELECT "
+            "    mw.performer, "
+            "    SUM(op.quantity) AS total_sold "
+            "FROM "
+            "    operations op "
+            "JOIN "
+            "    musical_works mw ON op.compact_id = mw.compact_id "
+            "WHERE "
+            "    op.operation_type = 'продажа' "
+            "GROUP BY "
+            "    mw.performer "
+            "ORDER BY "
+            "    total_sold DESC;";
+    } else if (report == "authors") {
+        sql =
+            "SELECT "
+            "    mw.author, "
+            "    SUM(op.quantity) AS total_sold, "
+            "    COUNT(DISTINCT mw.work_id) AS works_count, "
+            "    SUM(op.quantity * cd.price) AS total_revenue "
+            "FROM "
+            "    operations op "
+            "JOIN "
+            "    musical_works mw ON op.compact_id = mw.compact_id "
+            "JOIN "
+            "    compact_discs cd ON op.compact_id = cd.compact_id "
+            "WHERE "
+            "    op.operation_type = 'продажа' "
+            "GROUP BY "
+            "    mw.author "
+            "ORDER BY "
+            "    total_sold DESC;";
+    } else {
+        std::cerr << "Неизвестный отчет: " << report << std::endl;
+        return -1;
     }
     
-    sqlite3_bind_text(insertStmt, 1, startDate.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(insertStmt, 2, endDate.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(insertStmt, 3, startDate.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(insertStmt, 4, endDate.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(insertStmt, 5, startDate.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(insertStmt, 6, endDate.c_str(), -1, SQLITE_STATIC);
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
     
-    rc = sqlite3_step(insertStmt);
-    if (rc != SQLITE_DONE) {
+    if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(insertStmt);
-        return;
+        return -1;
+    }
+    
+    return exportStatement(stmt, path, format, compress);
+}
+
+// Вставка одной записи импорта
+int MusicStoreDB::importRecord(ImportKind kind, const CsvParser::Record& record, const std::vector<size_t>& columns,
+                               sqlite3_stmt* insert, sqlite3_stmt* insertKey,
+                               std::unordered_map<std::string, int>& keys, std::string& error) {
+    for (size_t column : columns) {
+        if (column >= record.size()) {
+            error = "недостаточно полей";
+            return -1;
+        }
+    }
+    
+    const std::string& key = record[columns[0]];
+    const std::string& first = record[columns[1]];
+    const std::string& second = record[columns[2]];
+    const std::string& third = record[columns[3]];
+    
+    if (key.empty()) {
+        error = "пустой disc_key";
+        return -1;
+    }
+    
+    sqlite3_reset(insert);
+    sqlite3_clear_bindings(insert);
+    
+    if (kind == ImportKind::Discs) {
+        if (keys.count(key)) {
+            return 0;
+        }
+        
+        char* end = nullptr;
+        double price = std::strtod(third.c_str(), &end);
+        if (third.empty() || *end != '\0') {
+            error = "неверная цена: " + third;
+            return -1;
+        }
+        
+        sqlite3_bind_text(insert, 1, first.c_str(), static_cast<int>(first.size()), SQLITE_STATIC);
+        sqlite3_bind_text(insert, 2, second.c_str(), static_cast<int>(second.size()), SQLITE_STATIC);
+        sqlite3_bind_double(insert, 3, price);
+    } else {
+        auto it = keys.find(key);
+        if (it == keys.end()) {
+            error = "неизвестный disc_key: " + key;
+            return -1;
+        }
+        
+        if (kind == ImportKind::Works) {
+            sqlite3_bind_text(insert, 1, first.c_str(), static_cast<int>(first.size()), SQLITE_STATIC);
+            sqlite3_bind_text(insert, 2, second.c_str(), static_cast<int>(second.size()), SQLITE_STATIC);
+            sqlite3_bind_text(insert, 3, third.c_str(), static_cast<int>(third.size()), SQLITE_STATIC);
+            sqlite3_bind_int(insert, 4, it->second);
+        } else {
+            // Допускаются и английские названия типов операций
+            std::string type = second;
+            if (type == "receipt") {
+                type = "поступление";
+            } else if (type == "sale") {
+                type = "продажа";
+            }
+            
+            char* end = nullptr;
+            long quantity = std::strtol(third.c_str(), &end, 10);
+            if (third.empty() || *end != '\0') {
+                error = "неверное количество: " + third;
+                return -1;
+            }
+            
+            sqlite3_bind_text(insert, 1, first.c_str(), static_cast<int>(first.size()), SQLITE_STATIC);
+            sqlite3_bind_text(insert, 2, type.c_str(), static_cast<int>(type.size()), SQLITE_TRANSIENT);
+            sqlite3_bind_int(insert, 3, it->second);
+            sqlite3_bind_int64(insert, 4, quantity);
+        }
+    }
+    
+    if (sqlite3_step(insert) != SQLITE_DONE) {
+        error = sqlite3_errmsg(db);
+        return -1;
+    }
+    
+    if (kind == ImportKind::Discs) {
+        int compactId = static_cast<int>(sqlite3_last_insert_rowid(db));
+        sqlite3_reset(insertKey);
+        sqlite3_bind_text(insertKey, 1, key.c_str(), static_cast<int>(key.size()), SQLITE_STATIC);
+        sqlite3_bind_int(insertKey, 2, compactId);
+        if (sqlite3_step(insertKey) != SQLITE_DONE) {
+            error = sqlite3_errmsg(db);
+            return -1;
+        }
+        keys.emplace(key, compactId);
+    }
+    
+    return 1;
+}
+
+// Импорт CSV-файла
+ImportResult MusicStoreDB::importCsv(ImportKind kind, const std::string& path, unsigned threads,
+                                     int transactionRows) {
+    ImportResult result = {false, 0, 0, 0};
+    
+    if (!ensureWritable()) {
+        return result;
+    }
+    
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Не удалось открыть файл импорта: " << path << std::endl;
+        return result;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    
+    // Пропуск метки порядка байтов UTF-8
+    const char* pos = data.data();
+    const char* end = data.data() + data.size();
+    if (data.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        pos += 3;
+    }
+    
+    // Заголовок определяет порядок колонок в файле
+    CsvParser::Record header;
+    if (!CsvParser::parseRecord(pos, end, header)) {
+        std::cerr << "Файл импорта пуст: " << path << std::endl;
+        return result;
+    }
+    
+    std::vector<std::string> required;
+    std::string insertSql;
+    if (kind == ImportKind::Discs) {
+        required = {"disc_key", "production_date", "company", "price"};
+        insertSql = "INSERT INTO compact_discs (production_date, company, price) VALUES (?1, ?2, ?3);";
+    } else if (kind == ImportKind::Works) {
+        required = {"disc_key", "title", "author", "performer"};
+        insertSql = "INSERT INTO musical_works (title, author, performer, compact_id) VALUES (?1, ?2, ?3, ?4);";
+    } else {
+        required = {"disc_key", "operation_date", "operation_type", "quantity"};
+        insertSql =
+            "INSERT INTO operations (operation_date, operation_type, compact_id, quantity) "
+            "VALUES (?1, ?2, ?3, ?4);";
+    }
+    
+    std::vector<size_t> columns;
+    for (const auto& name : required) {
+        auto it = std::find(header.begin(), header.end(), name);
+        if (it == header.end()) {
+            std::cerr << "В файле импорта нет колонки: " << name << std::endl;
+            return result;
+        }
+        columns.push_back(static_cast<size_t>(it - header.begin()));
+    }
+    
+    // Известные внешние ключи
+    std::unordered_map<std::string, int> keys;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "SELECT external_key, compact_id FROM import_keys;", -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return result;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        keys.emplace(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), sqlite3_column_int(stmt, 1));
+    }
+    sqlite3_finalize(stmt);
+    
+    sqlite3_stmt* insert = nullptr;
+    sqlite3_stmt* insertKey = nullptr;
+    if (sqlite3_prepare_v2(db, insertSql.c_str(), -1, &insert, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "INSERT INTO import_keys (external_key, compact_id) VALUES (?1, ?2);",
+                           -1, &insertKey, nullptr) != SQLITE_OK) {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_finalize(insert);
+        return result;
     }
     
-    sqlite3_finalize(insertStmt);
+    // Разбор частей файла параллельно; вставка идет по порядку частей,
+    // поэтому первые части уже записываются, пока остальные разбираются
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t offset = static_cast<size_t>(pos - data.data());
+    auto chunks = CsvParser::splitChunks(pos, static_cast<size_t>(end - pos), threads);
+    
+    std::vector<std::future<std::vector<CsvParser::Record>>> parsed;
+    for (const auto& chunk : chunks) {
+        const char* chunkBegin = data.data() + offset + chunk.first;
+        const char* chunkEnd = data.data() + offset + chunk.second;
+        parsed.push_back(std::async(std::launch::async, CsvParser::parseChunk, chunkBegin, chunkEnd));
+    }
     
-    // Вывод отчета
-    std::string reportSQL = 
-        "SELECT "
-        "    cd.compact_id, "
-        "    cd.company, "
-        "    rr.received_quantity, "
-        "    rr.sold_quantity, "
-        "    rr.received_quantity - rr.sold_quantity AS remaining "
-        "FROM "
-        "    report_results rr "
-        "JOIN "
-        "    compact_discs cd ON rr.compact_id = cd.compact_id "
-        "WHERE "
-        "    rr.start_date = ? AND rr.end_date = ? "
-        "ORDER BY "
-        "    cd.compact_id;";
-        
-    sqlite3_stmt* reportStmt;
-    rc = sqlite3_prepare_v2(db, reportSQL.c_str(), -1, &reportStmt, nullptr);
+    // Внешняя транзакция (например, пакетного режима) не прерывается
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        return;
-    }
+    // Новые произведения попадают в полнотекстовый индекс одним запросом на пакет:
+    // построчный триггер FTS5 в несколько раз медленнее самой вставки. Триггер
+    // снимается один раз на весь импорт: каждое изменение схемы заставляет все
+    // соединения заново подготавливать запросы
+    bool deferFullText = kind == ImportKind::Works;
+    bool triggerDropped = false;
+    std::string lastWorkId = "0";
+    
+    auto beginBatch = [&]() {
+        if (ownTransaction && !beginTransaction()) {
+            return false;
+        }
+        if (deferFullText && !triggerDropped) {
+            std::vector<std::vector<std::string>> rows;
+            sqlite3_exec(db, "SELECT COALESCE(MAX(work_id), 0) FROM musical_works;", callback, &rows, nullptr);
+            lastWorkId = rows.empty() ? "0" : rows[0][0];
+            executeQuery("DROP TRIGGER IF EXISTS musical_works_fts_insert;");
+            triggerDropped = true;
+        }
+        return true;
+    };
     
-    sqlite3_bind_text(reportStmt, 1, startDate.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(reportStmt, 2, endDate.c_str(), -1, SQLITE_STATIC);
+    // Пока триггера нет, в индекс добавляются и произведения других соединений
+    auto indexNewWorks = [&]() {
+        executeQuery(
+            "INSERT INTO musical_works_fts(rowid, title, author, performer) "
+            "SELECT work_id, title, author, performer FROM musical_works "
+            "WHERE work_id > " + lastWorkId + ";");
+        std::vector<std::vector<std::string>> rows;
+        sqlite3_exec(db, "SELECT COALESCE(MAX(work_id), 0) FROM musical_works;", callback, &rows, nullptr);
+        if (!rows.empty()) {
+            lastWorkId = rows[0][0];
+        }
+    };
+    
+    // Триггер возвращается вне транзакции, если импорт не удалось завершить
+    auto restoreFullText = [&]() {
+        if (!triggerDropped) {
+            return;
+        }
+        if (inTransaction() && ownTransaction) {
+            rollbackTransaction();
+        }
+        // Если снятие триггера откатилось вместе с первым пакетом, индекс уже полон
+        std::vector<std::vector<std::string>> rows;
+        sqlite3_exec(db, "SELECT 1 FROM sqlite_master WHERE type = 'trigger' AND name = 'musical_works_fts_insert';",
+                     callback, &rows, nullptr);
+        if (rows.empty()) {
+            indexNewWorks();
+            executeQuery(FTS_INSERT_TRIGGER);
+        }
+        triggerDropped = false;
+    };
     
-    std::cout << "\n=== Отчет по операциям за период " << startDate << " - " << endDate << " ===" << std::endl;
+    auto endBatch = [&](bool last) {
+        updateCatalog([](CatalogCache& cache) { cache.invalidate(); });
+        if (triggerDropped) {
+            indexNewWorks();
+            if (last) {
+                executeQuery(FTS_INSERT_TRIGGER);
+            }
+        }
+        bool committed = ownTransaction ? commitTransaction() : true;
+        if (committed && last) {
+            triggerDropped = false;
+        }
+        return committed;
+    };
     
-    // Вывод заголовков
-    std::cout << std::left 
-              << std::setw(10) << "ID" << " | "
-              << std::setw(20) << "Компания" << " | "
-              << std::setw(15) << "Поступило" << " | "
-              << std::setw(15) << "Продано" << " | "
-              << std::setw(15) << "Остаток" << std::endl;
-    std::cout << std::string(85, '-') << std::endl;
+    // Без транзакции записи ушли бы в автофиксацию по одной, а снятие триггера -
+    // сразу в общую схему, поэтому импорт останавливается
+    auto abortImport = [&]() {
+        std::cerr << "Не удалось начать или зафиксировать транзакцию импорта: импорт остановлен" << std::endl;
+        sqlite3_finalize(insert);
+        sqlite3_finalize(insertKey);
+        restoreFullText();
+        return result;
+    };
     
-    while ((rc = sqlite3_step(reportStmt)) == SQLITE_ROW) {
-        std::cout << std::left 
-                  << std::setw(10) << sqlite3_column_int(reportStmt, 0) << " | "
-                  << std::setw(20) << sqlite3_column_text(reportStmt, 1) << " | "
-                  << std::setw(15) << sqlite3_column_int(reportStmt, 2) << " | "
-                  << std::setw(15) << sqlite3_column_int(reportStmt, 3) << " | "
-                  << std::setw(15) << sqlite3_column_int(reportStmt, 4) << std::endl;
+    if (!beginBatch()) {
+        return abortImport();
     }
     
-    if (rc != SQLITE_DONE) {
-        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+    const long long maxReported = 10;
+    long long recordNumber = 1;
+    int inTransaction = 0;
+    std::string error;
+    
+    for (auto& future : parsed) {
+        for (const auto& record : future.get()) {
+            recordNumber++;
+            
+            int status = importRecord(kind, record, columns, insert, insertKey, keys, error);
+            if (status > 0) {
+                result.imported++;
+            } else if (status == 0) {
+                result.skipped++;
+            } else if (++result.rejected <= maxReported) {
+                std::cerr << "Запись " << recordNumber << ": " << error << std::endl;
+            }
+            
+            if (ownTransaction && ++inTransaction >= transactionRows) {
+                if (!endBatch(false) || !beginBatch()) {
+                    return abortImport();
+                }
+                inTransaction = 0;
+            }
+        }
     }
     
-    sqlite3_finalize(reportStmt);
+    sqlite3_finalize(insert);
+    sqlite3_finalize(insertKey);
+    
+    result.completed = endBatch(true);
+    restoreFullText();
+    
+    std::cout << "Импорт завершен: добавлено " << result.imported
+              << ", пропущено " << result.skipped
+              << ", отклонено " << result.rejected << std::endl;
+    return result;
 }
 
 // Добавление нового компакт-диска
-void MusicStoreDB::addCompactDisc(const std::string& productionDate, const std::string& company, float price) {
+int MusicStoreDB::addCompactDisc(const std::string& productionDate, const std::string& company, float price) {
+    if (!ensureWritable()) {
+        return -1;
+    }
+    
     std::string sql = 
         "INSERT INTO compact_discs (production_date, company, price) "
         "VALUES (?, ?, ?);";
@@ -488,29 +2606,36 @@ void MusicStoreDB::addCompactDisc(const std::string& productionDate, const std::
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        return;
+        return -1;
     }
     
+    double storedPrice = decimalPrice(price);
     sqlite3_bind_text(stmt, 1, productionDate.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 2, company.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_double(stmt, 3, price);
+    sqlite3_bind_double(stmt, 3, storedPrice);
     
-    rc = sqlite3_step(stmt);
+    rc = stepWrite(stmt);
     if (rc != SQLITE_DONE) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
         sqlite3_finalize(stmt);
-        return;
+        return -1;
     }
     
     int compactId = sqlite3_last_insert_rowid(db);
     sqlite3_finalize(stmt);
+    updateCatalog([&](CatalogCache& cache) { cache.putDisc(compactId, productionDate, company, storedPrice); });
     
     std::cout << "Добавлен новый компакт-диск с ID: " << compactId << std::endl;
+    return compactId;
 }
 
 // Добавление музыкального произведения
-void MusicStoreDB::addMusicalWork(const std::string& title, const std::string& author, 
+int MusicStoreDB::addMusicalWork(const std::string& title, const std::string& author, 
                   const std::string& performer, int compactId) {
+    if (!ensureWritable()) {
+        return -1;
+    }
+    
     std::string sql = 
         "INSERT INTO musical_works (title, author, performer, compact_id) "
         "VALUES (?, ?, ?, ?);";
@@ -520,7 +2645,7 @@ void MusicStoreDB::addMusicalWork(const std::string& title, const std::string& a
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        return;
+        return -1;
     }
     
     sqlite3_bind_text(stmt, 1, title.c_str(), -1, SQLITE_STATIC);
@@ -528,59 +2653,171 @@ void MusicStoreDB::addMusicalWork(const std::string& title, const std::string& a
     sqlite3_bind_text(stmt, 3, performer.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 4, compactId);
     
-    rc = sqlite3_step(stmt);
+    rc = stepWrite(stmt);
     if (rc != SQLITE_DONE) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
         sqlite3_finalize(stmt);
-        return;
+        return -1;
     }
     
     int workId = sqlite3_last_insert_rowid(db);
     sqlite3_finalize(stmt);
+    updateCatalog([&](CatalogCache& cache) { cache.addWork(compactId, CatalogWork{workId, title, author, performer}); });
     
     std::cout << "Добавлено новое музыкальное произведение с ID: " << workId << std::endl;
+    return workId;
 }
 
 // Регистрация операции (поступление/продажа)
-void MusicStoreDB::registerOperation(const std::string& operationType, int compactId, int quantity) {
+int MusicStoreDB::registerOperation(const std::string& operationType, int compactId, int quantity,
+                                    const std::string& operationDate) {
+    if (!ensureWritable()) {
+        return -1;
+    }
+    
     // Получение текущей даты
     std::time_t t = std::time(nullptr);
     std::tm* now = std::localtime(&t);
     char dateStr[11];
     std::strftime(dateStr, sizeof(dateStr), "%Y-%m-%d", now);
+    std::string_view date = operationDate.empty() ? std::string_view(dateStr) : std::string_view(operationDate);
     
-    std::string sql = 
-        "INSERT INTO operations (operation_date, operation_type, compact_id, quantity) "
-        "VALUES (?, ?, ?, ?);";
-        
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    Command<INSERT_OPERATION_SQL, std::string_view, std::string_view, int, int> insert(statements);
+    if (!insert.bind(date, operationType, compactId, quantity).execute(busyPolicy.writeRetries, [this]() { writeRetries++; })) {
+        return -1;
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        return;
+    int operationId = sqlite3_last_insert_rowid(db);
+    
+    std::cout << "Зарегистрирована операция (" << operationType << ") с ID: " << operationId << std::endl;
+    return operationId;
+}
+
+// Пакетная операция над выбранными компакт-дисками
+long long MusicStoreDB::runBulkOperation(const DiscSelection& selection, bool dryRun,
+                                         const std::function<std::optional<long long>(int)>& count,
+                                         const std::function<bool(int)>& apply) {
+    if (!selection.all && selection.compactIds.empty() && selection.company.empty()) {
+        std::cerr << "Не задан выбор компакт-дисков (весь каталог выбирается явно)" << std::endl;
+        return -1;
+    }
+    if ((!dryRun && !ensureWritable()) || !executeQuery(SELECTED_DISCS_CREATE_SQL)) {
+        return -1;
     }
     
-    sqlite3_bind_text(stmt, 1, dateStr, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, operationType.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 3, compactId);
-    sqlite3_bind_int(stmt, 4, quantity);
+    // Внешняя транзакция (например, пакетного режима) не прерывается
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownTransaction && !(dryRun ? executeQuery("BEGIN;") : beginTransaction())) {
+        return -1;
+    }
     
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE) {
-        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_finalize(stmt);
-        return;
+    int useIds = selection.compactIds.empty() ? 0 : 1;
+    long long affected = -1;
+    if (!useIds || selectDiscs(selection.compactIds)) {
+        if (dryRun) {
+            affected = count(useIds).value_or(-1);
+        } else if (apply(useIds)) {
+            affected = sqlite3_changes64(db);
+        }
     }
+    Command<SELECTED_DISCS_CLEAR_SQL>(statements).bind().execute();
     
-    int operationId = sqlite3_last_insert_rowid(db);
-    sqlite3_finalize(stmt);
+    if (ownTransaction) {
+        bool committed = affected >= 0 && (dryRun ? executeQuery("COMMIT;") : commitTransaction());
+        if (!committed) {
+            rollbackTransaction();
+            return -1;
+        }
+    }
     
-    std::cout << "Зарегистрирована операция (" << operationType << ") с ID: " << operationId << std::endl;
+    // Кеш каталога перечитывается целиком: изменений может быть много
+    if (!dryRun && affected > 0) {
+        updateCatalog([](CatalogCache& cache) { cache.invalidate(); });
+    }
+    return affected;
+}
+
+// Изменение цены выбранных компакт-дисков
+long long MusicStoreDB::repriceDiscs(const DiscSelection& selection, double percent, bool dryRun) {
+    if (percent <= -100.0) {
+        std::cerr << "Снижение цены должно быть меньше 100%" << std::endl;
+        return -1;
+    }
+    
+    long long affected = runBulkOperation(
+        selection, dryRun,
+        [&](int useIds) {
+            auto row = Query<BULK_COUNT_SQL, std::tuple<long long>, int, std::string_view>(statements)
+                .bind(useIds, selection.company).fetchOne();
+            return row ? std::optional<long long>(std::get<0>(*row)) : std::nullopt;
+        },
+        [&](int useIds) {
+            return Command<BULK_REPRICE_SQL, int, std::string_view, double>(statements)
+                .bind(useIds, selection.company, percent)
+                .execute(busyPolicy.writeRetries, [this]() { writeRetries++; });
+        });
+    
+    if (affected >= 0) {
+        std::cout << (dryRun ? "Будет изменена цена компакт-дисков: " : "Изменена цена компакт-дисков: ")
+                  << affected << std::endl;
+    }
+    return affected;
+}
+
+// Смена компании выбранных компакт-дисков
+long long MusicStoreDB::reassignCompany(const DiscSelection& selection, const std::string& company, bool dryRun) {
+    if (company.empty()) {
+        std::cerr << "Не указана новая компания" << std::endl;
+        return -1;
+    }
+    
+    long long affected = runBulkOperation(
+        selection, dryRun,
+        [&](int useIds) {
+            auto row = Query<BULK_COUNT_SQL, std::tuple<long long>, int, std::string_view>(statements)
+                .bind(useIds, selection.company).fetchOne();
+            return row ? std::optional<long long>(std::get<0>(*row)) : std::nullopt;
+        },
+        [&](int useIds) {
+            return Command<BULK_REASSIGN_SQL, int, std::string_view, std::string_view>(statements)
+                .bind(useIds, selection.company, company)
+                .execute(busyPolicy.writeRetries, [this]() { writeRetries++; });
+        });
+    
+    if (affected >= 0) {
+        std::cout << (dryRun ? "Будет изменена компания компакт-дисков: " : "Изменена компания компакт-дисков: ")
+                  << affected << std::endl;
+    }
+    return affected;
+}
+
+// Удаление компакт-дисков без операций
+long long MusicStoreDB::deleteUnsoldDiscs(const DiscSelection& selection, bool dryRun) {
+    long long affected = runBulkOperation(
+        selection, dryRun,
+        [&](int useIds) {
+            auto row = Query<BULK_COUNT_UNSOLD_SQL, std::tuple<long long>, int, std::string_view>(statements)
+                .bind(useIds, selection.company).fetchOne();
+            return row ? std::optional<long long>(std::get<0>(*row)) : std::nullopt;
+        },
+        [&](int useIds) {
+            return Command<BULK_DELETE_UNSOLD_SQL, int, std::string_view>(statements)
+                .bind(useIds, selection.company)
+                .execute(busyPolicy.writeRetries, [this]() { writeRetries++; });
+        });
+    
+    if (affected >= 0) {
+        std::cout << (dryRun ? "Будет удалено компакт-дисков: " : "Удалено компакт-дисков: ") << affected << std::endl;
+    }
+    return affected;
 }
 
 // Обновление информации о компакт-диске
-void MusicStoreDB::updateCompactDisc(int compactId, const std::string& company, float price) {
+bool MusicStoreDB::updateCompactDisc(int compactId, const std::string& company, float price) {
+    if (!ensureWritable()) {
+        return false;
+    }
+    
     std::string sql = 
         "UPDATE compact_discs SET company = ?, price = ? WHERE compact_id = ?;";
         
@@ -589,27 +2826,34 @@ void MusicStoreDB::updateCompactDisc(int compactId, const std::string& company,
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        return;
+        return false;
     }
     
+    double storedPrice = decimalPrice(price);
     sqlite3_bind_text(stmt, 1, company.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_double(stmt, 2, price);
+    sqlite3_bind_double(stmt, 2, storedPrice);
     sqlite3_bind_int(stmt, 3, compactId);
     
-    rc = sqlite3_step(stmt);
+    rc = stepWrite(stmt);
     if (rc != SQLITE_DONE) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
         sqlite3_finalize(stmt);
-        return;
+        return false;
     }
     
     sqlite3_finalize(stmt);
+    updateCatalog([&](CatalogCache& cache) { cache.updateDisc(compactId, company, storedPrice); });
     
     std::cout << "Обновлена информация о компакт-диске с ID: " << compactId << std::endl;
+    return true;
 }
 
 // Удаление компакт-диска
-void MusicStoreDB::deleteCompactDisc(int compactId) {
+bool MusicStoreDB::deleteCompactDisc(int compactId) {
+    if (!ensureWritable()) {
+        return false;
+    }
+    
     std::string sql = "DELETE FROM compact_discs WHERE compact_id = ?;";
         
     sqlite3_stmt* stmt;
@@ -617,110 +2861,80 @@ void MusicStoreDB::deleteCompactDisc(int compactId) {
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        return;
+        return false;
     }
     
     sqlite3_bind_int(stmt, 1, compactId);
     
-    rc = sqlite3_step(stmt);
+    rc = stepWrite(stmt);
     if (rc != SQLITE_DONE) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
         sqlite3_finalize(stmt);
-        return;
+        return false;
     }
     
     sqlite3_finalize(stmt);
+    updateCatalog([&](CatalogCache& cache) { cache.removeDisc(compactId); });
     
     std::cout << "Удален компакт-диск с ID: " << compactId << std::endl;
+    return true;
 }
 
 // Информация о самом популярном компакт-диске
 void MusicStoreDB::showMostPopularCompact() {
-    headers=true;
-    std::string sql = 
-        "    SELECT "
-        "        compact_id, "
-        "        SUM(quantity) AS total_sold "
-        "    FROM "
-        "        operations "
-        "    WHERE "
-        "        operation_type = 'продажа' "
-        "    GROUP BY "
-        "        compact_id "
-        "    ORDER BY "
-        "        total_sold DESC "
-        "    LIMIT 1 ;";
-        
-    std::cout << "\n=== Самый популярный компакт-диск ===" << std::endl;
-    
-    // Проверка наличия данных о продажах
-    std::string checkSQL = 
-        "SELECT COUNT(*) FROM operations WHERE operation_type = 'продажа';";
-    
-    std::vector<std::vector<std::string>> checkResults;
-    char* checkErrMsg = nullptr;
-    int checkRc = sqlite3_exec(db, checkSQL.c_str(), callback, &checkResults, &checkErrMsg);
+    printTitle("Самый популярный компакт-диск");
     
-    if (checkRc != SQLITE_OK) {
-        std::cerr << "SQL error при проверке наличия продаж: " << checkErrMsg << std::endl;
-        sqlite3_free(checkErrMsg);
-        return;
-    }
-    
-    // Если нет продаж, выводим сообщение
-    if (checkResults.size() > 0 && checkResults[0].size() > 0 && checkResults[0][0] == "0") {
+    auto top = Query<MOST_POPULAR_COMPACT_SQL, std::tuple<int, long long>>(statements).bind().fetchOne();
+    if (!top) {
         std::cout << "Нет данных о продажах компакт-дисков." << std::endl;
         return;
     }
     
-    // Сброс статуса вывода заголовков для printCallback
-    // Используем отдельный запрос для сброса
-    
-    // Выполнение основного запроса
-    char* errMsg = nullptr;
-    int rc = sqlite3_exec(db, sql.c_str(), printCallback, nullptr, &errMsg);
+    // Компания, цена и произведения берутся из кеша каталога
+    auto [compactId, totalSold] = *top;
+    std::shared_ptr<const CatalogSnapshot> snapshot = catalogSnapshot();
+    CatalogDisc loaded;
+    const CatalogDisc* disc = findDisc(snapshot.get(), compactId, loaded);
+    
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
+    table.setHeader({"compact_id", "company", "price", "total_sold"});
+    table.addRow({
+        std::to_string(compactId),
+        disc ? disc->company : "",
+        disc ? TableWriter::formatNumber(disc->price) : "",
+        std::to_string(totalSold)
+    });
+    
+    TableWriter worksTable(outputFormat, arena.resource());
+    worksTable.setHeader({"work_id", "title", "author", "performer"});
+    if (disc) {
+        for (const auto& work : disc->works) {
+            worksTable.addRow({std::to_string(work.workId), work.title, work.author, work.performer});
+        }
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
+    // В JSON обе таблицы выводятся одним документом
+    if (outputFormat == TableWriter::Format::Json) {
+        auto array = [](const TableWriter& writer) {
+            std::string text = writer.render();
+            text.pop_back();
+            return text;
+        };
+        std::cout << "{\"disc\": " << array(table) << ", \"works\": " << array(worksTable) << "}" << std::endl;
         return;
     }
-    // Дополнительный вывод произведений на этом компакт-диске
-    if (checkResults.size() > 0 && checkResults[0].size() > 0 && checkResults[0][0] != "0") {
-        std::string compactIdSQL = 
-            "SELECT compact_id FROM operations "
-            "WHERE operation_type = 'продажа' "
-            "GROUP BY compact_id "
-            "ORDER BY SUM(quantity) DESC "
-            "LIMIT 1;";
-            
-        std::vector<std::vector<std::string>> compactIdResults;
-        sqlite3_exec(db, compactIdSQL.c_str(), callback, &compactIdResults, nullptr);
-        
-        if (compactIdResults.size() > 0 && compactIdResults[0].size() > 0) {
-            headers=true;
-            std::string worksSql = 
-                "SELECT work_id, title, author, performer "
-                "FROM musical_works "
-                "WHERE compact_id = " + compactIdResults[0][0] + ";";
-                
-            std::cout << "\n=== Музыкальные произведения на самом популярном компакт-диске ===" << std::endl;
-            
-            // Сброс заголовков
-            
-            char* worksErrMsg = nullptr;
-            int worksRc = sqlite3_exec(db, worksSql.c_str(), printCallback, nullptr, &worksErrMsg);
-            
-            if (worksRc != SQLITE_OK) {
-                std::cerr << "SQL error при получении произведений: " << worksErrMsg << std::endl;
-                sqlite3_free(worksErrMsg);
-            }
-        }
+    
+    table.write(std::cout);
+    if (!disc) {
+        return;
     }
+    
+    printTitle("Музыкальные произведения на самом популярном компакт-диске");
+    worksTable.write(std::cout);
 }
 // Реализация метода showMostPopularPerformer
 void MusicStoreDB::showMostPopularPerformer() {
-    headers=true;
     std::string sql = 
         "WITH PerformerSales AS ( "
         "    SELECT "
@@ -751,20 +2965,24 @@ void MusicStoreDB::showMostPopularPerformer() {
         "JOIN "
         "    compact_discs cd ON mw.compact_id = cd.compact_id;";
         
-    std::cout << "\n=== Самый популярный исполнитель ===" << std::endl;
+    printTitle("Самый популярный исполнитель");
     
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
     char* errMsg = nullptr;
-    int rc = sqlite3_exec(db, sql.c_str(), printCallback, nullptr, &errMsg);
+    int rc = sqlite3_exec(db, sql.c_str(), tableCallback, &table, &errMsg);
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << errMsg << std::endl;
         sqlite3_free(errMsg);
+        return;
     }
+    
+    table.write(std::cout);
 }
 
 // Реализация метода showAuthorSales
 void MusicStoreDB::showAuthorSales() {
-    headers=true;
     std::string sql = 
         "SELECT "
         "    mw.author, "
@@ -784,66 +3002,331 @@ void MusicStoreDB::showAuthorSales() {
         "ORDER BY "
         "    total_sold DESC;";
         
-    std::cout << "\n=== Продажи по авторам ===" << std::endl;
+    printTitle("Продажи по авторам");
     
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
     char* errMsg = nullptr;
-    int rc = sqlite3_exec(db, sql.c_str(), printCallback, nullptr, &errMsg);
+    int rc = sqlite3_exec(db, sql.c_str(), tableCallback, &table, &errMsg);
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << errMsg << std::endl;
         sqlite3_free(errMsg);
+        return;
     }
+    
+    table.write(std::cout);
 }
 
-// Реализация метода getCompactSalesInfo
-void MusicStoreDB::getCompactSalesInfo(int compactId, const std::string& startDate, const std::string& endDate) {
-    // Этот метод похож на showCompactSales, но с другим форматированием вывода
-    // для обычных пользователей
-    headers=true;
-    std::string sql = 
-        "SELECT "
-        "    cd.compact_id, "
-        "    cd.company, "
-        "    cd.production_date, "
-        "    cd.price, "
-        "    SUM(op.quantity) AS quantity_sold, "
-        "    SUM(op.quantity * cd.price) AS total_value "
-        "FROM "
-        "    operations op "
-        "JOIN "
-        "    compact_discs cd ON op.compact_id = cd.compact_id "
-        "WHERE "
-        "    op.operation_type = 'продажа' "
-        "    AND op.compact_id = ? "
-        "    AND op.operation_date BETWEEN ? AND ? "
-        "GROUP BY "
-        "    cd.compact_id;";
+// Продажи по исполнителям
+std::vector<PerformerSales> MusicStoreDB::getPerformerSales() {
+    return Query<PERFORMER_SALES_SQL, std::tuple<std::string, long long>>(statements)
+        .bind().fetchAll<PerformerSales>();
+}
+
+// Продажи по авторам
+std::vector<AuthorSales> MusicStoreDB::getAuthorSales() {
+    return Query<AUTHOR_SALES_SQL, std::tuple<std::string, long long, long long, double>>(statements)
+        .bind().fetchAll<AuthorSales>();
+}
+
+// Сводная стоимость запасов
+InventoryValue MusicStoreDB::getInventoryValue() {
+    auto row = Query<INVENTORY_VALUE_SQL, std::tuple<long long, long long, long long, long long, double>>(statements)
+        .bind().fetchOne<InventoryValue>();
+    return row ? *row : InventoryValue{0, 0, 0, 0, 0.0};
+}
+
+// Текущий остаток компакт-диска
+long long MusicStoreDB::getStockLevel(int compactId) {
+    auto row = Query<STOCK_LEVEL_SQL, std::tuple<long long>, int>(statements).bind(compactId).fetchOne();
+    return row ? std::get<0>(*row) : -1;
+}
+
+// Остатки всех компакт-дисков
+std::vector<StockLevel> MusicStoreDB::getStockLevels() {
+    return Query<STOCK_LEVELS_SQL, std::tuple<int, long long>>(statements).bind().fetchAll<StockLevel>();
+}
+
+// Поступления и продажи компакт-диска за период
+PeriodTotals MusicStoreDB::getPeriodTotals(int compactId, const std::string& startDate, const std::string& endDate) {
+    auto row = Query<PERIOD_TOTALS_SQL, std::tuple<long long, long long>, int, std::string_view, std::string_view>(statements)
+        .bind(compactId, startDate, endDate).fetchOne<PeriodTotals>();
+    return row ? *row : PeriodTotals{0, 0};
+}
+
+// Продажи выбранных компакт-дисков
+DiscSalesReport MusicStoreDB::collectDiscSales(const std::shared_ptr<const CatalogSnapshot>& snapshot,
+                                               const std::vector<int>& compactIds, const std::string& startDate,
+                                               const std::string& endDate) {
+    DiscSalesReport report{{}, 0, 0.0};
+    if (!snapshot || compactIds.empty() || !executeQuery(SELECTED_DISCS_CREATE_SQL)) {
+        return report;
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    // Временная таблица и запрос - в одной транзакции: отчет согласован, а вставки не фиксируются по одной
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownTransaction) {
+        executeQuery("BEGIN;");
+    }
     
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+    selectDiscs(compactIds);
+    
+    Query<SELECTED_DISCS_SALES_SQL, std::tuple<int, long long>, std::string_view, std::string_view>(statements)
+        .bind(startDate, endDate)
+        .forEach([&](int compactId, long long sold) {
+            // Компания, дата и цена - из кеша каталога
+            CatalogDisc loaded;
+            const CatalogDisc* disc = findDisc(snapshot.get(), compactId, loaded);
+            if (!disc) {
+                return;
+            }
+            double revenue = sold * disc->price;
+            report.discs.push_back(DiscSales{compactId, disc->company, disc->productionDate, disc->price, sold, revenue});
+            report.totalSold += sold;
+            report.totalRevenue += revenue;
+        });
+    
+    Command<SELECTED_DISCS_CLEAR_SQL>(statements).bind().execute();
+    if (ownTransaction) {
+        executeQuery("COMMIT;");
+    }
+    return report;
+}
+
+// Заполнение временной таблицы выбранных дисков
+bool MusicStoreDB::selectDiscs(const std::vector<int>& compactIds) {
+    if (!Command<SELECTED_DISCS_CLEAR_SQL>(statements).bind().execute()) {
+        return false;
+    }
+    
+    Command<SELECTED_DISC_INSERT_SQL, int> insert(statements);
+    for (int compactId : compactIds) {
+        if (!insert.bind(compactId).execute()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Продажи нескольких компакт-дисков
+DiscSalesReport MusicStoreDB::getDiscSales(const std::vector<int>& compactIds, const std::string& startDate,
+                                           const std::string& endDate) {
+    return collectDiscSales(catalogSnapshot(), compactIds, startDate, endDate);
+}
+
+// Продажи компакт-дисков компании
+DiscSalesReport MusicStoreDB::getCompanySales(const std::string& company, const std::string& startDate,
+                                              const std::string& endDate) {
+    std::shared_ptr<const CatalogSnapshot> snapshot = catalogSnapshot();
+    if (!snapshot) {
+        return DiscSalesReport{{}, 0, 0.0};
+    }
+    // Тот же снимок и для отбора дисков, и для отчета: версия каталога проверяется один раз
+    return collectDiscSales(snapshot, snapshot->discsOf(company), startDate, endDate);
+}
+
+// Вывод отчета по нескольким компакт-дискам
+void MusicStoreDB::printDiscSales(const std::string& title, const DiscSalesReport& report) {
+    printTitle(title);
+    
+    ReportArena arena;
+    TableWriter table(outputFormat, arena.resource());
+    table.setHeader({"ID", "Компания", "Дата выпуска", "Цена", "Кол-во продано", "Общая сумма"});
+    for (const auto& disc : report.discs) {
+        table.addRow({
+            std::to_string(disc.compactId),
+            disc.company,
+            disc.productionDate,
+            TableWriter::formatNumber(disc.price),
+            std::to_string(disc.sold),
+            TableWriter::formatNumber(disc.revenue)
+        });
+    }
+    table.addRow({"Итого", "", "", "", std::to_string(report.totalSold), TableWriter::formatNumber(report.totalRevenue)});
+    table.write(std::cout);
+}
+
+// Вывод продаж нескольких компакт-дисков
+void MusicStoreDB::showDiscSales(const std::vector<int>& compactIds, const std::string& startDate,
+                                 const std::string& endDate) {
+    printDiscSales("Продажи компакт-дисков (" + std::to_string(compactIds.size()) + ") за период " + startDate +
+                       " - " + endDate,
+                   getDiscSales(compactIds, startDate, endDate));
+}
+
+// Вывод продаж компакт-дисков компании
+void MusicStoreDB::showCompanySales(const std::string& company, const std::string& startDate,
+                                    const std::string& endDate) {
+    printDiscSales("Продажи компакт-дисков компании " + company + " за период " + startDate + " - " + endDate,
+                   getCompanySales(company, startDate, endDate));
+}
+
+// Проверка изменений каталога другими соединениями
+void MusicStoreDB::checkCatalogVersion() {
+    // Другие соединения не меняют снимок открытой транзакции
+    bool inTransaction = !sqlite3_get_autocommit(db);
+    if (inTransaction && catalogChecked) {
         return;
     }
+    catalogChecked = inTransaction;
     
-    sqlite3_bind_int(stmt, 1, compactId);
-    sqlite3_bind_text(stmt, 2, startDate.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, endDate.c_str(), -1, SQLITE_STATIC);
-    
-    std::cout << "\n=== Информация о продажах компакт-диска #" << compactId << " за период " 
-              << startDate << " - " << endDate << " ===" << std::endl;
-    
-    rc = sqlite3_step(stmt);
-    if (rc == SQLITE_ROW) {
-        std::cout << "Компания-производитель: " << sqlite3_column_text(stmt, 1) << std::endl;
-        std::cout << "Дата производства: " << sqlite3_column_text(stmt, 2) << std::endl;
-        std::cout << "Цена: " << sqlite3_column_double(stmt, 3) << std::endl;
-        std::cout << "Количество проданных экземпляров: " << sqlite3_column_int(stmt, 4) << std::endl;
-        std::cout << "Общая сумма продаж: " << sqlite3_column_double(stmt, 5) << std::endl;
+    auto dataVersion = Query<DATA_VERSION_SQL, std::tuple<long long>>(statements).bind().fetchOne();
+    if (!dataVersion || std::get<0>(*dataVersion) == catalogDataVersion) {
+        return;
+    }
+    catalogDataVersion = std::get<0>(*dataVersion);
+    
+    // Без счетчика (копия со старой схемой) кеш сбрасывается при любом изменении базы
+    long long version = -1;
+    if (tableExists("catalog_version")) {
+        auto row = Query<CATALOG_VERSION_SQL, std::tuple<long long>>(statements).bind().fetchOne();
+        version = row ? std::get<0>(*row) : -1;
+    }
+    if (version < 0 || version != catalogVersion) {
+        catalogVersion = version;
+        catalog->invalidate();
+    }
+}
+
+// Изменение кеша каталога
+void MusicStoreDB::updateCatalog(const std::function<void(CatalogCache&)>& change) {
+    if (sqlite3_get_autocommit(db)) {
+        change(*catalog);
     } else {
-        std::cout << "Нет данных о продажах для указанного компакт-диска за указанный период." << std::endl;
+        catalogDirty = true;
+    }
+}
+
+// Компакт-диск из кеша каталога или из базы
+const CatalogDisc* MusicStoreDB::findDisc(const CatalogSnapshot* snapshot, int compactId, CatalogDisc& loaded) {
+    const CatalogDisc* cached = snapshot ? snapshot->find(compactId) : nullptr;
+    if (cached) {
+        return cached;
     }
     
-    sqlite3_finalize(stmt);
+    auto row = Query<CATALOG_DISC_SQL, std::tuple<std::string, std::string, double>, int>(statements)
+                   .bind(compactId).fetchOne();
+    if (!row) {
+        return nullptr;
+    }
+    
+    loaded = CatalogDisc{compactId, std::get<0>(*row), std::get<1>(*row), std::get<2>(*row), {}};
+    Query<CATALOG_DISC_WORKS_SQL, std::tuple<int, std::string, std::string, std::string>, int>(statements)
+        .bind(compactId)
+        .forEach([&](int workId, std::string title, std::string author, std::string performer) {
+            loaded.works.push_back(CatalogWork{workId, std::move(title), std::move(author), std::move(performer)});
+        });
+    
+    // Диск есть в базе, но не в кеше: кеш устарел и перечитывается при следующем обращении
+    if (snapshot && sqlite3_get_autocommit(db)) {
+        catalog->invalidate();
+    }
+    return &loaded;
+}
+
+// Текущий снимок каталога
+std::shared_ptr<const CatalogSnapshot> MusicStoreDB::catalogSnapshot() {
+    checkCatalogVersion();
+    
+    // Незафиксированные изменения каталога видны только этому соединению
+    bool privateSnapshot = catalogDirty && !sqlite3_get_autocommit(db);
+    if (catalogDirty && !privateSnapshot) {
+        catalogDirty = false;
+        catalog->invalidate();
+    }
+    
+    if (!privateSnapshot) {
+        std::shared_ptr<const CatalogSnapshot> snapshot = catalog->snapshot();
+        if (snapshot) {
+            return snapshot;
+        }
+    }
+    
+    // Диски и произведения читаются в одной транзакции, чтобы снимок был согласованным
+    uint64_t generation = catalog->currentGeneration();
+    auto loaded = std::make_shared<CatalogSnapshot>();
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownTransaction) {
+        executeQuery("BEGIN;");
+    }
+    
+    bool ok =
+        Query<CATALOG_DISCS_SQL, std::tuple<int, std::string, std::string, double>>(statements).bind().forEach(
+            [&](int compactId, std::string productionDate, std::string company, double price) {
+                loaded->addDisc(CatalogDisc{compactId, std::move(productionDate), std::move(company), price, {}});
+            }) &&
+        Query<CATALOG_WORKS_SQL, std::tuple<int, int, std::string, std::string, std::string>>(statements).bind().forEach(
+            [&](int compactId, int workId, std::string title, std::string author, std::string performer) {
+                loaded->addWork(compactId, CatalogWork{workId, std::move(title), std::move(author), std::move(performer)});
+            });
+    
+    if (ownTransaction) {
+        executeQuery("COMMIT;");
+    }
+    
+    if (!ok) {
+        return nullptr;
+    }
+    
+    // Устаревший снимок не публикуется, но для этого отчета он согласован
+    if (!privateSnapshot) {
+        catalog->publish(loaded, generation);
+    }
+    return loaded;
+}
+
+// Загрузка аналитического снимка
+bool MusicStoreDB::loadAnalyticsSnapshot(AnalyticsSnapshot& snapshot) {
+    // Чтение в одной транзакции, чтобы снимок был согласованным
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownTransaction) {
+        executeQuery("BEGIN;");
+    }
+    
+    bool loaded =
+        Query<SNAPSHOT_DISCS_SQL, std::tuple<int, double>>(db).bind().forEach(
+            [&](int compactId, double price) { snapshot.addDisc(compactId, price); }) &&
+        Query<SNAPSHOT_WORKS_SQL, std::tuple<int, int, std::string, std::string>>(db).bind().forEach(
+            [&](int workId, int compactId, const std::string& author, const std::string& performer) {
+                snapshot.addWork(workId, compactId, author, performer);
+            }) &&
+        Query<SNAPSHOT_OPERATIONS_SQL, std::tuple<int, int, bool, int>>(db).bind().forEach(
+            [&](int compactId, int day, bool sale, int quantity) {
+                snapshot.addOperation(compactId, day, sale, quantity);
+            });
+    
+    if (ownTransaction) {
+        executeQuery("COMMIT;");
+    }
+    
+    if (loaded) {
+        snapshot.build();
+    }
+    return loaded;
+}
+
+// Реализация метода getCompactSalesInfo
+void MusicStoreDB::getCompactSalesInfo(int compactId, const std::string& startDate, const std::string& endDate) {
+    // Этот метод похож на showCompactSales, но с другим форматированием вывода
+    // для обычных пользователей
+    auto sales = Query<COMPACT_PERIOD_SALES_SQL, std::tuple<long long, long long>, int, std::string_view,
+                       std::string_view>(statements).bind(compactId, startDate, endDate).fetchOne();
+    
+    printTitle("Информация о продажах компакт-диска #" + std::to_string(compactId) + " за период " +
+               startDate + " - " + endDate);
+    
+    std::shared_ptr<const CatalogSnapshot> snapshot = catalogSnapshot();
+    CatalogDisc loaded;
+    const CatalogDisc* disc = findDisc(snapshot.get(), compactId, loaded);
+    if (sales && std::get<0>(*sales) > 0 && disc) {
+        long long sold = std::get<1>(*sales);
+        std::cout << "Компания-производитель: " << disc->company << std::endl;
+        std::cout << "Дата производства: " << disc->productionDate << std::endl;
+        std::cout << "Цена: " << disc->price << std::endl;
+        std::cout << "Количество проданных экземпляров: " << sold << std::endl;
+        std::cout << "Общая сумма продаж: " << sold * disc->price << std::endl;
+    } else {
+        std::cout << "Нет данных о продажах для указанного компакт-диска за указанный период." << std::endl;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,292 @@
+#include "../include/PasswordHash.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace {
+
+const char* PREFIX = "pbkdf2-sha256$";
+
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+// Потоковое вычисление SHA-256
+class Sha256 {
+private:
+    uint32_t state[8];
+    uint8_t block[64];
+    size_t blockSize;
+    uint64_t totalBytes;
+    
+    void compress(const uint8_t* data) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (uint32_t(data[4 * i]) << 24) | (uint32_t(data[4 * i + 1]) << 16) |
+                   (uint32_t(data[4 * i + 2]) << 8) | uint32_t(data[4 * i + 3]);
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+
+public:
+    Sha256() : state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+               blockSize(0), totalBytes(0) {}
+    
+    void update(std::string_view data) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+        size_t size = data.size();
+        totalBytes += size;
+        
+        while (size > 0) {
+            size_t take = std::min(size, sizeof(block) - blockSize);
+            std::memcpy(block + blockSize, bytes, take);
+            blockSize += take;
+            bytes += take;
+            size -= take;
+            if (blockSize == sizeof(block)) {
+                compress(block);
+                blockSize = 0;
+            }
+        }
+    }
+    
+    PasswordHash::Digest finish() {
+        uint64_t bits = totalBytes * 8;
+        uint8_t padding[72] = {0x80};
+        size_t padSize = (blockSize < 56 ? 56 : 120) - blockSize;
+        for (int i = 0; i < 8; i++) {
+            padding[padSize + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+        }
+        update(std::string_view(reinterpret_cast<const char*>(padding), padSize + 8));
+        
+        PasswordHash::Digest digest;
+        for (int i = 0; i < 8; i++) {
+            digest[4 * i] = static_cast<uint8_t>(state[i] >> 24);
+            digest[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16);
+            digest[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8);
+            digest[4 * i + 3] = static_cast<uint8_t>(state[i]);
+        }
+        return digest;
+    }
+};
+
+std::string_view asBytes(const PasswordHash::Digest& digest) {
+    return std::string_view(reinterpret_cast<const char*>(digest.data()), digest.size());
+}
+
+// HMAC-SHA256 с заранее обработанными блоками ключа: для PBKDF2 это вдвое меньше сжатий на итерацию
+class Hmac {
+private:
+    Sha256 inner;
+    Sha256 outer;
+
+public:
+    explicit Hmac(std::string_view key) {
+        PasswordHash::Digest keyDigest;
+        if (key.size() > 64) {
+            keyDigest = PasswordHash::sha256(key);
+            key = asBytes(keyDigest);
+        }
+        
+        char innerPad[64];
+        char outerPad[64];
+        for (size_t i = 0; i < 64; i++) {
+            char byte = i < key.size() ? key[i] : 0;
+            innerPad[i] = static_cast<char>(byte ^ 0x36);
+            outerPad[i] = static_cast<char>(byte ^ 0x5c);
+        }
+        inner.update(std::string_view(innerPad, 64));
+        outer.update(std::string_view(outerPad, 64));
+    }
+    
+    PasswordHash::Digest compute(std::string_view message) const {
+        Sha256 innerHash = inner;
+        innerHash.update(message);
+        PasswordHash::Digest innerDigest = innerHash.finish();
+        
+        Sha256 outerHash = outer;
+        outerHash.update(asBytes(innerDigest));
+        return outerHash.finish();
+    }
+};
+
+// Разбор шестнадцатеричной строки
+bool fromHex(std::string_view hex, std::string& bytes) {
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+    bytes.clear();
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int value = 0;
+        for (size_t k = i; k < i + 2; k++) {
+            char c = hex[k];
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                value |= c - 'a' + 10;
+            } else {
+                return false;
+            }
+        }
+        bytes += static_cast<char>(value);
+    }
+    return true;
+}
+
+} // namespace
+
+// SHA-256
+PasswordHash::Digest PasswordHash::sha256(std::string_view data) {
+    Sha256 hasher;
+    hasher.update(data);
+    return hasher.finish();
+}
+
+// HMAC-SHA256
+PasswordHash::Digest PasswordHash::hmacSha256(std::string_view key, std::string_view message) {
+    return Hmac(key).compute(message);
+}
+
+// PBKDF2-HMAC-SHA256
+std::string PasswordHash::pbkdf2(std::string_view password, std::string_view salt, int iterations, size_t length) {
+    Hmac hmac(password);
+    std::string key;
+    key.reserve(length);
+    
+    for (uint32_t blockIndex = 1; key.size() < length; blockIndex++) {
+        std::string first(salt);
+        first += static_cast<char>(blockIndex >> 24);
+        first += static_cast<char>(blockIndex >> 16);
+        first += static_cast<char>(blockIndex >> 8);
+        first += static_cast<char>(blockIndex);
+        
+        Digest u = hmac.compute(first);
+        Digest block = u;
+        for (int i = 1; i < iterations; i++) {
+            u = hmac.compute(asBytes(u));
+            for (size_t k = 0; k < block.size(); k++) {
+                block[k] ^= u[k];
+            }
+        }
+        
+        key.append(asBytes(block).substr(0, std::min(block.size(), length - key.size())));
+    }
+    
+    return key;
+}
+
+// Хеш пароля со случайной солью
+std::string PasswordHash::hash(std::string_view password, int iterations) {
+    std::string salt = randomBytes(SALT_SIZE);
+    std::string key = pbkdf2(password, salt, iterations, KEY_SIZE);
+    return PREFIX + std::to_string(iterations) + "$" + toHex(salt) + "$" + toHex(key);
+}
+
+// Проверка пароля по хешу
+bool PasswordHash::verify(std::string_view password, std::string_view stored) {
+    if (!isHashed(stored)) {
+        return false;
+    }
+    
+    // pbkdf2-sha256$<итерации>$<соль>$<ключ>
+    std::string_view rest = stored.substr(std::strlen(PREFIX));
+    size_t first = rest.find('$');
+    size_t second = first == std::string_view::npos ? first : rest.find('$', first + 1);
+    if (second == std::string_view::npos) {
+        return false;
+    }
+    
+    int iterations = 0;
+    for (char c : rest.substr(0, first)) {
+        if (c < '0' || c > '9' || iterations > 100000000) {
+            return false;
+        }
+        iterations = iterations * 10 + (c - '0');
+    }
+    
+    std::string salt;
+    std::string expected;
+    if (iterations <= 0 || !fromHex(rest.substr(first + 1, second - first - 1), salt) ||
+        !fromHex(rest.substr(second + 1), expected) || expected.empty()) {
+        return false;
+    }
+    
+    std::string actual = pbkdf2(password, salt, iterations, expected.size());
+    unsigned char difference = 0;
+    for (size_t i = 0; i < expected.size(); i++) {
+        difference |= static_cast<unsigned char>(actual[i] ^ expected[i]);
+    }
+    return difference == 0;
+}
+
+// Проверка, является ли значение хешем
+bool PasswordHash::isHashed(std::string_view stored) {
+    return stored.substr(0, std::strlen(PREFIX)) == PREFIX;
+}
+
+// Случайные байты
+std::string PasswordHash::randomBytes(size_t count) {
+    static thread_local std::random_device source;
+    std::string bytes;
+    bytes.reserve(count);
+    while (bytes.size() < count) {
+        unsigned int value = source();
+        for (size_t i = 0; i < sizeof(value) && bytes.size() < count; i++) {
+            bytes += static_cast<char>(value >> (8 * i));
+        }
+    }
+    return bytes;
+}
+
+// Шестнадцатеричная запись
+std::string PasswordHash::toHex(std::string_view bytes) {
+    static const char DIGITS[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(bytes.size() * 2);
+    for (char c : bytes) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        hex += DIGITS[byte >> 4];
+        hex += DIGITS[byte & 0x0F];
+    }
+    return hex;
+}
@@ -0,0 +1,125 @@
+#include "../include/QueryExecutor.h"
+#include <algorithm>
+
+namespace {
+
+// Соединение, которым владеет текущий рабочий поток
+thread_local MusicStoreDB* currentConnection = nullptr;
+
+} // namespace
+
+// Конструктор
+QueryExecutor::QueryExecutor(const std::string& dbPath, size_t threads, OpenMode mode) : stopping(false) {
+    threads = std::max<size_t>(1, threads);
+    for (size_t i = 0; i < threads; i++) {
+        connections.push_back(std::make_unique<MusicStoreDB>(dbPath, mode));
+        
+        // Один кеш каталога на все соединения пула
+        connections.back()->setCatalogCache(connections.front()->getCatalogCache());
+    }
+    
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back(&QueryExecutor::workerLoop, this, i);
+    }
+}
+
+// Деструктор
+QueryExecutor::~QueryExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Цикл рабочего потока
+void QueryExecutor::workerLoop(size_t index) {
+    currentConnection = connections[index].get();
+    
+    while (true) {
+        std::coroutine_handle<> handle;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                break;
+            }
+            handle = queue.front();
+            queue.pop_front();
+        }
+        
+        // Корутина выполняется до следующей точки приостановки
+        handle.resume();
+    }
+    
+    currentConnection = nullptr;
+}
+
+// Постановка корутины в очередь
+void QueryExecutor::enqueue(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(handle);
+    }
+    ready.notify_one();
+}
+
+// Соединение текущего рабочего потока
+MusicStoreDB& QueryExecutor::connection() {
+    return *currentConnection;
+}
+
+// Продажи по авторам
+Task<std::vector<AuthorSales>> QueryExecutor::authorSales() {
+    co_await schedule();
+    co_return connection().getAuthorSales();
+}
+
+// Продажи по исполнителям
+Task<std::vector<PerformerSales>> QueryExecutor::performerSales() {
+    co_await schedule();
+    co_return connection().getPerformerSales();
+}
+
+// Текущий остаток компакт-диска
+Task<long long> QueryExecutor::stockLevel(int compactId) {
+    co_await schedule();
+    co_return connection().getStockLevel(compactId);
+}
+
+// Поступления и продажи за период
+Task<PeriodTotals> QueryExecutor::periodTotals(int compactId, std::string startDate, std::string endDate) {
+    co_await schedule();
+    co_return connection().getPeriodTotals(compactId, startDate, endDate);
+}
+
+// Регистрация продажи
+Task<int> QueryExecutor::registerSale(int compactId, int quantity, std::string operationDate) {
+    co_await schedule();
+    co_return connection().registerOperation("продажа", compactId, quantity, operationDate);
+}
+
+// Регистрация поступления
+Task<int> QueryExecutor::registerReceipt(int compactId, int quantity, std::string operationDate) {
+    co_await schedule();
+    co_return connection().registerOperation("поступление", compactId, quantity, operationDate);
+}
+
+// Потоковое чтение складского отчета
+AsyncGenerator<InventoryRow> QueryExecutor::inventory(int pageSize) {
+    std::string token;
+    do {
+        co_await schedule();
+        Page<InventoryRow> page = connection().getCompactInventoryPage(pageSize, token);
+        token = page.nextToken;
+        
+        for (auto& row : page.rows) {
+            co_yield std::move(row);
+        }
+    } while (!token.empty());
+}
@@ -0,0 +1,59 @@
+#include "../include/ReportArena.h"
+#include <atomic>
+
+namespace {
+
+// Общие итоги по всем аренам
+std::atomic<size_t> totalReports{0};
+std::atomic<size_t> totalAllocations{0};
+std::atomic<size_t> totalBytes{0};
+std::atomic<size_t> totalHeapAllocations{0};
+std::atomic<size_t> totalHeapBytes{0};
+
+} // namespace
+
+// Конструктор
+CountingResource::CountingResource(std::pmr::memory_resource* upstream)
+    : upstream(upstream), allocations(0), bytes(0) {
+}
+
+void* CountingResource::do_allocate(size_t size, size_t alignment) {
+    allocations++;
+    bytes += size;
+    return upstream->allocate(size, alignment);
+}
+
+void CountingResource::do_deallocate(void* pointer, size_t size, size_t alignment) {
+    upstream->deallocate(pointer, size, alignment);
+}
+
+bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+// Конструктор
+ReportArena::ReportArena(std::pmr::memory_resource* upstream)
+    : heap(upstream), arena(buffer, sizeof(buffer), &heap), counted(&arena) {
+}
+
+// Деструктор
+ReportArena::~ReportArena() {
+    ReportArenaStats current = stats();
+    totalReports++;
+    totalAllocations += current.allocations;
+    totalBytes += current.bytes;
+    totalHeapAllocations += current.heapAllocations;
+    totalHeapBytes += current.heapBytes;
+}
+
+// Счетчики арены
+ReportArenaStats ReportArena::stats() const {
+    return ReportArenaStats{0, counted.allocationCount(), counted.allocatedBytes(),
+                            heap.allocationCount(), heap.allocatedBytes()};
+}
+
+// Общие итоги
+ReportArenaStats ReportArena::totals() {
+    return ReportArenaStats{totalReports.load(), totalAllocations.load(), totalBytes.load(),
+                            totalHeapAllocations.load(), totalHeapBytes.load()};
+}
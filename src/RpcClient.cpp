@@ -0,0 +1,106 @@
+#include "../include/RpcClient.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Подключение к серверу
+RpcClient::RpcClient(const std::string& socketPath) : fd(-1), next(1) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Слишком длинный путь к сокету: " + socketPath);
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+    
+    fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::string message = std::strerror(errno);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        throw std::runtime_error("Не удалось подключиться к " + socketPath + ": " + message);
+    }
+}
+
+// Деструктор
+RpcClient::~RpcClient() {
+    ::close(fd);
+}
+
+// Вызов метода
+JsonValue RpcClient::call(const std::string& method, JsonValue params) {
+    long long id = next++;
+    JsonValue request = JsonValue::object().set("id", id).set("method", method).set("params", std::move(params));
+    if (!token.empty()) {
+        request.set("token", token);
+    }
+    if (!RpcFrame::write(fd, request.dump())) {
+        throw std::runtime_error("Соединение с сервером потеряно");
+    }
+    
+    std::string body;
+    if (!RpcFrame::read(fd, body)) {
+        throw std::runtime_error("Соединение с сервером потеряно");
+    }
+    
+    std::optional<JsonValue> response = JsonValue::parse(body);
+    if (!response || (*response)["id"].asInt(-1) != id) {
+        throw std::runtime_error("Некорректный ответ сервера");
+    }
+    return *response;
+}
+
+// Вход пользователя
+bool RpcClient::login(const std::string& username, const std::string& password) {
+    JsonValue response = call("login", JsonValue::object().set("username", username).set("password", password));
+    if (!response["ok"].asBool()) {
+        return false;
+    }
+    token = response["result"]["token"].asString();
+    return true;
+}
+
+// Завершение сессии
+bool RpcClient::logout() {
+    bool ok = call("logout")["ok"].asBool();
+    token.clear();
+    return ok;
+}
+
+// Регистрация продажи
+int RpcClient::registerSale(int compactId, int quantity, const std::string& operationDate) {
+    JsonValue response = call("sale", JsonValue::object()
+                                          .set("compactId", compactId)
+                                          .set("quantity", quantity)
+                                          .set("date", operationDate));
+    return static_cast<int>(response["result"]["operationId"].asInt(-1));
+}
+
+// Регистрация поступления
+int RpcClient::registerReceipt(int compactId, int quantity, const std::string& operationDate) {
+    JsonValue response = call("receipt", JsonValue::object()
+                                             .set("compactId", compactId)
+                                             .set("quantity", quantity)
+                                             .set("date", operationDate));
+    return static_cast<int>(response["result"]["operationId"].asInt(-1));
+}
+
+// Текущий остаток
+long long RpcClient::stockLevel(int compactId) {
+    JsonValue response = call("stock", JsonValue::object().set("compactId", compactId));
+    return response["result"]["remaining"].asInt(-1);
+}
+
+// Продажи по авторам
+std::vector<AuthorSales> RpcClient::authorSales() {
+    std::vector<AuthorSales> result;
+    JsonValue response = call("authorSales");
+    for (const auto& row : response["result"].asArray()) {
+        result.push_back(AuthorSales{row["author"].asString(), row["sold"].asInt(), row["works"].asInt(),
+                                     row["revenue"].asDouble()});
+    }
+    return result;
+}
@@ -0,0 +1,467 @@
+#include "../include/RpcProtocol.h"
+#include "../include/TableWriter.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// Ограничение вложенности при разборе
+const int MAX_DEPTH = 64;
+
+// Длина тела из заголовка кадра
+uint32_t frameSize(const std::string& buffer) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(buffer[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(buffer[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(buffer[2])) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(buffer[3]));
+}
+
+// Рекурсивный разбор JSON
+class JsonParser {
+private:
+    std::string_view text;
+    size_t pos;
+    
+    void skipSpaces() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            pos++;
+        }
+    }
+    
+    bool consume(std::string_view token) {
+        if (text.substr(pos, token.size()) != token) {
+            return false;
+        }
+        pos += token.size();
+        return true;
+    }
+    
+    bool parseHex(unsigned& code) {
+        if (pos + 4 > text.size()) {
+            return false;
+        }
+        code = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = text[pos++];
+            code <<= 4;
+            if (c >= '0' && c <= '9') {
+                code |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                code |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                code |= c - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    static void appendUtf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+    
+    bool parseString(std::string& out) {
+        if (pos >= text.size() || text[pos] != '"') {
+            return false;
+        }
+        pos++;
+        
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) {
+                return false;
+            }
+            
+            char escaped = text[pos++];
+            switch (escaped) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned code;
+                    if (!parseHex(code)) {
+                        return false;
+                    }
+                    // Суррогатная пара UTF-16
+                    if (code >= 0xD800 && code <= 0xDBFF) {
+                        unsigned low;
+                        if (!consume("\\u") || !parseHex(low) || low < 0xDC00 || low > 0xDFFF) {
+                            return false;
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                        return false;
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+    
+    bool parseNumber(double& value) {
+        size_t start = pos;
+        if (pos < text.size() && text[pos] == '-') {
+            pos++;
+        }
+        size_t digits = pos;
+        while (pos < text.size() && ((text[pos] >= '0' && text[pos] <= '9') || text[pos] == '.' ||
+                                     text[pos] == 'e' || text[pos] == 'E' || text[pos] == '+' || text[pos] == '-')) {
+            pos++;
+        }
+        if (pos == digits || text[digits] < '0' || text[digits] > '9') {
+            return false;
+        }
+        
+        std::string number(text.substr(start, pos - start));
+        char* end = nullptr;
+        value = std::strtod(number.c_str(), &end);
+        return end == number.c_str() + number.size() && std::isfinite(value);
+    }
+
+public:
+    explicit JsonParser(std::string_view text) : text(text), pos(0) {}
+    
+    bool parseValue(JsonValue& value, int depth) {
+        if (depth > MAX_DEPTH) {
+            return false;
+        }
+        skipSpaces();
+        if (pos >= text.size()) {
+            return false;
+        }
+        
+        char c = text[pos];
+        if (c == '{') {
+            pos++;
+            value = JsonValue::object();
+            skipSpaces();
+            if (pos < text.size() && text[pos] == '}') {
+                pos++;
+                return true;
+            }
+            while (true) {
+                std::string key;
+                JsonValue member;
+                skipSpaces();
+                if (!parseString(key)) {
+                    return false;
+                }
+                skipSpaces();
+                if (!consume(":") || !parseValue(member, depth + 1)) {
+                    return false;
+                }
+                value.set(std::move(key), std::move(member));
+                skipSpaces();
+                if (consume("}")) {
+                    return true;
+                }
+                if (!consume(",")) {
+                    return false;
+                }
+            }
+        }
+        if (c == '[') {
+            pos++;
+            value = JsonValue::array();
+            skipSpaces();
+            if (pos < text.size() && text[pos] == ']') {
+                pos++;
+                return true;
+            }
+            while (true) {
+                JsonValue item;
+                if (!parseValue(item, depth + 1)) {
+                    return false;
+                }
+                value.push(std::move(item));
+                skipSpaces();
+                if (consume("]")) {
+                    return true;
+                }
+                if (!consume(",")) {
+                    return false;
+                }
+            }
+        }
+        if (c == '"') {
+            std::string str;
+            if (!parseString(str)) {
+                return false;
+            }
+            value = JsonValue(std::move(str));
+            return true;
+        }
+        if (consume("true")) {
+            value = JsonValue(true);
+            return true;
+        }
+        if (consume("false")) {
+            value = JsonValue(false);
+            return true;
+        }
+        if (consume("null")) {
+            value = JsonValue();
+            return true;
+        }
+        
+        double number;
+        if (!parseNumber(number)) {
+            return false;
+        }
+        value = JsonValue(number);
+        return true;
+    }
+    
+    bool atEnd() {
+        skipSpaces();
+        return pos == text.size();
+    }
+};
+
+} // namespace
+
+// Пустой массив
+JsonValue JsonValue::array() {
+    JsonValue value;
+    value.type = Type::Array;
+    return value;
+}
+
+// Пустой объект
+JsonValue JsonValue::object() {
+    JsonValue value;
+    value.type = Type::Object;
+    return value;
+}
+
+// Целое значение
+long long JsonValue::asInt(long long fallback) const {
+    if (type != Type::Number || number != std::trunc(number) || std::fabs(number) > 9.0e15) {
+        return fallback;
+    }
+    return static_cast<long long>(number);
+}
+
+// Поле объекта
+const JsonValue& JsonValue::operator[](std::string_view key) const {
+    static const JsonValue null;
+    for (const auto& member : members) {
+        if (member.first == key) {
+            return member.second;
+        }
+    }
+    return null;
+}
+
+// Проверка наличия поля
+bool JsonValue::has(std::string_view key) const {
+    for (const auto& member : members) {
+        if (member.first == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Добавление поля
+JsonValue& JsonValue::set(std::string key, JsonValue value) {
+    type = Type::Object;
+    members.emplace_back(std::move(key), std::move(value));
+    return *this;
+}
+
+// Добавление элемента
+JsonValue& JsonValue::push(JsonValue value) {
+    type = Type::Array;
+    items.push_back(std::move(value));
+    return *this;
+}
+
+// Сериализация
+std::string JsonValue::dump() const {
+    std::string out;
+    dumpTo(out);
+    return out;
+}
+
+void JsonValue::dumpTo(std::string& out) const {
+    switch (type) {
+        case Type::Null:
+            out += "null";
+            break;
+        case Type::Bool:
+            out += boolean ? "true" : "false";
+            break;
+        case Type::Number: {
+            // Целые числа выводятся без дробной части
+            char buffer[32];
+            if (number == std::trunc(number) && std::fabs(number) < 9.0e15) {
+                std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(number));
+            } else {
+                std::snprintf(buffer, sizeof(buffer), "%.17g", number);
+            }
+            out += buffer;
+            break;
+        }
+        case Type::String:
+            TableWriter::appendJsonString(out, text);
+            break;
+        case Type::Array:
+            out += '[';
+            for (size_t i = 0; i < items.size(); i++) {
+                if (i > 0) {
+                    out += ',';
+                }
+                items[i].dumpTo(out);
+            }
+            out += ']';
+            break;
+        case Type::Object:
+            out += '{';
+            for (size_t i = 0; i < members.size(); i++) {
+                if (i > 0) {
+                    out += ',';
+                }
+                TableWriter::appendJsonString(out, members[i].first);
+                out += ':';
+                members[i].second.dumpTo(out);
+            }
+            out += '}';
+            break;
+    }
+}
+
+// Разбор текста JSON
+std::optional<JsonValue> JsonValue::parse(std::string_view text) {
+    JsonParser parser(text);
+    JsonValue value;
+    if (!parser.parseValue(value, 0) || !parser.atEnd()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Формирование кадра
+bool RpcFrame::encode(std::string_view body, std::string& out) {
+    if (body.size() > MAX_SIZE) {
+        return false;
+    }
+    
+    out.reserve(out.size() + 4 + body.size());
+    uint32_t size = static_cast<uint32_t>(body.size());
+    out += static_cast<char>(size >> 24);
+    out += static_cast<char>(size >> 16);
+    out += static_cast<char>(size >> 8);
+    out += static_cast<char>(size);
+    out += body;
+    return true;
+}
+
+// Запись кадра
+bool RpcFrame::write(int fd, std::string_view body) {
+    std::string frame;
+    if (!encode(body, frame)) {
+        return false;
+    }
+    
+    size_t sent = 0;
+    while (sent < frame.size()) {
+        ssize_t n = ::send(fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Чтение кадра
+bool RpcFrame::read(int fd, std::string& body) {
+    std::string buffer;
+    char chunk[4096];
+    
+    while (true) {
+        int result = extract(buffer, body);
+        if (result != 0) {
+            return result > 0;
+        }
+        
+        // Читаем не больше, чем нужно для текущего кадра, чтобы не захватить следующий
+        size_t wanted = sizeof(chunk);
+        if (buffer.size() >= 4) {
+            wanted = std::min<size_t>(wanted, 4 + frameSize(buffer) - buffer.size());
+        } else {
+            wanted = 4 - buffer.size();
+        }
+        
+        ssize_t n = ::recv(fd, chunk, wanted, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+}
+
+// Извлечение готового кадра
+int RpcFrame::extract(std::string& buffer, std::string& body) {
+    if (buffer.size() < 4) {
+        return 0;
+    }
+    
+    uint32_t size = frameSize(buffer);
+    if (size > MAX_SIZE) {
+        return -1;
+    }
+    if (buffer.size() < 4 + static_cast<size_t>(size)) {
+        return 0;
+    }
+    
+    body.assign(buffer, 4, size);
+    buffer.erase(0, 4 + static_cast<size_t>(size));
+    return 1;
+}
@@ -0,0 +1,468 @@
+#include "../include/RpcServer.h"
+#include "../include/PasswordHash.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <mutex>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+// Состояние одного подключения
+struct RpcServer::Client {
+    int fd;                // Сокет клиента (неблокирующий)
+    std::string buffer;    // Принятые, но еще не разобранные байты
+    std::mutex writeMutex; // Защита очереди ответов
+    std::string outgoing;  // Ответы, еще не принятые сокетом
+    size_t outgoingSent;   // Отправленная часть outgoing
+    std::chrono::steady_clock::time_point lastProgress; // Последняя отправка (или постановка в пустую очередь)
+    bool broken;           // Отправка невозможна: новые ответы отбрасываются
+    
+    explicit Client(int fd) : fd(fd), outgoingSent(0), broken(false) {}
+    
+    ~Client() { ::close(fd); }
+    
+    // Отправка очереди без ожидания; вызывается под writeMutex
+    void flush() {
+        while (!broken && outgoingSent < outgoing.size()) {
+            ssize_t n = ::send(fd, outgoing.data() + outgoingSent, outgoing.size() - outgoingSent, MSG_NOSIGNAL);
+            if (n > 0) {
+                outgoingSent += static_cast<size_t>(n);
+                lastProgress = std::chrono::steady_clock::now();
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Отправленное начало очереди освобождается, чтобы она не росла у читающего клиента
+                if (outgoingSent > outgoing.size() / 2) {
+                    outgoing.erase(0, outgoingSent);
+                    outgoingSent = 0;
+                }
+                return;
+            } else {
+                broken = true;
+            }
+        }
+        outgoing.clear();
+        outgoingSent = 0;
+    }
+};
+
+namespace {
+
+// Предел очереди ответов одного клиента: дальше клиент считается зависшим
+constexpr size_t MAX_OUTGOING = 4 * static_cast<size_t>(RpcFrame::MAX_SIZE);
+
+// Ответ с ошибкой
+JsonValue errorResponse(const std::string& message) {
+    return JsonValue::object().set("ok", false).set("error", message);
+}
+
+// Успешный ответ
+JsonValue okResponse(JsonValue result) {
+    return JsonValue::object().set("ok", true).set("result", std::move(result));
+}
+
+} // namespace
+
+// Конструктор
+RpcServer::RpcServer(const std::string& dbPath, const std::string& socketPath, size_t workers, OpenMode mode,
+                     std::chrono::seconds sessionTtl)
+    : socketPath(socketPath), listenFd(-1), wakeFds{-1, -1}, running(false), requests(0),
+      sendTimeout(std::chrono::seconds(30)), sessions(sessionTtl),
+      executor(dbPath, workers, mode) {
+    stock.load(syncWait(executor.query([](MusicStoreDB& db) { return db.getStockLevels(); })));
+}
+
+// Деструктор
+RpcServer::~RpcServer() {
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(socketPath.c_str());
+    }
+    for (int fd : wakeFds) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+// Создание слушающего сокета
+bool RpcServer::listen() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Слишком длинный путь к сокету: " << socketPath << std::endl;
+        return false;
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+    
+    if (::pipe(wakeFds) != 0) {
+        std::cerr << "Ошибка создания канала: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    ::fcntl(wakeFds[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(wakeFds[1], F_SETFL, O_NONBLOCK);
+    
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::cerr << "Ошибка создания сокета: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    // Сокет, оставшийся от завершившегося процесса, удаляется
+    ::unlink(socketPath.c_str());
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0) {
+        std::cerr << "Ошибка открытия сокета " << socketPath << ": " << std::strerror(errno) << std::endl;
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    return true;
+}
+
+// Остановка цикла
+void RpcServer::stop() {
+    running = false;
+    wake();
+}
+
+// Пробуждение цикла
+void RpcServer::wake() {
+    if (wakeFds[1] >= 0) {
+        char byte = 1;
+        ssize_t ignored = ::write(wakeFds[1], &byte, 1);
+        (void)ignored;
+    }
+}
+
+// Цикл обработки соединений
+void RpcServer::run() {
+    if (listenFd < 0 && !listen()) {
+        return;
+    }
+    running = true;
+    
+    std::unordered_map<int, std::shared_ptr<Client>> clients;
+    std::vector<pollfd> fds;
+    char chunk[64 * 1024];
+    auto lastPurge = std::chrono::steady_clock::now();
+    
+    while (running) {
+        fds.clear();
+        fds.push_back({wakeFds[0], POLLIN, 0});
+        fds.push_back({listenFd, POLLIN, 0});
+        bool sending = false;
+        for (const auto& entry : clients) {
+            short events = POLLIN;
+            {
+                std::lock_guard<std::mutex> lock(entry.second->writeMutex);
+                if (!entry.second->outgoing.empty()) {
+                    events |= POLLOUT;
+                    sending = true;
+                }
+            }
+            fds.push_back({entry.first, events, 0});
+        }
+        
+        // Пока есть неотправленные ответы, зависшие клиенты проверяются чаще
+        if (::poll(fds.data(), fds.size(), sending ? 100 : 60000) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Ошибка poll: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        
+        // Истекшие сессии удаляются раз в минуту
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastPurge >= std::chrono::minutes(1)) {
+            sessions.purgeExpired();
+            lastPurge = now;
+        }
+        
+        if (fds[0].revents & POLLIN) {
+            while (::read(wakeFds[0], chunk, sizeof(chunk)) > 0) {
+            }
+        }
+        
+        if (fds[1].revents & POLLIN) {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd >= 0) {
+                clients.emplace(fd, std::make_shared<Client>(fd));
+            }
+        }
+        
+        for (size_t i = 2; i < fds.size(); i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            auto it = clients.find(fds[i].fd);
+            std::shared_ptr<Client> client = it->second;
+            
+            if (fds[i].revents & POLLOUT) {
+                std::lock_guard<std::mutex> lock(client->writeMutex);
+                client->flush();
+            }
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            
+            ssize_t n = ::recv(client->fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                continue;
+            }
+            if (n <= 0) {
+                // Соединение закрыто; сокет закроется после ответов на начатые запросы
+                clients.erase(it);
+                continue;
+            }
+            client->buffer.append(chunk, static_cast<size_t>(n));
+            
+            std::string body;
+            int result;
+            while ((result = RpcFrame::extract(client->buffer, body)) > 0) {
+                std::optional<JsonValue> request = JsonValue::parse(body);
+                if (!request || !request->isObject()) {
+                    reply(*client, JsonValue(), errorResponse("некорректный JSON"));
+                    continue;
+                }
+                spawn(handle(client, std::move(*request)));
+            }
+            if (result < 0) {
+                reply(*client, JsonValue(), errorResponse("слишком большой кадр"));
+                ::shutdown(client->fd, SHUT_RDWR);
+                clients.erase(it);
+            }
+        }
+        
+        // Клиент, не принимающий ответы дольше sendTimeout, отключается
+        now = std::chrono::steady_clock::now();
+        for (auto it = clients.begin(); it != clients.end();) {
+            Client& client = *it->second;
+            bool drop;
+            {
+                std::lock_guard<std::mutex> lock(client.writeMutex);
+                drop = client.broken || (!client.outgoing.empty() && now - client.lastProgress >= sendTimeout);
+                if (drop) {
+                    client.broken = true;
+                    client.outgoing.clear();
+                    client.outgoingSent = 0;
+                }
+            }
+            if (drop) {
+                ::shutdown(client.fd, SHUT_RDWR);
+                it = clients.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+// Отправка ответа
+void RpcServer::reply(Client& client, const JsonValue& id, JsonValue response) {
+    JsonValue message = JsonValue::object().set("id", id);
+    message.set("ok", response["ok"]);
+    if (response.has("result")) {
+        message.set("result", response["result"]);
+    } else {
+        message.set("error", response["error"]);
+    }
+    
+    bool queued;
+    {
+        std::lock_guard<std::mutex> lock(client.writeMutex);
+        if (client.broken) {
+            return;
+        }
+        if (client.outgoing.empty()) {
+            client.lastProgress = std::chrono::steady_clock::now();
+        }
+        if (!RpcFrame::encode(message.dump(), client.outgoing)) {
+            return;
+        }
+        
+        // Рабочий поток не ждет медленного клиента: остаток досылает цикл по POLLOUT
+        client.flush();
+        if (client.outgoing.size() - client.outgoingSent > MAX_OUTGOING) {
+            client.broken = true;
+            client.outgoing.clear();
+            client.outgoingSent = 0;
+        }
+        queued = !client.outgoing.empty() || client.broken;
+    }
+    if (queued) {
+        wake();
+    }
+}
+
+// Выполнение запроса в рабочем потоке
+Task<void> RpcServer::handle(std::shared_ptr<Client> client, JsonValue request) {
+    co_await executor.schedule();
+    
+    JsonValue response;
+    try {
+        response = dispatch(request, QueryExecutor::connection());
+    } catch (const std::exception& e) {
+        response = errorResponse(e.what());
+    }
+    requests++;
+    reply(*client, request["id"], std::move(response));
+}
+
+// Выполнение метода
+JsonValue RpcServer::dispatch(const JsonValue& request, MusicStoreDB& db) {
+    std::string method = request["method"].asString();
+    const JsonValue& params = request["params"];
+    
+    if (method == "ping") {
+        return okResponse("pong");
+    }
+    
+    if (method == "login") {
+        std::string password = params["password"].asString();
+        std::optional<AuthenticatedUser> user;
+        {
+            std::shared_lock<std::shared_mutex> lock(databaseLock);
+            user = db.authenticate(params["username"].asString(), password);
+        }
+        if (!user) {
+            return errorResponse("неверное имя пользователя или пароль");
+        }
+        
+        // Хеш считается вне блокировки базы: KDF намеренно медленный
+        if (user->needsRehash && !db.isReadOnly()) {
+            std::string passwordHash = PasswordHash::hash(password);
+            std::unique_lock<std::shared_mutex> lock(databaseLock);
+            db.updatePasswordHash(user->userId, passwordHash);
+        }
+        
+        std::string token = sessions.create(user->userId, user->username, user->admin);
+        return okResponse(JsonValue::object()
+                              .set("token", token)
+                              .set("userId", user->userId)
+                              .set("admin", user->admin));
+    }
+    
+    std::optional<Session> session = sessions.validate(request["token"].asString());
+    if (!session) {
+        return errorResponse("требуется вход");
+    }
+    
+    if (method == "logout") {
+        sessions.revoke(request["token"].asString());
+        return okResponse(nullptr);
+    }
+    
+    if (method == "sale" || method == "receipt") {
+        if (!session->admin) {
+            return errorResponse("недостаточно прав");
+        }
+        int compactId = static_cast<int>(params["compactId"].asInt(-1));
+        int quantity = static_cast<int>(params["quantity"].asInt(0));
+        std::string date = params["date"].asString();
+        
+        bool sale = method == "sale";
+        
+        // Резерв до блокировки записи. Неизвестный диск или нехватка сначала сверяются с базой:
+        // поступление могло быть записано другим процессом мимо реестра
+        if (sale) {
+            StockLedger::Reservation reservation = stock.reserve(compactId, quantity);
+            if (reservation != StockLedger::Reservation::Reserved) {
+                {
+                    std::unique_lock<std::shared_mutex> lock(databaseLock);
+                    stock.reconcile(compactId, db.getStockLevel(compactId));
+                }
+                reservation = stock.reserve(compactId, quantity);
+            }
+            if (reservation != StockLedger::Reservation::Reserved) {
+                return errorResponse("недостаточно компакт-дисков на складе");
+            }
+        }
+        
+        std::unique_lock<std::shared_mutex> lock(databaseLock);
+        int operationId = db.registerOperation(sale ? "продажа" : "поступление", compactId, quantity, date);
+        if (sale) {
+            if (operationId < 0) {
+                stock.release(compactId, quantity);
+            } else {
+                stock.commit(compactId, quantity);
+            }
+        }
+        
+        // Сверка учитывает и операции других процессов
+        stock.reconcile(compactId, db.getStockLevel(compactId));
+        if (operationId < 0) {
+            return errorResponse("операция не выполнена");
+        }
+        return okResponse(JsonValue::object().set("operationId", operationId));
+    }
+    
+    std::shared_lock<std::shared_mutex> lock(databaseLock);
+    
+    if (method == "stock") {
+        long long remaining = db.getStockLevel(static_cast<int>(params["compactId"].asInt(-1)));
+        return okResponse(JsonValue::object().set("remaining", remaining));
+    }
+    
+    if (method == "periodTotals") {
+        PeriodTotals totals = db.getPeriodTotals(static_cast<int>(params["compactId"].asInt(-1)),
+                                                 params["startDate"].asString(), params["endDate"].asString());
+        return okResponse(JsonValue::object().set("received", totals.received).set("sold", totals.sold));
+    }
+    
+    if (method == "inventory") {
+        Page<InventoryRow> page = db.getCompactInventoryPage(static_cast<int>(params["pageSize"].asInt(100)),
+                                                             params["token"].asString());
+        JsonValue rows = JsonValue::array();
+        for (const auto& row : page.rows) {
+            rows.push(JsonValue::object()
+                          .set("compactId", row.compactId)
+                          .set("company", row.company)
+                          .set("productionDate", row.productionDate)
+                          .set("price", row.price)
+                          .set("received", row.totalReceived)
+                          .set("sold", row.totalSold)
+                          .set("remaining", row.remaining)
+                          .set("stockValue", row.stockValue));
+        }
+        return okResponse(JsonValue::object().set("rows", std::move(rows)).set("nextToken", page.nextToken));
+    }
+    
+    if (method == "authorSales") {
+        JsonValue rows = JsonValue::array();
+        for (const auto& row : db.getAuthorSales()) {
+            rows.push(JsonValue::object()
+                          .set("author", row.author)
+                          .set("sold", row.totalSold)
+                          .set("works", row.worksCount)
+                          .set("revenue", row.totalRevenue));
+        }
+        return okResponse(std::move(rows));
+    }
+    
+    if (method == "performerSales") {
+        JsonValue rows = JsonValue::array();
+        for (const auto& row : db.getPerformerSales()) {
+            rows.push(JsonValue::object().set("performer", row.performer).set("sold", row.totalSold));
+        }
+        return okResponse(std::move(rows));
+    }
+    
+    if (method == "inventoryValue") {
+        InventoryValue value = db.getInventoryValue();
+        return okResponse(JsonValue::object()
+                              .set("discs", value.discCount)
+                              .set("received", value.totalReceived)
+                              .set("sold", value.totalSold)
+                              .set("remaining", value.remaining)
+                              .set("stockValue", value.stockValue));
+    }
+    
+    return errorResponse("неизвестный метод: " + method);
+}
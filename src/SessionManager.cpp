@@ -0,0 +1,106 @@
+#include "../include/SessionManager.h"
+#include "../include/PasswordHash.h"
+#include <functional>
+#include <mutex>
+
+// Конструктор
+SessionManager::SessionManager(std::chrono::seconds ttl) : ttl(ttl) {
+}
+
+// Сегмент таблицы для токена
+SessionManager::Shard& SessionManager::shardFor(const std::string& token) {
+    return shards[std::hash<std::string>{}(token) % SHARD_COUNT];
+}
+
+// Создание сессии
+std::string SessionManager::create(int userId, const std::string& username, bool admin) {
+    std::string token = PasswordHash::toHex(PasswordHash::randomBytes(TOKEN_BYTES));
+    Shard& shard = shardFor(token);
+    
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.sessions[token] = Session{userId, username, admin, std::chrono::steady_clock::now() + ttl};
+    return token;
+}
+
+// Проверка токена
+std::optional<Session> SessionManager::validate(const std::string& token) {
+    Shard& shard = shardFor(token);
+    auto now = std::chrono::steady_clock::now();
+    
+    // Обычно достаточно блокировки чтения: сессия продлевается, только когда прошла половина срока
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(token);
+        if (it == shard.sessions.end()) {
+            return std::nullopt;
+        }
+        if (it->second.expires > now + ttl / 2) {
+            return it->second;
+        }
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(token);
+    if (it == shard.sessions.end()) {
+        return std::nullopt;
+    }
+    if (it->second.expires <= now) {
+        shard.sessions.erase(it);
+        return std::nullopt;
+    }
+    
+    it->second.expires = now + ttl;
+    return it->second;
+}
+
+// Завершение сессии
+bool SessionManager::revoke(const std::string& token) {
+    Shard& shard = shardFor(token);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.sessions.erase(token) > 0;
+}
+
+// Завершение всех сессий пользователя
+size_t SessionManager::revokeUser(int userId) {
+    size_t removed = 0;
+    for (auto& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+            if (it->second.userId == userId) {
+                it = shard.sessions.erase(it);
+                removed++;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return removed;
+}
+
+// Удаление истекших сессий
+size_t SessionManager::purgeExpired() {
+    auto now = std::chrono::steady_clock::now();
+    size_t removed = 0;
+    for (auto& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+            if (it->second.expires <= now) {
+                it = shard.sessions.erase(it);
+                removed++;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return removed;
+}
+
+// Количество сессий
+size_t SessionManager::size() const {
+    size_t count = 0;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        count += shard.sessions.size();
+    }
+    return count;
+}
@@ -0,0 +1,170 @@
+#include "../include/ShardSet.h"
+#include "../include/TableWriter.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+// Конструктор
+ShardSet::ShardSet(const std::vector<std::string>& dbPaths) : dbPaths(dbPaths) {
+    // Ошибка в пути не должна молча создавать пустую базу магазина
+    for (const auto& path : dbPaths) {
+        if (!std::filesystem::is_regular_file(path)) {
+            throw std::runtime_error("Не найден файл базы данных магазина: " + path);
+        }
+    }
+
+    // Отчет по сети только читает: схема, учетные записи и режим журнала шардов не меняются
+    for (const auto& path : dbPaths) {
+        shards.push_back(std::make_unique<MusicStoreDB>(path, OpenMode::ReadOnly));
+    }
+}
+
+// Параллельное выполнение функции на всех шардах
+template <typename T>
+std::vector<T> ShardSet::runOnShards(const std::function<T(MusicStoreDB&)>& task) {
+    std::vector<T> results(shards.size());
+    std::vector<std::thread> workers;
+    workers.reserve(shards.size());
+
+    // Каждое соединение используется только своим потоком
+    for (size_t i = 0; i < shards.size(); i++) {
+        workers.emplace_back([&, i]() {
+            results[i] = task(*shards[i]);
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return results;
+}
+
+// Самые популярные исполнители по сети
+std::vector<PerformerSales> ShardSet::topPerformers(size_t k) {
+    // Рейтинг по шардам не объединяется, поэтому собираем полные частичные суммы
+    auto partials = runOnShards<std::vector<PerformerSales>>(
+        [](MusicStoreDB& db) { return db.getPerformerSales(); });
+
+    std::unordered_map<std::string, long long> totals;
+    for (const auto& partial : partials) {
+        for (const auto& row : partial) {
+            totals[row.performer] += row.totalSold;
+        }
+    }
+
+    std::vector<PerformerSales> merged;
+    merged.reserve(totals.size());
+    for (const auto& entry : totals) {
+        merged.push_back({entry.first, entry.second});
+    }
+
+    std::sort(merged.begin(), merged.end(), [](const PerformerSales& a, const PerformerSales& b) {
+        if (a.totalSold != b.totalSold) {
+            return a.totalSold > b.totalSold;
+        }
+        return a.performer < b.performer;
+    });
+
+    if (k == 0) {
+        return {};
+    }
+
+    // Включаем всех, кто делит последнее место
+    size_t cut = std::min(k, merged.size());
+    while (cut < merged.size() && merged[cut].totalSold == merged[cut - 1].totalSold) {
+        cut++;
+    }
+    merged.resize(cut);
+
+    return merged;
+}
+
+// Продажи по авторам по всей сети
+std::vector<AuthorSales> ShardSet::authorSales() {
+    auto partials = runOnShards<std::vector<AuthorSales>>(
+        [](MusicStoreDB& db) { return db.getAuthorSales(); });
+
+    // Произведения разных магазинов различны, поэтому их количество суммируется
+    std::unordered_map<std::string, AuthorSales> totals;
+    for (const auto& partial : partials) {
+        for (const auto& row : partial) {
+            auto it = totals.find(row.author);
+            if (it == totals.end()) {
+                totals.emplace(row.author, row);
+            } else {
+                it->second.totalSold += row.totalSold;
+                it->second.worksCount += row.worksCount;
+                it->second.totalRevenue += row.totalRevenue;
+            }
+        }
+    }
+
+    std::vector<AuthorSales> merged;
+    merged.reserve(totals.size());
+    for (const auto& entry : totals) {
+        merged.push_back(entry.second);
+    }
+
+    std::sort(merged.begin(), merged.end(), [](const AuthorSales& a, const AuthorSales& b) {
+        if (a.totalSold != b.totalSold) {
+            return a.totalSold > b.totalSold;
+        }
+        return a.author < b.author;
+    });
+
+    return merged;
+}
+
+// Суммарная стоимость запасов по всей сети
+InventoryValue ShardSet::inventoryValue() {
+    auto partials = runOnShards<InventoryValue>(
+        [](MusicStoreDB& db) { return db.getInventoryValue(); });
+
+    InventoryValue total{0, 0, 0, 0, 0.0};
+    for (const auto& partial : partials) {
+        total.discCount += partial.discCount;
+        total.totalReceived += partial.totalReceived;
+        total.totalSold += partial.totalSold;
+        total.remaining += partial.remaining;
+        total.stockValue += partial.stockValue;
+    }
+
+    return total;
+}
+
+// Вывод сводного отчета по сети
+void ShardSet::showChainReport(size_t k) {
+    std::cout << "\n=== Сводный отчет по сети (" << shards.size() << " магазинов) ===" << std::endl;
+
+    InventoryValue inventory = inventoryValue();
+    std::cout << "Компакт-дисков в каталогах: " << inventory.discCount << std::endl;
+    std::cout << "Поступило: " << inventory.totalReceived << std::endl;
+    std::cout << "Продано: " << inventory.totalSold << std::endl;
+    std::cout << "Остаток: " << inventory.remaining << std::endl;
+    std::cout << "Стоимость остатка: " << inventory.stockValue << std::endl;
+
+    TableWriter performers;
+    performers.setHeader({"Исполнитель", "Продано"});
+    for (const auto& row : topPerformers(k)) {
+        performers.addRow({row.performer, std::to_string(row.totalSold)});
+    }
+    std::cout << "\n=== Самые популярные исполнители ===" << std::endl;
+    performers.write(std::cout);
+
+    TableWriter authors;
+    authors.setHeader({"Автор", "Продано", "Произведений", "Выручка"});
+    for (const auto& row : authorSales()) {
+        authors.addRow({
+            row.author,
+            std::to_string(row.totalSold),
+            std::to_string(row.worksCount),
+            TableWriter::formatNumber(row.totalRevenue)
+        });
+    }
+    std::cout << "\n=== Продажи по авторам ===" << std::endl;
+    authors.write(std::cout);
+}
@@ -0,0 +1,48 @@
+#include "../include/SqliteStorage.h"
+
+// Конструктор
+SqliteStorage::SqliteStorage(std::shared_ptr<MusicStoreDB> db) : db(std::move(db)) {
+}
+
+int SqliteStorage::addCompactDisc(const std::string& productionDate, const std::string& company, float price) {
+    return db->addCompactDisc(productionDate, company, price);
+}
+
+int SqliteStorage::addMusicalWork(const std::string& title, const std::string& author,
+                                  const std::string& performer, int compactId) {
+    return db->addMusicalWork(title, author, performer, compactId);
+}
+
+bool SqliteStorage::updateCompactDisc(int compactId, const std::string& company, float price) {
+    return db->updateCompactDisc(compactId, company, price);
+}
+
+bool SqliteStorage::deleteCompactDisc(int compactId) {
+    return db->deleteCompactDisc(compactId);
+}
+
+int SqliteStorage::registerOperation(const std::string& operationType, int compactId, int quantity,
+                                     const std::string& operationDate) {
+    return db->registerOperation(operationType, compactId, quantity, operationDate);
+}
+
+long long SqliteStorage::getStockLevel(int compactId) {
+    return db->getStockLevel(compactId);
+}
+
+PeriodTotals SqliteStorage::getPeriodTotals(int compactId, const std::string& startDate,
+                                            const std::string& endDate) {
+    return db->getPeriodTotals(compactId, startDate, endDate);
+}
+
+std::vector<PerformerSales> SqliteStorage::getPerformerSales() {
+    return db->getPerformerSales();
+}
+
+std::vector<AuthorSales> SqliteStorage::getAuthorSales() {
+    return db->getAuthorSales();
+}
+
+InventoryValue SqliteStorage::getInventoryValue() {
+    return db->getInventoryValue();
+}
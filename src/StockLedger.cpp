@@ -0,0 +1,128 @@
+#include "../include/StockLedger.h"
+#include <algorithm>
+#include <limits>
+
+// Упаковка счетчика
+uint64_t StockLedger::pack(int32_t available, uint32_t pending) {
+    return (uint64_t(pending) << 32) | uint32_t(available);
+}
+
+// Доступный остаток из счетчика
+int32_t StockLedger::availableOf(uint64_t state) {
+    return static_cast<int32_t>(static_cast<uint32_t>(state));
+}
+
+// Зарезервированное количество из счетчика
+uint32_t StockLedger::pendingOf(uint64_t state) {
+    return static_cast<uint32_t>(state >> 32);
+}
+
+// Создание пустой таблицы
+StockLedger::StockLedger() : table(std::make_shared<const Table>()) {}
+
+// Поиск счетчика
+StockLedger::Counter* StockLedger::find(int compactId) const {
+    std::shared_ptr<const Table> current = table.load(std::memory_order_acquire);
+    auto it = current->find(compactId);
+    return it == current->end() ? nullptr : it->second;
+}
+
+// Поиск или создание счетчика
+StockLedger::Counter& StockLedger::findOrCreate(int compactId) {
+    if (Counter* counter = find(compactId)) {
+        return *counter;
+    }
+    insert({compactId});
+    return *find(compactId);
+}
+
+// Добавление счетчиков
+void StockLedger::insert(const std::vector<int>& compactIds) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::shared_ptr<const Table> previous = table.load(std::memory_order_acquire);
+    auto next = std::make_shared<Table>(*previous);
+    for (int compactId : compactIds) {
+        if (next->count(compactId) == 0) {
+            storage.push_back(std::make_unique<Counter>(pack(0, 0)));
+            next->emplace(compactId, storage.back().get());
+        }
+    }
+    if (next->size() != previous->size()) {
+        table.store(std::move(next), std::memory_order_release);
+    }
+}
+
+// Загрузка остатков
+void StockLedger::load(const std::vector<StockLevel>& levels) {
+    std::vector<int> compactIds;
+    compactIds.reserve(levels.size());
+    for (const auto& level : levels) {
+        compactIds.push_back(level.compactId);
+    }
+    insert(compactIds);
+    
+    for (const auto& level : levels) {
+        reconcile(level.compactId, level.remaining);
+    }
+}
+
+// Резервирование количества
+StockLedger::Reservation StockLedger::reserve(int compactId, int quantity) {
+    Counter* counter = find(compactId);
+    if (!counter) {
+        return Reservation::Unknown;
+    }
+    
+    uint64_t state = counter->state.load(std::memory_order_relaxed);
+    do {
+        if (quantity <= 0 || availableOf(state) < quantity) {
+            return Reservation::Insufficient;
+        }
+    } while (!counter->state.compare_exchange_weak(state, pack(availableOf(state) - quantity, pendingOf(state) + quantity),
+                                                   std::memory_order_acq_rel, std::memory_order_relaxed));
+    return Reservation::Reserved;
+}
+
+// Снятие резерва после записи продажи
+void StockLedger::commit(int compactId, int quantity) {
+    if (Counter* counter = find(compactId)) {
+        counter->state.fetch_sub(uint64_t(quantity) << 32, std::memory_order_acq_rel);
+    }
+}
+
+// Возврат резерва после ошибки
+void StockLedger::release(int compactId, int quantity) {
+    Counter* counter = find(compactId);
+    if (!counter) {
+        return;
+    }
+    
+    uint64_t state = counter->state.load(std::memory_order_relaxed);
+    while (!counter->state.compare_exchange_weak(state, pack(availableOf(state) + quantity, pendingOf(state) - quantity),
+                                                 std::memory_order_acq_rel, std::memory_order_relaxed)) {
+    }
+}
+
+// Сверка с остатком в базе
+void StockLedger::reconcile(int compactId, long long remaining) {
+    Counter& counter = findOrCreate(compactId);
+    uint64_t state = counter.state.load(std::memory_order_relaxed);
+    int32_t value;
+    do {
+        // Зарезервированное еще не записано в базу
+        value = static_cast<int32_t>(std::clamp<long long>(remaining - pendingOf(state), 0,
+                                                           std::numeric_limits<int32_t>::max()));
+    } while (!counter.state.compare_exchange_weak(state, pack(value, pendingOf(state)), std::memory_order_acq_rel,
+                                                  std::memory_order_relaxed));
+}
+
+// Доступный остаток
+long long StockLedger::available(int compactId) const {
+    Counter* counter = find(compactId);
+    return counter ? availableOf(counter->state.load(std::memory_order_acquire)) : -1;
+}
+
+// Количество дисков
+size_t StockLedger::size() const {
+    return table.load(std::memory_order_acquire)->size();
+}
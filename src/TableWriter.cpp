@@ -0,0 +1,365 @@
+#include "../include/TableWriter.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+
+namespace {
+
+// Кодовая точка занимает две позиции терминала (основные диапазоны CJK)
+bool isWide(unsigned int cp) {
+    return (cp >= 0x1100 && cp <= 0x115F) ||
+           (cp >= 0x2E80 && cp <= 0xA4CF) ||
+           (cp >= 0xAC00 && cp <= 0xD7A3) ||
+           (cp >= 0xF900 && cp <= 0xFAFF) ||
+           (cp >= 0xFE30 && cp <= 0xFE4F) ||
+           (cp >= 0xFF00 && cp <= 0xFF60) ||
+           (cp >= 0xFFE0 && cp <= 0xFFE6) ||
+           (cp >= 0x20000 && cp <= 0x3FFFD);
+}
+
+// Число по грамматике JSON: -?(0|[1-9]\d*)(\.\d+)?([eE][+-]?\d+)?
+bool isNumeric(std::string_view value) {
+    size_t pos = 0;
+    auto digits = [&]() {
+        size_t start = pos;
+        while (pos < value.size() && value[pos] >= '0' && value[pos] <= '9') {
+            pos++;
+        }
+        return pos - start;
+    };
+    
+    if (pos < value.size() && value[pos] == '-') {
+        pos++;
+    }
+    // Ведущие нули ("0012") не допускаются: такие значения остаются строками
+    if (pos < value.size() && value[pos] == '0') {
+        pos++;
+    } else if (digits() == 0) {
+        return false;
+    }
+    if (pos < value.size() && value[pos] == '.') {
+        pos++;
+        if (digits() == 0) {
+            return false;
+        }
+    }
+    if (pos < value.size() && (value[pos] == 'e' || value[pos] == 'E')) {
+        pos++;
+        if (pos < value.size() && (value[pos] == '+' || value[pos] == '-')) {
+            pos++;
+        }
+        if (digits() == 0) {
+            return false;
+        }
+    }
+    return pos == value.size();
+}
+
+// Дописывание значения CSV
+template <typename String>
+void appendCsv(String& out, std::string_view value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        out += value;
+        return;
+    }
+    
+    out += '"';
+    for (char c : value) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+// Дописывание строки JSON
+template <typename String>
+void appendJson(String& out, std::string_view value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+// Дописывание значения JSON
+template <typename String>
+void appendJsonNumberOrString(String& out, std::string_view value) {
+    if (isNumeric(value)) {
+        out += value;
+    } else {
+        appendJson(out, value);
+    }
+}
+
+} // namespace
+
+// Конструктор
+TableWriter::TableWriter(Format format, std::pmr::memory_resource* resource)
+    : format(format), resource(resource), header(resource), rows(resource) {
+}
+
+// Установка заголовков колонок
+void TableWriter::setHeader(std::initializer_list<std::string_view> columns) {
+    header.assign(columns.begin(), columns.end());
+}
+
+void TableWriter::setHeader(const std::vector<std::string>& columns) {
+    header.assign(columns.begin(), columns.end());
+}
+
+// Добавление заголовка колонки
+void TableWriter::addHeaderColumn(std::string_view column) {
+    header.emplace_back(column);
+}
+
+// Добавление строки
+void TableWriter::addRow(std::initializer_list<std::string_view> cells) {
+    rows.emplace_back().assign(cells.begin(), cells.end());
+}
+
+void TableWriter::addRow(const std::vector<std::string>& cells) {
+    rows.emplace_back().assign(cells.begin(), cells.end());
+}
+
+// Начало новой строки
+void TableWriter::beginRow() {
+    rows.emplace_back();
+}
+
+// Добавление ячейки в последнюю строку
+void TableWriter::addCell(std::string_view cell) {
+    rows.back().emplace_back(cell);
+}
+
+// Ширина строки UTF-8 в позициях терминала
+size_t TableWriter::displayWidth(std::string_view text) {
+    size_t width = 0;
+    size_t i = 0;
+
+    while (i < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        unsigned int cp = c;
+        size_t length = 1;
+
+        if (c >= 0xF0) {
+            cp = c & 0x07;
+            length = 4;
+        } else if (c >= 0xE0) {
+            cp = c & 0x0F;
+            length = 3;
+        } else if (c >= 0xC0) {
+            cp = c & 0x1F;
+            length = 2;
+        }
+
+        for (size_t k = 1; k < length && i + k < text.size(); k++) {
+            cp = (cp << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+        }
+
+        width += isWide(cp) ? 2 : 1;
+        i += length;
+    }
+
+    return width;
+}
+
+// Форматирование числа
+std::string TableWriter::formatNumber(double value) {
+    // Кратчайшая запись, из которой читается то же значение: выгрузки не теряют разрядов
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, result.ptr);
+}
+
+// Разбор названия формата
+bool TableWriter::parseFormat(const std::string& name, Format& format) {
+    if (name == "text") {
+        format = Format::Text;
+    } else if (name == "csv") {
+        format = Format::Csv;
+    } else if (name == "tsv") {
+        format = Format::Tsv;
+    } else if (name == "json") {
+        format = Format::Json;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Дописывание значения CSV
+void TableWriter::appendCsvField(std::string& out, std::string_view value) {
+    appendCsv(out, value);
+}
+
+void TableWriter::appendCsvField(std::pmr::string& out, std::string_view value) {
+    appendCsv(out, value);
+}
+
+// Дописывание строки JSON
+void TableWriter::appendJsonString(std::string& out, std::string_view value) {
+    appendJson(out, value);
+}
+
+void TableWriter::appendJsonString(std::pmr::string& out, std::string_view value) {
+    appendJson(out, value);
+}
+
+// Дописывание значения JSON
+void TableWriter::appendJsonValue(std::string& out, std::string_view value) {
+    appendJsonNumberOrString(out, value);
+}
+
+void TableWriter::appendJsonValue(std::pmr::string& out, std::string_view value) {
+    appendJsonNumberOrString(out, value);
+}
+
+// Выровненная таблица
+template <typename String>
+void TableWriter::renderText(String& out) const {
+    size_t columns = header.size();
+    for (const auto& row : rows) {
+        columns = std::max(columns, row.size());
+    }
+
+    std::pmr::vector<size_t> widths(columns, 0, resource);
+    for (size_t i = 0; i < header.size(); i++) {
+        widths[i] = displayWidth(header[i]);
+    }
+    for (const auto& row : rows) {
+        for (size_t i = 0; i < row.size(); i++) {
+            widths[i] = std::max(widths[i], displayWidth(row[i]));
+        }
+    }
+
+    auto appendLine = [&](const std::pmr::vector<std::pmr::string>& cells) {
+        for (size_t i = 0; i < columns; i++) {
+            std::string_view cell = i < cells.size() ? std::string_view(cells[i]) : std::string_view();
+            out += cell;
+            if (i + 1 < columns) {
+                out.append(widths[i] - displayWidth(cell), ' ');
+                out += " | ";
+            }
+        }
+        out += '\n';
+    };
+
+    if (!header.empty()) {
+        appendLine(header);
+        size_t total = 0;
+        for (size_t width : widths) {
+            total += width + 3;
+        }
+        out.append(total > 3 ? total - 3 : total, '-');
+        out += '\n';
+    }
+
+    for (const auto& row : rows) {
+        appendLine(row);
+    }
+}
+
+// CSV и TSV
+template <typename String>
+void TableWriter::renderDelimited(String& out, char delimiter) const {
+    auto appendLine = [&](const std::pmr::vector<std::pmr::string>& cells) {
+        for (size_t i = 0; i < cells.size(); i++) {
+            if (i > 0) {
+                out += delimiter;
+            }
+            if (delimiter == ',') {
+                appendCsv(out, cells[i]);
+            } else {
+                // В TSV табуляция и перевод строки внутри значения заменяются пробелом
+                for (char c : cells[i]) {
+                    out += (c == '\t' || c == '\n' || c == '\r') ? ' ' : c;
+                }
+            }
+        }
+        out += delimiter == ',' ? "\r\n" : "\n";
+    };
+
+    if (!header.empty()) {
+        appendLine(header);
+    }
+    for (const auto& row : rows) {
+        appendLine(row);
+    }
+}
+
+// Массив JSON-объектов
+template <typename String>
+void TableWriter::renderJson(String& out) const {
+    out += '[';
+    for (size_t r = 0; r < rows.size(); r++) {
+        out += r == 0 ? "\n  {" : ",\n  {";
+        for (size_t i = 0; i < rows[r].size(); i++) {
+            if (i > 0) {
+                out += ", ";
+            }
+            if (i < header.size()) {
+                appendJson(out, header[i]);
+            } else {
+                appendJson(out, "column" + std::to_string(i + 1));
+            }
+            out += ": ";
+            appendJsonNumberOrString(out, rows[r][i]);
+        }
+        out += '}';
+    }
+    out += rows.empty() ? "]\n" : "\n]\n";
+}
+
+// Формирование отчета в строке
+template <typename String>
+void TableWriter::renderTo(String& out) const {
+    // Примерный размер, чтобы строка не перераспределялась на каждой строке отчета
+    out.reserve((rows.size() + 2) * (header.size() + 1) * 24);
+
+    switch (format) {
+        case Format::Text:
+            renderText(out);
+            break;
+        case Format::Csv:
+            renderDelimited(out, ',');
+            break;
+        case Format::Tsv:
+            renderDelimited(out, '\t');
+            break;
+        case Format::Json:
+            renderJson(out);
+            break;
+    }
+}
+
+// Формирование отчета в памяти
+std::string TableWriter::render() const {
+    std::string out;
+    renderTo(out);
+    return out;
+}
+
+// Вывод отчета в поток
+void TableWriter::write(std::ostream& out) const {
+    // Буфер вывода берется из того же ресурса, что и ячейки
+    std::pmr::string text(resource);
+    renderTo(text);
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    out.flush();
+}
@@ -1,6 +1,58 @@
 #include "../include/UserInterface.h"
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+// Буфер вывода пакетного режима: std::endl не сбрасывает данные,
+// они уходят в целевой поток блоками по 64 КБ
+class BatchOutputBuffer : public std::streambuf {
+private:
+    std::streambuf* target;
+    std::vector<char> buffer;
+    
+    void flushBuffer() {
+        std::ptrdiff_t size = pptr() - pbase();
+        if (size > 0) {
+            target->sputn(pbase(), size);
+        }
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        flushBuffer();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+    
+    int sync() override {
+        return 0;
+    }
+
+public:
+    explicit BatchOutputBuffer(std::streambuf* target) : target(target), buffer(64 * 1024) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+    
+    ~BatchOutputBuffer() override {
+        flushBuffer();
+        target->pubsync();
+    }
+};
+
+} // namespace
 
 // Конструктор
 UserInterface::UserInterface(std::shared_ptr<MusicStoreDB> db) 
@@ -67,9 +119,10 @@ void UserInterface::displayAdminMenu() {
         std::cout << "10. Зарегистрировать продажу компакт-дисков" << std::endl;
         std::cout << "11. Обновить информацию о компакт-диске" << std::endl;
         std::cout << "12. Удалить компакт-диск" << std::endl;
+        std::cout << "13. Поиск по каталогу" << std::endl;
         std::cout << "0. Выход" << std::endl;
         
-        int choice = getMenuChoice(0, 12);
+        int choice = getMenuChoice(0, 13);
         if (choice == 0) {
             break;
         }
@@ -85,9 +138,10 @@ void UserInterface::displayUserMenu() {
         std::cout << "1. Просмотреть информацию о самом популярном компакт-диске" << std::endl;
         std::cout << "2. Просмотреть информацию о самом популярном исполнителе" << std::endl;
         std::cout << "3. Получить информацию о продажах компакт-диска" << std::endl;
+        std::cout << "4. Поиск по каталогу" << std::endl;
         std::cout << "0. Выход" << std::endl;
         
-        int choice = getMenuChoice(0, 3);
+        int choice = getMenuChoice(0, 4);
         if (choice == 0) {
             break;
         }
@@ -122,24 +176,106 @@ int UserInterface::getMenuChoice(int min, int max) {
     return choice;
 }
 
+// Выполнение долгого отчета в рабочем потоке
+void UserInterface::runReport(const std::function<void()>& report) {
+    if (!isatty(STDIN_FILENO)) {
+        report();
+        return;
+    }
+    
+    // Остаток строки с выбором пункта меню не должен считаться командой отмены
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    
+    std::atomic<long long> steps(0);
+    std::atomic<bool> done(false);
+    db->resetInterrupt();
+    db->setProgressCallback([&steps](long long current) { steps = current; });
+    
+    std::thread worker([&]() {
+        report();
+        done = true;
+    });
+    
+    bool progressShown = false;
+    while (!done) {
+        pollfd input = {STDIN_FILENO, POLLIN, 0};
+        if (poll(&input, 1, 250) > 0) {
+            std::string line;
+            std::getline(std::cin, line);
+            if (line == "q" || line == "Q") {
+                db->cancelQuery();
+            }
+            continue;
+        }
+        
+        if (!done) {
+            // Строка хода выполнения выводится в поток ошибок и не смешивается с отчетом
+            std::cerr << "\rВыполняется отчет, шагов: " << steps << " (для отмены введите q и нажмите Enter)"
+                      << std::flush;
+            progressShown = true;
+        }
+    }
+    
+    worker.join();
+    db->setProgressCallback(nullptr);
+    
+    if (progressShown) {
+        std::cerr << "\r" << std::string(80, ' ') << "\r" << std::flush;
+    }
+    
+    switch (db->lastInterrupt()) {
+        case QueryInterrupt::Cancelled:
+            std::cout << "Отчет отменен." << std::endl;
+            break;
+        case QueryInterrupt::Timeout:
+            std::cout << "Отчет прерван: превышено время выполнения запроса." << std::endl;
+            break;
+        case QueryInterrupt::None:
+            break;
+    }
+    db->resetInterrupt();
+}
+
 // Обработка команд администратора
 void UserInterface::processAdminCommand(int choice) {
     switch (choice) {
-        case 1:
-            db->showCompactInventory();
+        case 1: {
+            // Отчет выводится страницами по размеру экрана терминала
+            const int pageSize = 30;
+            std::string token = db->showCompactInventoryPage(pageSize);
+            
+            while (!token.empty()) {
+                std::cout << "Показать следующую страницу? (1 - Да, 0 - Нет): ";
+                int more;
+                std::cin >> more;
+                if (more != 1) {
+                    break;
+                }
+                token = db->showCompactInventoryPage(pageSize, token);
+            }
             break;
+        }
         case 2: {
-            int compactId;
+            std::string compactIds;
             std::string startDate, endDate;
             
-            std::cout << "Введите ID компакт-диска: ";
-            std::cin >> compactId;
+            std::cout << "Введите ID компакт-диска (несколько - через запятую): ";
+            std::cin >> compactIds;
             std::cout << "Введите начальную дату (YYYY-MM-DD): ";
             std::cin >> startDate;
             std::cout << "Введите конечную дату (YYYY-MM-DD): ";
             std::cin >> endDate;
             
-            db->showCompactSales(compactId, startDate, endDate);
+            // Несколько дисков - одним запросом с итоговой строкой
+            std::optional<std::vector<int>> ids = parseIdList(compactIds);
+            if (!ids) {
+                break;
+            }
+            if (ids->size() == 1) {
+                db->showCompactSales(ids->front(), startDate, endDate);
+            } else {
+                db->showDiscSales(*ids, startDate, endDate);
+            }
             break;
         }
         case 3:
@@ -149,7 +285,7 @@ void UserInterface::processAdminCommand(int choice) {
             db->showMostPopularPerformer();
             break;
         case 5:
-            db->showAuthorSales();
+            runReport([this]() { db->showAuthorSales(); });
             break;
         case 6: {
             std::string startDate, endDate;
@@ -159,7 +295,7 @@ void UserInterface::processAdminCommand(int choice) {
             std::cout << "Введите конечную дату (YYYY-MM-DD): ";
             std::cin >> endDate;
             
-            db->calculatePeriodStatistics(startDate, endDate);
+            runReport([&]() { db->calculatePeriodStatistics(startDate, endDate); });
             break;
         }
         case 7: {
@@ -241,6 +377,9 @@ void UserInterface::processAdminCommand(int choice) {
             db->deleteCompactDisc(compactId);
             break;
         }
+        case 13:
+            searchCatalog();
+            break;
     }
 }
 
@@ -267,5 +406,437 @@ void UserInterface::processUserCommand(int choice) {
             db->getCompactSalesInfo(compactId, startDate, endDate);
             break;
         }
+        case 4:
+            searchCatalog();
+            break;
+    }
+}
+
+// Поиск по каталогу с постраничным просмотром
+void UserInterface::searchCatalog() {
+    const int pageSize = 20;
+    std::string text;
+    
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    std::cout << "Введите название, автора или исполнителя: ";
+    std::getline(std::cin, text);
+    
+    for (int page = 1; ; page++) {
+        if (!db->showCatalogSearch(text, page, pageSize)) {
+            break;
+        }
+        
+        std::cout << "Показать следующую страницу? (1 - Да, 0 - Нет): ";
+        int choice;
+        std::cin >> choice;
+        
+        if (choice != 1) {
+            break;
+        }
+    }
+}
+
+// Разбор строки пакетной команды
+std::vector<std::string> UserInterface::splitCommand(const std::string& line) {
+    std::vector<std::string> args;
+    std::string current;
+    bool inQuotes = false;
+    bool hasToken = false;
+    
+    for (char c : line) {
+        if (c == '"') {
+            inQuotes = !inQuotes;
+            hasToken = true;
+        } else if (!inQuotes && (c == ' ' || c == '\t' || c == '\r')) {
+            if (hasToken) {
+                args.push_back(current);
+                current.clear();
+                hasToken = false;
+            }
+        } else if (!inQuotes && c == '#' && !hasToken) {
+            // Комментарий до конца строки
+            break;
+        } else {
+            current += c;
+            hasToken = true;
+        }
     }
+    
+    if (hasToken) {
+        args.push_back(current);
+    }
+    
+    return args;
+}
+
+// Разбор списка идентификаторов
+std::optional<std::vector<int>> UserInterface::parseIdList(const std::string& text) {
+    // Ошибочный элемент отклоняет весь список: пропуск давал бы отчет не по тем дискам
+    std::vector<int> ids;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        
+        int value = 0;
+        const char* first = text.data() + start;
+        const char* last = text.data() + end;
+        auto [parsedEnd, error] = std::from_chars(first, last, value);
+        if (first == last || *first == '-' || error != std::errc() || parsedEnd != last) {
+            std::cerr << "Неверный список идентификаторов: " << text << std::endl;
+            return std::nullopt;
+        }
+        ids.push_back(value);
+        start = end + 1;
+    }
+    return ids;
+}
+
+// Разбор выбора компакт-дисков
+std::optional<DiscSelection> UserInterface::parseDiscSelection(const std::string& text) {
+    DiscSelection selection;
+    const std::string companyPrefix = "company:";
+    
+    if (text == "all") {
+        selection.all = true;
+    } else if (text.compare(0, companyPrefix.size(), companyPrefix) == 0) {
+        selection.company = text.substr(companyPrefix.size());
+    } else if (!text.empty() && text.find_first_not_of("0123456789,") == std::string::npos) {
+        // Пустые и повторяющиеся запятые - ошибка, а не пропуск: иначе опечатка давала бы пустой выбор
+        std::optional<std::vector<int>> ids = parseIdList(text);
+        if (!ids) {
+            return std::nullopt;
+        }
+        selection.compactIds = std::move(*ids);
+    } else {
+        selection.company = text;
+    }
+    
+    if (!selection.all && selection.compactIds.empty() && selection.company.empty()) {
+        std::cerr << "Не задан выбор компакт-дисков: " << text << std::endl;
+        return std::nullopt;
+    }
+    return selection;
+}
+
+// Выполнение одной пакетной команды
+bool UserInterface::executeBatchCommand(const std::vector<std::string>& args) {
+    const std::string& command = args[0];
+    size_t argc = args.size() - 1;
+    
+    try {
+        if (command == "login" && argc == 2) {
+            if (!db->login(args[1], args[2])) {
+                std::cerr << "Неверные учетные данные: " << args[1] << std::endl;
+                return false;
+            }
+            return true;
+        }
+        if (command == "timeout" && argc == 1) {
+            int seconds = std::stoi(args[1]);
+            if (seconds < 0) {
+                std::cerr << "Ограничение времени не может быть отрицательным" << std::endl;
+                return false;
+            }
+            db->setQueryTimeout(std::chrono::seconds(seconds));
+            return true;
+        }
+        if (command == "format" && argc == 1) {
+            TableWriter::Format format;
+            if (!TableWriter::parseFormat(args[1], format)) {
+                std::cerr << "Неизвестный формат вывода: " << args[1] << std::endl;
+                return false;
+            }
+            db->setOutputFormat(format);
+            return true;
+        }
+        
+        // Команды, доступные всем пользователям
+        if (command == "popular" && argc == 0) {
+            db->showMostPopularCompact();
+            return true;
+        }
+        if (command == "performer" && argc == 0) {
+            db->showMostPopularPerformer();
+            return true;
+        }
+        if (command == "search" && argc >= 1) {
+            db->showCatalogSearch(args[1], argc >= 2 ? std::stoi(args[2]) : 1);
+            return true;
+        }
+        if (command == "sales" && argc == 3 && args[1].find(',') != std::string::npos) {
+            std::optional<std::vector<int>> ids = parseIdList(args[1]);
+            if (!ids) {
+                return false;
+            }
+            db->showDiscSales(*ids, args[2], args[3]);
+            return true;
+        }
+        if (command == "label-sales" && argc == 3) {
+            db->showCompanySales(args[1], args[2], args[3]);
+            return true;
+        }
+        if (command == "sales" && argc == 3) {
+            if (db->isUserAdmin()) {
+                db->showCompactSales(std::stoi(args[1]), args[2], args[3]);
+            } else {
+                db->getCompactSalesInfo(std::stoi(args[1]), args[2], args[3]);
+            }
+            return true;
+        }
+        
+        bool adminCommand =
+            command == "inventory" || command == "authors" || command == "report" || command == "compare" ||
+            command == "series" || command == "sale" || command == "receipt" || command == "add-disc" ||
+            command == "add-work" || command == "update-disc" || command == "delete-disc" ||
+            command == "export" || command == "import" || command == "backup" ||
+            command == "reprice" || command == "reassign" || command == "delete-unsold";
+        
+        if (adminCommand && !db->isUserAdmin()) {
+            std::cerr << "Команда доступна только администратору: " << command << std::endl;
+            return false;
+        }
+        
+        if (command == "inventory" && argc == 0) {
+            db->showCompactInventory();
+            return true;
+        }
+        if (command == "authors" && argc == 0) {
+            db->showAuthorSales();
+            return true;
+        }
+        if (command == "report" && argc == 2) {
+            db->calculatePeriodStatistics(args[1], args[2]);
+            return true;
+        }
+        if (command == "compare" && argc >= 2) {
+            // Периоды задаются как <начало>:<конец>
+            std::vector<ReportPeriod> periods;
+            for (size_t i = 1; i <= argc; i++) {
+                size_t colon = args[i].find(':');
+                if (colon == std::string::npos) {
+                    std::cerr << "Период задается как <начало>:<конец>: " << args[i] << std::endl;
+                    return false;
+                }
+                periods.push_back(ReportPeriod{args[i].substr(0, colon), args[i].substr(colon + 1)});
+            }
+            db->showPeriodComparison(periods);
+            return true;
+        }
+        if (command == "series" && (argc == 4 || argc == 5)) {
+            SeriesBucket bucket;
+            SeriesGrouping grouping;
+            if (args[1] == "day") {
+                bucket = SeriesBucket::Day;
+            } else if (args[1] == "week") {
+                bucket = SeriesBucket::Week;
+            } else if (args[1] == "month") {
+                bucket = SeriesBucket::Month;
+            } else {
+                std::cerr << "Интервал ряда - day, week или month: " << args[1] << std::endl;
+                return false;
+            }
+            if (args[2] == "disc") {
+                grouping = SeriesGrouping::Disc;
+            } else if (args[2] == "performer") {
+                grouping = SeriesGrouping::Performer;
+            } else if (args[2] == "author") {
+                grouping = SeriesGrouping::Author;
+            } else {
+                std::cerr << "Группировка ряда - disc, performer или author: " << args[2] << std::endl;
+                return false;
+            }
+            db->showSalesSeries(bucket, grouping, args[3], args[4], argc == 5 ? std::stoi(args[5]) : 7);
+            return true;
+        }
+        if (command == "sale" && argc == 2) {
+            return db->registerOperation("продажа", std::stoi(args[1]), std::stoi(args[2])) > 0;
+        }
+        if (command == "receipt" && argc == 2) {
+            return db->registerOperation("поступление", std::stoi(args[1]), std::stoi(args[2])) > 0;
+        }
+        if (command == "add-disc" && argc == 3) {
+            return db->addCompactDisc(args[1], args[2], std::stof(args[3])) > 0;
+        }
+        if (command == "add-work" && argc == 4) {
+            return db->addMusicalWork(args[2], args[3], args[4], std::stoi(args[1])) > 0;
+        }
+        if (command == "update-disc" && argc == 3) {
+            return db->updateCompactDisc(std::stoi(args[1]), args[2], std::stof(args[3]));
+        }
+        if (command == "delete-disc" && argc == 1) {
+            return db->deleteCompactDisc(std::stoi(args[1]));
+        }
+        if ((command == "reprice" || command == "reassign" || command == "delete-unsold") &&
+            (argc >= 1 && argc <= 3)) {
+            // Последний аргумент dry-run только подсчитывает затрагиваемые диски
+            bool dryRun = args.back() == "dry-run";
+            size_t valueCount = argc - (dryRun ? 1 : 0);
+            std::optional<DiscSelection> selection = parseDiscSelection(args[1]);
+            if (!selection) {
+                return false;
+            }
+            
+            if (command == "reprice" && valueCount == 2) {
+                return db->repriceDiscs(*selection, std::stod(args[2]), dryRun) >= 0;
+            }
+            if (command == "reassign" && valueCount == 2) {
+                return db->reassignCompany(*selection, args[2], dryRun) >= 0;
+            }
+            if (command == "delete-unsold" && valueCount == 1) {
+                return db->deleteUnsoldDiscs(*selection, dryRun) >= 0;
+            }
+        }
+        if (command == "export" && (argc == 2 || argc == 4)) {
+            ExportWriter::Format format;
+            bool compress = false;
+            if (!ExportWriter::formatFromPath(args[2], format, compress)) {
+                std::cerr << "Формат выгрузки определяется расширением .csv, .ndjson или .jsonl: "
+                          << args[2] << std::endl;
+                return false;
+            }
+            
+            long long rows;
+            if (args[1] == "operations" && argc == 4) {
+                rows = db->exportOperations(args[2], args[3], args[4], format, compress);
+            } else if (args[1] == "catalog" && argc == 2) {
+                rows = db->exportCatalog(args[2], format, compress);
+            } else if (argc == 2) {
+                rows = db->exportReport(args[1], args[2], format, compress);
+            } else {
+                rows = -1;
+            }
+            
+            if (rows < 0) {
+                return false;
+            }
+            std::cout << "Выгружено строк: " << rows << std::endl;
+            return true;
+        }
+        if (command == "backup" && argc == 1) {
+            const std::string& target = args[1];
+            bool compress = target.size() > 3 && target.compare(target.size() - 3, 3, ".gz") == 0;
+            if (!db->backupTo(target, compress)) {
+                return false;
+            }
+            std::cout << "Резервная копия создана: " << target << std::endl;
+            return true;
+        }
+        if (command == "import" && argc == 2) {
+            ImportKind kind;
+            if (args[1] == "discs") {
+                kind = ImportKind::Discs;
+            } else if (args[1] == "works") {
+                kind = ImportKind::Works;
+            } else if (args[1] == "operations") {
+                kind = ImportKind::Operations;
+            } else {
+                std::cerr << "Неизвестный вид импорта: " << args[1] << std::endl;
+                return false;
+            }
+            
+            ImportResult result = db->importCsv(kind, args[2]);
+            return result.completed && result.rejected == 0;
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Неверные аргументы команды: " << command << std::endl;
+        return false;
+    }
+    
+    std::cerr << "Неизвестная команда или неверное число аргументов: " << command << std::endl;
+    return false;
+}
+
+// Пакетный режим
+int UserInterface::runBatch(std::istream& in, std::ostream& out, int transactionSize) {
+    // Весь вывод методов базы данных идет в буфер пакетного режима
+    BatchOutputBuffer buffer(out.rdbuf());
+    std::streambuf* oldCout = std::cout.rdbuf(&buffer);
+    
+    int failed = 0;
+    int inTransaction = 0;
+    int lineNumber = 0;
+    bool transactionOpen = false;
+    std::vector<int> pendingLines; // Выполненные команды незафиксированной транзакции
+    std::string line;
+    
+    // Откат транзакции: выполненные в ней команды не сохранены и считаются невыполненными
+    auto discardPending = [&]() {
+        for (int pendingLine : pendingLines) {
+            std::cerr << "Строка " << pendingLine << ": изменения отменены, транзакция не зафиксирована" << std::endl;
+        }
+        failed += static_cast<int>(pendingLines.size());
+        pendingLines.clear();
+        transactionOpen = false;
+        inTransaction = 0;
+    };
+    
+    auto commitPending = [&]() {
+        if (!transactionOpen) {
+            return;
+        }
+        if (db->commitTransaction()) {
+            pendingLines.clear();
+            transactionOpen = false;
+            inTransaction = 0;
+            return;
+        }
+        if (db->inTransaction()) {
+            db->rollbackTransaction();
+        }
+        discardPending();
+    };
+    
+    while (std::getline(in, line)) {
+        lineNumber++;
+        
+        std::vector<std::string> args = splitCommand(line);
+        if (args.empty()) {
+            continue;
+        }
+        
+        // Резервная копия снимается вне транзакции: накопленные команды фиксируются до нее
+        bool outsideTransaction = args[0] == "backup";
+        if (outsideTransaction) {
+            commitPending();
+        }
+        
+        // SQLite мог откатить транзакцию после ошибки предыдущей команды
+        if (transactionOpen && !db->inTransaction()) {
+            discardPending();
+        }
+        
+        if (transactionSize > 0 && !transactionOpen && !outsideTransaction) {
+            // Без транзакции команда не выполняется: иначе она молча ушла бы в автофиксацию
+            if (!db->beginTransaction()) {
+                std::cerr << "Строка " << lineNumber << ": не удалось начать транзакцию" << std::endl;
+                failed++;
+                continue;
+            }
+            transactionOpen = true;
+        }
+        
+        // Отчет, прерванный по времени, считается невыполненной командой
+        bool succeeded = executeBatchCommand(args) && db->lastInterrupt() == QueryInterrupt::None;
+        db->resetInterrupt();
+        
+        if (!succeeded) {
+            std::cerr << "Строка " << lineNumber << ": команда не выполнена" << std::endl;
+            failed++;
+        } else if (transactionOpen) {
+            pendingLines.push_back(lineNumber);
+        }
+        
+        // Каждые transactionSize команд фиксируются одной транзакцией
+        if (transactionOpen && ++inTransaction == transactionSize) {
+            commitPending();
+        }
+    }
+    
+    commitPending();
+    
+    std::cout.rdbuf(oldCout);
+    return failed;
 }
\ No newline at end of file
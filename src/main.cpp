@@ -1,17 +1,126 @@
 #include "../include/MusicStoreDB.h"
 #include "../include/UserInterface.h"
+#include "../include/ShardSet.h"
+#include "../include/RpcServer.h"
+#include <csignal>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
-int main() {
+namespace {
+
+// Сервер, останавливаемый по SIGINT/SIGTERM
+RpcServer* activeServer = nullptr;
+
+void stopServer(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
     // Установка русской локали для корректного отображения кириллицы
     std::setlocale(LC_ALL, "Russian");
     
     std::cout << "=== Музыкальный салон - Консольное приложение ===" << std::endl;
     
     try {
+        // Сводный отчет по нескольким магазинам: --shards <db1> <db2> ...
+        if (argc > 1 && std::string(argv[1]) == "--shards") {
+            std::vector<std::string> paths(argv + 2, argv + argc);
+            if (paths.empty()) {
+                std::cerr << "Не указаны файлы баз данных магазинов" << std::endl;
+                return 1;
+            }
+            
+            ShardSet shards(paths);
+            shards.showChainReport();
+            return 0;
+        }
+        
+        // Копия для отчетов: --readonly <файл> или --immutable <файл> перед остальными параметрами
+        std::string dbPath = "music_store.db";
+        OpenMode mode = OpenMode::ReadWrite;
+        int first = 1;
+        if (argc > 2 && (std::string(argv[1]) == "--readonly" || std::string(argv[1]) == "--immutable")) {
+            mode = std::string(argv[1]) == "--readonly" ? OpenMode::ReadOnly : OpenMode::Immutable;
+            dbPath = argv[2];
+            first = 3;
+        }
+        
+        // Режим сервера: --server <сокет> [--workers N]
+        if (argc > first + 1 && std::string(argv[first]) == "--server") {
+            std::string socketPath = argv[first + 1];
+            size_t workers = 4;
+            if (argc > first + 3 && std::string(argv[first + 2]) == "--workers") {
+                workers = std::stoul(argv[first + 3]);
+            }
+            
+            RpcServer server(dbPath, socketPath, workers, mode);
+            if (!server.listen()) {
+                return 1;
+            }
+            
+            activeServer = &server;
+            std::signal(SIGINT, stopServer);
+            std::signal(SIGTERM, stopServer);
+            std::cout << "Сервер слушает " << socketPath << " (" << workers << " потоков)" << std::endl;
+            server.run();
+            activeServer = nullptr;
+            
+            std::cout << "Обработано запросов: " << server.requestCount() << std::endl;
+            return 0;
+        }
+        
         // Создание объекта базы данных
-        std::shared_ptr<MusicStoreDB> db = std::make_shared<MusicStoreDB>("music_store.db");
+        std::shared_ptr<MusicStoreDB> db = std::make_shared<MusicStoreDB>(dbPath, mode);
+        
+        // Резервная копия: --backup <файл> (суффикс .gz - сжатая копия)
+        if (argc > first + 1 && std::string(argv[first]) == "--backup") {
+            std::string target = argv[first + 1];
+            bool compress = target.size() > 3 && target.compare(target.size() - 3, 3, ".gz") == 0;
+            
+            bool ok = db->backupTo(target, compress, 128, std::chrono::milliseconds(10),
+                                   [](int remaining, int total) {
+                                       int percent = total > 0 ? 100 * (total - remaining) / total : 100;
+                                       std::cout << "\rРезервное копирование: " << percent << "%" << std::flush;
+                                   });
+            std::cout << std::endl;
+            
+            if (!ok) {
+                return 1;
+            }
+            std::cout << "Резервная копия создана: " << target << std::endl;
+            return 0;
+        }
+        
+        // Пакетный режим: --batch <файл|-> [--tx N]
+        if (argc > first + 1 && std::string(argv[first]) == "--batch") {
+            std::string source = argv[first + 1];
+            int transactionSize = 0;
+            if (argc > first + 3 && std::string(argv[first + 2]) == "--tx") {
+                transactionSize = std::stoi(argv[first + 3]);
+            }
+            
+            UserInterface ui(db);
+            int failed;
+            if (source == "-") {
+                failed = ui.runBatch(std::cin, std::cout, transactionSize);
+            } else {
+                std::ifstream script(source);
+                if (!script) {
+                    std::cerr << "Не удалось открыть файл команд: " << source << std::endl;
+                    return 1;
+                }
+                failed = ui.runBatch(script, std::cout, transactionSize);
+            }
+            
+            return failed == 0 ? 0 : 2;
+        }
         
         // Создание и запуск пользовательского интерфейса
         UserInterface ui(db); // false - изначально не администратор
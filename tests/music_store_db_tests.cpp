@@ -1,9 +1,18 @@
 #include <gtest/gtest.h>
 #include "../include/MusicStoreDB.h"
+#include "../include/MemoryStorage.h"
+#include "../include/SqliteStorage.h"
+#include "../include/Query.h"
+#include "../include/PasswordHash.h"
+#include "../include/SessionManager.h"
+#include "../include/RpcProtocol.h"
 #include <memory>
 #include <string>
 #include <filesystem>
 #include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <thread>
 
 class MusicStoreDBTest : public ::testing::Test {
 protected:
@@ -217,4 +226,1374 @@ TEST_F(MusicStoreDBTest, UserPermissionsTest) {
     
     // Basic output should be available, though might be empty in fresh DB
     EXPECT_FALSE(output.empty());
-}
\ No newline at end of file
+}
+// Test change data capture feed
+TEST_F(MusicStoreDBTest, ChangeFeedTest) {
+    std::string logPath = "test_change_feed.log";
+    std::filesystem::remove(logPath);
+    
+    ASSERT_TRUE(db->enableChangeFeed(logPath));
+    
+    // A second writer on the same log is refused
+    {
+        MusicStoreDB other(testDbPath);
+        std::string error = captureError([&]() { EXPECT_FALSE(other.enableChangeFeed(logPath)); });
+        EXPECT_TRUE(error.find("другим процессом") != std::string::npos);
+    }
+    
+    db->addCompactDisc("2023-01-01", "Sony Music", 19.99);
+    db->addMusicalWork("Song 1", "Author 1", "Performer 1", 1);
+    db->registerOperation("поступление", 1, 10);
+    db->updateCompactDisc(1, "Universal", 24.99);
+    
+    // Failed sale is rolled back and must not reach the feed
+    captureError([this]() { db->registerOperation("продажа", 1, 100); });
+    
+    const ChangeLog* feed = db->getChangeFeed();
+    ASSERT_NE(feed, nullptr);
+    EXPECT_EQ(feed->lastSequence(), 4u);
+    
+    auto changes = feed->readFrom(0);
+    ASSERT_EQ(changes.size(), 4u);
+    EXPECT_EQ(changes[0].sequence, 1u);
+    EXPECT_EQ(changes[0].table, ChangeTable::CompactDiscs);
+    EXPECT_EQ(changes[0].op, ChangeOp::Insert);
+    EXPECT_EQ(changes[1].table, ChangeTable::MusicalWorks);
+    EXPECT_EQ(changes[2].table, ChangeTable::Operations);
+    EXPECT_EQ(changes[3].op, ChangeOp::Update);
+    EXPECT_EQ(changes[3].rowId, 1);
+    
+    // A consumer resumes from the last processed sequence number
+    db->addCompactDisc("2023-02-01", "Warner", 9.99);
+    {
+        ChangeLog consumer(logPath, true);
+        auto delta = consumer.readFrom(4);
+        ASSERT_EQ(delta.size(), 1u);
+        EXPECT_EQ(delta[0].sequence, 5u);
+        EXPECT_EQ(delta[0].rowId, 2);
+    }
+    
+    db.reset();
+    std::filesystem::remove(logPath);
+}
+
+namespace {
+
+// VFS wrapper that fails writes to the WAL file on demand
+struct FaultyFile {
+    sqlite3_file base;
+    sqlite3_file* real;
+    bool wal;
+};
+
+sqlite3_vfs* realVfs = nullptr;
+bool failWalWrites = false;
+
+sqlite3_file* realFile(sqlite3_file* file) { return reinterpret_cast<FaultyFile*>(file)->real; }
+
+int faultyClose(sqlite3_file* f) { int rc = realFile(f)->pMethods->xClose(realFile(f)); return rc; }
+int faultyRead(sqlite3_file* f, void* b, int n, sqlite3_int64 o) { return realFile(f)->pMethods->xRead(realFile(f), b, n, o); }
+int faultyWrite(sqlite3_file* f, const void* b, int n, sqlite3_int64 o) {
+    if (failWalWrites && reinterpret_cast<FaultyFile*>(f)->wal) {
+        return SQLITE_IOERR_WRITE;
+    }
+    return realFile(f)->pMethods->xWrite(realFile(f), b, n, o);
+}
+int faultyTruncate(sqlite3_file* f, sqlite3_int64 s) { return realFile(f)->pMethods->xTruncate(realFile(f), s); }
+int faultySync(sqlite3_file* f, int flags) { return realFile(f)->pMethods->xSync(realFile(f), flags); }
+int faultyFileSize(sqlite3_file* f, sqlite3_int64* s) { return realFile(f)->pMethods->xFileSize(realFile(f), s); }
+int faultyLock(sqlite3_file* f, int l) { return realFile(f)->pMethods->xLock(realFile(f), l); }
+int faultyUnlock(sqlite3_file* f, int l) { return realFile(f)->pMethods->xUnlock(realFile(f), l); }
+int faultyCheckReservedLock(sqlite3_file* f, int* r) { return realFile(f)->pMethods->xCheckReservedLock(realFile(f), r); }
+int faultyFileControl(sqlite3_file* f, int op, void* a) { return realFile(f)->pMethods->xFileControl(realFile(f), op, a); }
+int faultySectorSize(sqlite3_file* f) { return realFile(f)->pMethods->xSectorSize(realFile(f)); }
+int faultyDeviceCharacteristics(sqlite3_file* f) { return realFile(f)->pMethods->xDeviceCharacteristics(realFile(f)); }
+int faultyShmMap(sqlite3_file* f, int r, int s, int e, void volatile** p) { return realFile(f)->pMethods->xShmMap(realFile(f), r, s, e, p); }
+int faultyShmLock(sqlite3_file* f, int o, int n, int flags) { return realFile(f)->pMethods->xShmLock(realFile(f), o, n, flags); }
+void faultyShmBarrier(sqlite3_file* f) { realFile(f)->pMethods->xShmBarrier(realFile(f)); }
+int faultyShmUnmap(sqlite3_file* f, int d) { return realFile(f)->pMethods->xShmUnmap(realFile(f), d); }
+int faultyFetch(sqlite3_file* f, sqlite3_int64 o, int n, void** p) { return realFile(f)->pMethods->xFetch(realFile(f), o, n, p); }
+int faultyUnfetch(sqlite3_file* f, sqlite3_int64 o, void* p) { return realFile(f)->pMethods->xUnfetch(realFile(f), o, p); }
+
+const sqlite3_io_methods faultyMethods = {
+    3, faultyClose, faultyRead, faultyWrite, faultyTruncate, faultySync, faultyFileSize,
+    faultyLock, faultyUnlock, faultyCheckReservedLock, faultyFileControl, faultySectorSize,
+    faultyDeviceCharacteristics, faultyShmMap, faultyShmLock, faultyShmBarrier, faultyShmUnmap,
+    faultyFetch, faultyUnfetch
+};
+
+int faultyOpen(sqlite3_vfs*, sqlite3_filename name, sqlite3_file* file, int flags, int* outFlags) {
+    auto* faulty = reinterpret_cast<FaultyFile*>(file);
+    faulty->base.pMethods = nullptr;
+    faulty->real = reinterpret_cast<sqlite3_file*>(faulty + 1);
+    faulty->wal = (flags & SQLITE_OPEN_WAL) != 0;
+    int rc = realVfs->xOpen(realVfs, name, faulty->real, flags, outFlags);
+    if (faulty->real->pMethods) {
+        faulty->base.pMethods = &faultyMethods;
+    }
+    return rc;
+}
+
+} // namespace
+
+// Test that a commit failing after the commit hook leaves the feed untouched
+TEST_F(MusicStoreDBTest, ChangeFeedFailedCommitTest) {
+    std::string logPath = "test_change_feed_failed.log";
+    std::filesystem::remove(logPath);
+    db.reset();
+    std::filesystem::remove(testDbPath);
+    
+    realVfs = sqlite3_vfs_find(nullptr);
+    sqlite3_vfs faultyVfs = *realVfs;
+    faultyVfs.zName = "faulty";
+    faultyVfs.szOsFile = static_cast<int>(sizeof(FaultyFile)) + realVfs->szOsFile;
+    faultyVfs.xOpen = faultyOpen;
+    ASSERT_EQ(sqlite3_vfs_register(&faultyVfs, 1), SQLITE_OK);
+    
+    db = std::make_shared<MusicStoreDB>(testDbPath);
+    db->login("admin", "admin");
+    ASSERT_TRUE(db->enableChangeFeed(logPath));
+    
+    db->addCompactDisc("2023-01-01", "Sony Music", 19.99);
+    ASSERT_EQ(db->getChangeFeed()->lastSequence(), 1u);
+    
+    // COMMIT writes the WAL frames after the commit hook has run
+    ASSERT_TRUE(db->beginTransaction());
+    db->addCompactDisc("2023-02-01", "Warner", 9.99);
+    failWalWrites = true;
+    std::string errors = captureError([this]() { EXPECT_FALSE(db->commitTransaction()); });
+    failWalWrites = false;
+    EXPECT_NE(errors.find("SQL error"), std::string::npos);
+    EXPECT_EQ(db->getChangeFeed()->lastSequence(), 1u);
+    
+    // The next successful commit publishes only its own changes
+    db->addCompactDisc("2023-03-01", "EMI", 14.99);
+    auto changes = db->getChangeFeed()->readFrom(0);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[1].rowId, 2);
+    
+    db.reset();
+    sqlite3_vfs_unregister(&faultyVfs);
+    std::filesystem::remove(logPath);
+}
+
+// Test full-text catalog search
+TEST_F(MusicStoreDBTest, CatalogSearchTest) {
+    setupTestData();
+    db->addMusicalWork("Лунная соната", "Бетховен", "Гилельс", 2);
+    
+    // Prefix match on title
+    auto results = db->searchCatalog("Son");
+    ASSERT_EQ(results.size(), 4u);
+    
+    // Cyrillic prefix, case-insensitive, with disc info
+    results = db->searchCatalog("лунн");
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].author, "Бетховен");
+    EXPECT_EQ(results[0].compactId, 2);
+    EXPECT_EQ(results[0].company, "Universal");
+    
+    // Column filter: "Author 1" wrote two works, Performer 1 performs two
+    results = db->searchCatalog("author:Author author:1");
+    EXPECT_EQ(results.size(), 2u);
+    
+    // Pagination
+    auto firstPage = db->searchCatalog("Song", 2, 0);
+    auto secondPage = db->searchCatalog("Song", 2, 2);
+    ASSERT_EQ(firstPage.size(), 2u);
+    ASSERT_EQ(secondPage.size(), 2u);
+    EXPECT_NE(firstPage[0].workId, secondPage[0].workId);
+    
+    // Printed page of results
+    std::string output = captureOutput([this]() { db->showCatalogSearch("Лунная"); });
+    EXPECT_TRUE(output.find("Гилельс") != std::string::npos);
+    
+    // The printed page reports whether another page follows: 4 "Song" works in pages of 2 and 3
+    bool hasMore = false;
+    output = captureOutput([&]() { hasMore = db->showCatalogSearch("Song", 1, 2); });
+    EXPECT_TRUE(hasMore);
+    output = captureOutput([&]() { hasMore = db->showCatalogSearch("Song", 2, 2); });
+    EXPECT_FALSE(hasMore);
+    output = captureOutput([&]() { hasMore = db->showCatalogSearch("Song", 1, 3); });
+    EXPECT_TRUE(hasMore);
+    
+    // Quotes in user input are not FTS syntax errors
+    std::string error = captureError([this]() { db->searchCatalog("\"Song"); });
+    EXPECT_TRUE(error.empty());
+}
+
+// Test keyset pagination of inventory and catalog
+TEST_F(MusicStoreDBTest, KeysetPaginationTest) {
+    setupTestData();
+    db->addCompactDisc("2023-05-01", "EMI", 9.99);
+    
+    // Remaining: disc 1 -> 10, disc 2 -> 10, disc 3 -> 8, disc 4 -> 0
+    auto first = db->getCompactInventoryPage(2);
+    ASSERT_EQ(first.rows.size(), 2u);
+    EXPECT_EQ(first.rows[0].compactId, 2);
+    EXPECT_EQ(first.rows[0].remaining, 10);
+    EXPECT_EQ(first.rows[1].compactId, 1);
+    EXPECT_DOUBLE_EQ(first.rows[1].stockValue, 10 * first.rows[1].price);
+    ASSERT_FALSE(first.nextToken.empty());
+    
+    // A sale between pages does not duplicate or skip rows before the cursor
+    db->registerOperation("продажа", 3, 1);
+    
+    auto second = db->getCompactInventoryPage(2, first.nextToken);
+    ASSERT_EQ(second.rows.size(), 2u);
+    EXPECT_EQ(second.rows[0].compactId, 3);
+    EXPECT_EQ(second.rows[0].remaining, 7);
+    EXPECT_EQ(second.rows[1].compactId, 4);
+    EXPECT_EQ(second.rows[1].remaining, 0);
+    EXPECT_TRUE(second.nextToken.empty());
+    
+    // Catalog is ordered by title
+    auto catalog = db->getCatalogPage(3);
+    ASSERT_EQ(catalog.rows.size(), 3u);
+    EXPECT_EQ(catalog.rows[0].title, "Song 1");
+    auto rest = db->getCatalogPage(3, catalog.nextToken);
+    ASSERT_EQ(rest.rows.size(), 1u);
+    EXPECT_EQ(rest.rows[0].title, "Song 4");
+    EXPECT_EQ(rest.rows[0].company, "Warner");
+    
+    // Tokens are not interchangeable between listings
+    std::string error = captureError([&]() { db->getCatalogPage(3, first.nextToken); });
+    EXPECT_TRUE(error.find("токен") != std::string::npos);
+    
+    std::string output = captureOutput([this]() { db->showCompactInventoryPage(30); });
+    EXPECT_TRUE(output.find("EMI") != std::string::npos);
+}
+
+// Test report rendering in the supported output formats
+TEST_F(MusicStoreDBTest, ReportOutputFormatTest) {
+    TableWriter text;
+    text.setHeader({"ID", "Компания"});
+    text.addRow({"1", "Мелодия"});
+    text.addRow({"22", "Sony"});
+    
+    // Columns are aligned by displayed characters, not by bytes
+    EXPECT_EQ(text.render(),
+              "ID | Компания\n"
+              "-------------\n"
+              "1  | Мелодия\n"
+              "22 | Sony\n");
+    
+    TableWriter csv(TableWriter::Format::Csv);
+    csv.setHeader({"title", "price"});
+    csv.addRow({"Hello, \"World\"", "9.5"});
+    EXPECT_EQ(csv.render(), "title,price\r\n\"Hello, \"\"World\"\"\",9.5\r\n");
+    
+    TableWriter json(TableWriter::Format::Json);
+    json.setHeader({"title", "price"});
+    json.addRow({"Line\n2", "9.5"});
+    EXPECT_EQ(json.render(), "[\n  {\"title\": \"Line\\n2\", \"price\": 9.5}\n]\n");
+    
+    // Only values matching the JSON number grammar are written unquoted
+    TableWriter numbers(TableWriter::Format::Json);
+    numbers.setHeader({"value"});
+    for (const char* value : {"+5", "5.", ".5", "-012", " 5", "0x10", "inf", "1e", "-"}) {
+        numbers.addRow({value});
+    }
+    for (const char* value : {"0", "-0.5", "12e3", "1.5E-2"}) {
+        numbers.addRow({value});
+    }
+    EXPECT_EQ(numbers.render(),
+              "[\n"
+              "  {\"value\": \"+5\"},\n  {\"value\": \"5.\"},\n  {\"value\": \".5\"},\n"
+              "  {\"value\": \"-012\"},\n  {\"value\": \" 5\"},\n  {\"value\": \"0x10\"},\n"
+              "  {\"value\": \"inf\"},\n  {\"value\": \"1e\"},\n  {\"value\": \"-\"},\n"
+              "  {\"value\": 0},\n  {\"value\": -0.5},\n  {\"value\": 12e3},\n  {\"value\": 1.5E-2}\n"
+              "]\n");
+    
+    // Numbers keep every significant digit
+    EXPECT_EQ(TableWriter::formatNumber(1234567.89), "1234567.89");
+    EXPECT_EQ(TableWriter::formatNumber(0.1), "0.1");
+    EXPECT_EQ(TableWriter::formatNumber(-3), "-3");
+    
+    // Reports switched to CSV contain no titles, only the header and rows
+    setupTestData();
+    db->setOutputFormat(TableWriter::Format::Csv);
+    std::stringstream buffer;
+    std::streambuf* oldCout = std::cout.rdbuf(buffer.rdbuf());
+    db->showMostPopularPerformer();
+    std::cout.rdbuf(oldCout);
+    
+    std::string output = buffer.str();
+    EXPECT_EQ(output.find("==="), std::string::npos);
+    EXPECT_EQ(output.rfind("performer", 0), 0u);
+    EXPECT_NE(output.find("\r\nPerformer 1,12,"), std::string::npos);
+    
+    // A report with two tables is still a single JSON document
+    db->setOutputFormat(TableWriter::Format::Json);
+    std::string popular = captureOutput([this]() { db->showMostPopularCompact(); });
+    auto document = JsonValue::parse(popular);
+    ASSERT_TRUE(document.has_value()) << popular;
+    ASSERT_EQ((*document)["disc"].asArray().size(), 1u);
+    EXPECT_EQ((*document)["disc"].asArray()[0]["price"].asDouble(), 19.99);
+    EXPECT_EQ((*document)["works"].asArray().size(), 2u);
+}
+
+// Test streaming export of operations, catalog and reports
+TEST_F(MusicStoreDBTest, ExportTest) {
+    setupTestData();
+    
+    auto readFile = [](const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    };
+    
+    std::string csvPath = "test_export_operations.csv";
+    EXPECT_EQ(db->exportOperations(csvPath, "2000-01-01", "2100-12-31", ExportWriter::Format::Csv), 6);
+    std::string csv = readFile(csvPath);
+    EXPECT_EQ(csv.rfind("operation_id,operation_date,operation_type,compact_id,company,quantity,price,amount\r\n", 0), 0u);
+    EXPECT_NE(csv.find(",поступление,1,Sony Music,20,"), std::string::npos);
+    std::filesystem::remove(csvPath);
+    
+    // An empty period still produces a header
+    EXPECT_EQ(db->exportOperations(csvPath, "1990-01-01", "1990-12-31", ExportWriter::Format::Csv), 0);
+    std::filesystem::remove(csvPath);
+    
+    std::string jsonPath = "test_export_catalog.ndjson";
+    EXPECT_EQ(db->exportCatalog(jsonPath, ExportWriter::Format::Ndjson), 4);
+    std::string json = readFile(jsonPath);
+    EXPECT_EQ(std::count(json.begin(), json.end(), '\n'), 4);
+    EXPECT_NE(json.find("{\"compact_id\":1,\"production_date\":\"2023-01-01\",\"company\":\"Sony Music\","),
+              std::string::npos);
+    std::filesystem::remove(jsonPath);
+    
+    std::string reportPath = "test_export_authors.csv";
+    EXPECT_EQ(db->exportReport("authors", reportPath, ExportWriter::Format::Csv), 3);
+    EXPECT_EQ(db->exportReport("unknown", reportPath, ExportWriter::Format::Csv), -1);
+    std::filesystem::remove(reportPath);
+    
+    if (ExportWriter::compressionAvailable()) {
+        std::string gzPath = "test_export_operations.csv.gz";
+        EXPECT_EQ(db->exportOperations(gzPath, "2000-01-01", "2100-12-31", ExportWriter::Format::Csv, true), 6);
+        std::string gz = readFile(gzPath);
+        ASSERT_GE(gz.size(), 2u);
+        EXPECT_EQ(static_cast<unsigned char>(gz[0]), 0x1f);
+        EXPECT_EQ(static_cast<unsigned char>(gz[1]), 0x8b);
+        std::filesystem::remove(gzPath);
+    }
+    
+    // A cancelled export leaves the previous file intact and no partial file behind
+    ASSERT_EQ(db->exportOperations(csvPath, "2000-01-01", "2100-12-31", ExportWriter::Format::Csv), 6);
+    csv = readFile(csvPath);
+    {
+        sqlite3* raw = nullptr;
+        ASSERT_EQ(sqlite3_open(testDbPath.c_str(), &raw), SQLITE_OK);
+        ASSERT_EQ(sqlite3_exec(raw,
+                               "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 2000) "
+                               "INSERT INTO operations(operation_date, operation_type, compact_id, quantity) "
+                               "SELECT '2024-03-01', 'поступление', 1, 1 FROM n;",
+                               nullptr, nullptr, nullptr),
+                  SQLITE_OK);
+        sqlite3_close(raw);
+    }
+    db->setProgressCallback([&](long long) { db->cancelQuery(); });
+    captureError([&]() {
+        EXPECT_EQ(db->exportOperations(csvPath, "2000-01-01", "2100-12-31", ExportWriter::Format::Csv), -1);
+    });
+    db->setProgressCallback(nullptr);
+    db->resetInterrupt();
+    EXPECT_EQ(readFile(csvPath), csv);
+    EXPECT_FALSE(std::filesystem::exists(csvPath + ".part"));
+    std::filesystem::remove(csvPath);
+}
+
+// Test CSV import of discs, works and operations with external keys
+TEST_F(MusicStoreDBTest, CsvImportTest) {
+    auto writeFile = [](const std::string& path, const std::string& content) {
+        std::ofstream out(path, std::ios::binary);
+        out << content;
+    };
+    
+    // Quoted values with separators and line breaks must not be split between chunks
+    std::string discs = "production_date,price,disc_key,company\n";
+    for (int i = 1; i <= 200; i++) {
+        discs += "2024-02-01,9.5,K" + std::to_string(i) + ",\"Label, \"\"No\"\" " + std::to_string(i) + "\nLtd\"\n";
+    }
+    discs += "2024-02-01,abc,BAD,Broken\n";
+    writeFile("test_import_discs.csv", discs);
+    
+    ImportResult result = db->importCsv(ImportKind::Discs, "test_import_discs.csv", 4, 64);
+    EXPECT_TRUE(result.completed);
+    EXPECT_EQ(result.imported, 200);
+    EXPECT_EQ(result.rejected, 1);
+    
+    // Importing the same file again skips known keys
+    result = db->importCsv(ImportKind::Discs, "test_import_discs.csv", 2);
+    EXPECT_EQ(result.imported, 0);
+    EXPECT_EQ(result.skipped, 200);
+    
+    writeFile("test_import_works.csv",
+              "disc_key,title,author,performer\r\n"
+              "K7,Импортированная соната,Бетховен,Рихтер\r\n"
+              "K8,Second Song,Author,Performer\r\n"
+              "UNKNOWN,Lost Song,Author,Performer\r\n");
+    result = db->importCsv(ImportKind::Works, "test_import_works.csv", 2);
+    EXPECT_EQ(result.imported, 2);
+    EXPECT_EQ(result.rejected, 1);
+    
+    writeFile("test_import_operations.csv",
+              "disc_key,operation_date,operation_type,quantity\n"
+              "K7,2024-03-01,receipt,10\n"
+              "K7,2024-03-02,продажа,4\n"
+              "K8,2024-03-02,sale,1\n");
+    result = db->importCsv(ImportKind::Operations, "test_import_operations.csv");
+    EXPECT_EQ(result.imported, 2);
+    EXPECT_EQ(result.rejected, 1);
+    
+    // Imported works are indexed for full-text search
+    auto found = db->searchCatalog("соната");
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_EQ(found[0].company, "Label, \"No\" 7\nLtd");
+    
+    auto page = db->getCompactInventoryPage(1);
+    ASSERT_EQ(page.rows.size(), 1u);
+    EXPECT_EQ(page.rows[0].company, found[0].company);
+    EXPECT_EQ(page.rows[0].remaining, 6);
+    
+    std::filesystem::remove("test_import_discs.csv");
+    std::filesystem::remove("test_import_works.csv");
+    std::filesystem::remove("test_import_operations.csv");
+}
+
+// Test that a batched works import changes the schema once and stops when BEGIN fails
+TEST_F(MusicStoreDBTest, CsvImportFullTextTriggerTest) {
+    captureOutput([this]() { db->addCompactDisc("2023-01-01", "Sony Music", 10.0f); });
+    sqlite3* connection = nullptr;
+    ASSERT_EQ(sqlite3_open(testDbPath.c_str(), &connection), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(connection, "INSERT INTO import_keys VALUES ('D1', 1);", nullptr, nullptr, nullptr), SQLITE_OK);
+    auto scalar = [connection](const char* sql) {
+        sqlite3_stmt* stmt = nullptr;
+        EXPECT_EQ(sqlite3_prepare_v2(connection, sql, -1, &stmt, nullptr), SQLITE_OK) << sql;
+        long long value = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        return value;
+    };
+    const char* triggerExists =
+        "SELECT COUNT(*) FROM sqlite_master WHERE type = 'trigger' AND name = 'musical_works_fts_insert';";
+    
+    std::string works = "disc_key,title,author,performer\n";
+    for (int i = 1; i <= 20; i++) {
+        works += "D1,Сюита " + std::to_string(i) + ",Бах,Гульд\n";
+    }
+    std::string worksPath = "test_import_fts_works.csv";
+    {
+        std::ofstream out(worksPath, std::ios::binary);
+        out << works;
+    }
+    
+    // Five transactions of four rows: the trigger is dropped and recreated once
+    long long schemaVersion = scalar("PRAGMA schema_version;");
+    ImportResult result;
+    captureOutput([&]() { result = db->importCsv(ImportKind::Works, worksPath, 2, 4); });
+    EXPECT_TRUE(result.completed);
+    EXPECT_EQ(result.imported, 20);
+    EXPECT_EQ(scalar("PRAGMA schema_version;"), schemaVersion + 2);
+    EXPECT_EQ(scalar(triggerExists), 1);
+    EXPECT_EQ(db->searchCatalog("сюита", 50).size(), 20u);
+    
+    // Another connection holds the write lock: nothing is imported in autocommit
+    BusyPolicy impatient;
+    impatient.timeout = std::chrono::milliseconds(20);
+    impatient.writeRetries = 0;
+    db->setBusyPolicy(impatient);
+    ASSERT_EQ(sqlite3_exec(connection, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr), SQLITE_OK);
+    std::string errors = captureError([&]() {
+        captureOutput([&]() { result = db->importCsv(ImportKind::Works, worksPath, 2, 4); });
+    });
+    ASSERT_EQ(sqlite3_exec(connection, "COMMIT;", nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_FALSE(result.completed);
+    EXPECT_EQ(result.imported, 0);
+    EXPECT_TRUE(errors.find("импорт остановлен") != std::string::npos);
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM musical_works;"), 20);
+    EXPECT_EQ(scalar(triggerExists), 1);
+    
+    sqlite3_close(connection);
+    std::filesystem::remove(worksPath);
+}
+
+// Test progress reporting, cancellation and per-query timeout
+TEST_F(MusicStoreDBTest, QueryInterruptTest) {
+    setupTestData();
+    
+    // Enough works to make the author report run for many VM steps
+    std::string works = "disc_key,title,author,performer\n";
+    for (int i = 0; i < 3000; i++) {
+        works += "K1,Song " + std::to_string(i) + ",Author " + std::to_string(i % 50) + ",Performer\n";
+    }
+    std::ofstream("test_interrupt_works.csv") << works;
+    std::ofstream("test_interrupt_discs.csv") << "disc_key,production_date,company,price\nK1,2024-01-01,Label,10\n";
+    db->importCsv(ImportKind::Discs, "test_interrupt_discs.csv");
+    db->importCsv(ImportKind::Works, "test_interrupt_works.csv");
+    std::ofstream("test_interrupt_ops.csv") << "disc_key,operation_date,operation_type,quantity\n"
+                                               "K1,2024-01-02,receipt,100\nK1,2024-01-03,sale,5\n";
+    db->importCsv(ImportKind::Operations, "test_interrupt_ops.csv");
+    std::filesystem::remove("test_interrupt_works.csv");
+    std::filesystem::remove("test_interrupt_discs.csv");
+    std::filesystem::remove("test_interrupt_ops.csv");
+    
+    // Without interruption the report completes and progress is reported
+    long long lastSteps = 0;
+    db->setProgressCallback([&](long long steps) { lastSteps = steps; });
+    EXPECT_EQ(db->getAuthorSales().size(), 50u);
+    EXPECT_GT(lastSteps, 0);
+    EXPECT_EQ(db->lastInterrupt(), QueryInterrupt::None);
+    
+    // Cancelling from the progress callback stops the query
+    db->setProgressCallback([&](long long) { db->cancelQuery(); });
+    testing::internal::CaptureStderr();
+    EXPECT_TRUE(db->getAuthorSales().empty());
+    testing::internal::GetCapturedStderr();
+    EXPECT_EQ(db->lastInterrupt(), QueryInterrupt::Cancelled);
+    db->resetInterrupt();
+    
+    // A slow query is stopped once it exceeds the timeout
+    db->setQueryTimeout(std::chrono::milliseconds(1));
+    db->setProgressCallback([](long long) { std::this_thread::sleep_for(std::chrono::milliseconds(5)); });
+    testing::internal::CaptureStderr();
+    EXPECT_TRUE(db->getAuthorSales().empty());
+    testing::internal::GetCapturedStderr();
+    EXPECT_EQ(db->lastInterrupt(), QueryInterrupt::Timeout);
+    
+    db->resetInterrupt();
+    db->setQueryTimeout(std::chrono::milliseconds(0));
+    db->setProgressCallback(nullptr);
+    EXPECT_EQ(db->getAuthorSales().size(), 50u);
+}
+
+// Test online backup with progress and integrity check
+TEST_F(MusicStoreDBTest, BackupTest) {
+    setupTestData();
+    
+    std::string backupPath = "test_backup.db";
+    int progressCalls = 0;
+    int lastRemaining = -1;
+    bool ok = db->backupTo(backupPath, false, 2, std::chrono::milliseconds(0),
+                           [&](int remaining, int total) {
+                               EXPECT_GT(total, 0);
+                               lastRemaining = remaining;
+                               progressCalls++;
+                           });
+    ASSERT_TRUE(ok);
+    EXPECT_GT(progressCalls, 1);
+    EXPECT_EQ(lastRemaining, 0);
+    EXPECT_FALSE(std::filesystem::exists(backupPath + ".part"));
+    EXPECT_FALSE(std::filesystem::exists(backupPath + ".part-wal"));
+    
+    // The copy uses a rollback journal (header bytes 18-19 are 1, not WAL's 2),
+    // so a read-only replica needs no -wal or -shm files
+    {
+        std::ifstream in(backupPath, std::ios::binary);
+        char header[20];
+        ASSERT_TRUE(in.read(header, sizeof(header)));
+        EXPECT_EQ(header[18], 1);
+        EXPECT_EQ(header[19], 1);
+    }
+    {
+        MusicStoreDB replica(backupPath, OpenMode::ReadOnly);
+        EXPECT_EQ(replica.getInventoryValue().discCount, db->getInventoryValue().discCount);
+    }
+    EXPECT_FALSE(std::filesystem::exists(backupPath + "-wal"));
+    
+    // The copy is a complete database with the same data
+    {
+        MusicStoreDB copy(backupPath);
+        copy.login("admin", "admin");
+        InventoryValue original = db->getInventoryValue();
+        InventoryValue restored = copy.getInventoryValue();
+        EXPECT_EQ(restored.discCount, original.discCount);
+        EXPECT_EQ(restored.remaining, original.remaining);
+    }
+    std::filesystem::remove(backupPath);
+    
+    if (ExportWriter::compressionAvailable()) {
+        std::string gzPath = "test_backup.db.gz";
+        ASSERT_TRUE(db->backupTo(gzPath, true));
+        std::ifstream in(gzPath, std::ios::binary);
+        EXPECT_EQ(in.get(), 0x1f);
+        EXPECT_EQ(in.get(), 0x8b);
+        std::filesystem::remove(gzPath);
+    }
+}
+
+// Test that backup inside an open transaction fails instead of waiting forever
+TEST_F(MusicStoreDBTest, BackupInsideTransactionTest) {
+    setupTestData();
+    std::string backupPath = "test_backup_tx.db";
+    
+    ASSERT_TRUE(db->beginTransaction());
+    auto started = std::chrono::steady_clock::now();
+    std::string errors = captureError([&]() { EXPECT_FALSE(db->backupTo(backupPath)); });
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(1));
+    EXPECT_TRUE(errors.find("транзакции") != std::string::npos);
+    EXPECT_FALSE(std::filesystem::exists(backupPath));
+    EXPECT_FALSE(std::filesystem::exists(backupPath + ".part"));
+    ASSERT_TRUE(db->commitTransaction());
+    
+    EXPECT_TRUE(db->backupTo(backupPath));
+    std::filesystem::remove(backupPath);
+}
+
+// Test read-only and immutable open modes
+TEST_F(MusicStoreDBTest, ReadOnlyModeTest) {
+    setupTestData();
+    InventoryValue expected = db->getInventoryValue();
+    db.reset();
+    
+    std::ifstream schemaBefore(testDbPath, std::ios::binary | std::ios::ate);
+    auto sizeBefore = schemaBefore.tellg();
+    
+    for (OpenMode mode : {OpenMode::ReadOnly, OpenMode::Immutable}) {
+        MusicStoreDB replica(testDbPath, mode);
+        EXPECT_TRUE(replica.isReadOnly());
+        EXPECT_TRUE(replica.login("admin", "admin"));
+        
+        // Reports work
+        InventoryValue value = replica.getInventoryValue();
+        EXPECT_EQ(value.discCount, expected.discCount);
+        EXPECT_EQ(value.remaining, expected.remaining);
+        EXPECT_EQ(replica.getCompactInventoryPage(10).rows.size(), 3u);
+        
+        std::stringstream buffer;
+        std::streambuf* oldCout = std::cout.rdbuf(buffer.rdbuf());
+        replica.calculatePeriodStatistics("2000-01-01", "2100-12-31");
+        std::cout.rdbuf(oldCout);
+        EXPECT_NE(buffer.str().find("Sony Music"), std::string::npos);
+        
+        // Writes are refused
+        testing::internal::CaptureStderr();
+        EXPECT_EQ(replica.addCompactDisc("2024-01-01", "Label", 10.0f), -1);
+        EXPECT_EQ(replica.registerOperation("продажа", 1, 1), -1);
+        EXPECT_FALSE(replica.deleteCompactDisc(1));
+        std::string errors = testing::internal::GetCapturedStderr();
+        EXPECT_NE(errors.find("только для чтения"), std::string::npos);
+    }
+    
+    // Nothing was written to the file
+    std::ifstream schemaAfter(testDbPath, std::ios::binary | std::ios::ate);
+    EXPECT_EQ(schemaAfter.tellg(), sizeBefore);
+}
+
+// Test that the in-memory engine matches SQLite and survives a restart
+TEST_F(MusicStoreDBTest, StorageBackendTest) {
+    std::string journalPath = "test_storage_journal.log";
+    std::filesystem::remove(journalPath);
+    
+    auto memory = std::make_unique<MemoryStorage>(journalPath);
+    SqliteStorage sqlite(db);
+    
+    testing::internal::CaptureStdout();
+    testing::internal::CaptureStderr();
+    for (StorageBackend* backend : std::vector<StorageBackend*>{&sqlite, memory.get()}) {
+        EXPECT_EQ(backend->addCompactDisc("2023-01-01", "Sony Music", 19.99f), 1);
+        EXPECT_EQ(backend->addCompactDisc("2023-02-15", "Universal", 24.99f), 2);
+        EXPECT_EQ(backend->addCompactDisc("2023-03-10", "Warner", 14.99f), 3);
+        backend->addMusicalWork("Song 1", "Author 1", "Performer 1", 1);
+        backend->addMusicalWork("Song 2", "Author 2", "Performer 2", 1);
+        backend->addMusicalWork("Song 3", "Author 1", "Performer 3", 2);
+        backend->addMusicalWork("Song 4", "Author 3", "Performer 1", 3);
+        
+        backend->registerOperation("поступление", 1, 20, "2024-01-10");
+        backend->registerOperation("поступление", 2, 15, "2024-01-12");
+        backend->registerOperation("продажа", 1, 10, "2024-02-01");
+        backend->registerOperation("продажа", 2, 5, "2024-03-01");
+        // Out-of-order date
+        backend->registerOperation("поступление", 1, 5, "2024-01-20");
+        EXPECT_EQ(backend->registerOperation("продажа", 1, 100, "2024-03-05"), -1);
+        
+        EXPECT_TRUE(backend->updateCompactDisc(3, "Warner Music", 12.5f));
+        EXPECT_TRUE(backend->deleteCompactDisc(3));
+    }
+    testing::internal::GetCapturedStdout();
+    testing::internal::GetCapturedStderr();
+    
+    auto compare = [&](StorageBackend& actual) {
+        for (int compactId : {1, 2}) {
+            EXPECT_EQ(actual.getStockLevel(compactId), sqlite.getStockLevel(compactId));
+            PeriodTotals expected = sqlite.getPeriodTotals(compactId, "2024-01-15", "2024-02-01");
+            PeriodTotals totals = actual.getPeriodTotals(compactId, "2024-01-15", "2024-02-01");
+            EXPECT_EQ(totals.received, expected.received);
+            EXPECT_EQ(totals.sold, expected.sold);
+        }
+        EXPECT_EQ(actual.getStockLevel(3), -1);
+        
+        auto performers = actual.getPerformerSales();
+        auto expectedPerformers = sqlite.getPerformerSales();
+        ASSERT_EQ(performers.size(), expectedPerformers.size());
+        for (size_t i = 0; i < performers.size(); i++) {
+            EXPECT_EQ(performers[i].performer, expectedPerformers[i].performer);
+            EXPECT_EQ(performers[i].totalSold, expectedPerformers[i].totalSold);
+        }
+        
+        auto authors = actual.getAuthorSales();
+        auto expectedAuthors = sqlite.getAuthorSales();
+        ASSERT_EQ(authors.size(), expectedAuthors.size());
+        for (size_t i = 0; i < authors.size(); i++) {
+            EXPECT_EQ(authors[i].author, expectedAuthors[i].author);
+            EXPECT_EQ(authors[i].worksCount, expectedAuthors[i].worksCount);
+            EXPECT_NEAR(authors[i].totalRevenue, expectedAuthors[i].totalRevenue, 0.01);
+        }
+        
+        InventoryValue value = actual.getInventoryValue();
+        InventoryValue expectedValue = sqlite.getInventoryValue();
+        EXPECT_EQ(value.discCount, expectedValue.discCount);
+        EXPECT_EQ(value.remaining, expectedValue.remaining);
+        EXPECT_NEAR(value.stockValue, expectedValue.stockValue, 0.01);
+    };
+    
+    compare(*memory);
+    EXPECT_EQ(memory->getStockLevel(1), 15);
+    EXPECT_FALSE(memory->deleteCompactDisc(1)); // Disc with operations
+    EXPECT_EQ(memory->getPeriodTotals(1, "2024-01-15", "2024-02-01").received, 5);
+    
+    // Replay the journal, including a torn trailing record
+    memory.reset();
+    {
+        std::ofstream journal(journalPath, std::ios::app | std::ios::binary);
+        journal << "op\t99\t20240401\tr\t2";
+    }
+    memory = std::make_unique<MemoryStorage>(journalPath);
+    compare(*memory);
+    EXPECT_EQ(memory->addCompactDisc("2024-05-01", "EMI", 9.99f), 4);
+    
+    memory.reset();
+    std::filesystem::remove(journalPath);
+}
+
+// Test that the columnar snapshot matches the SQL reports with every kernel
+TEST_F(MusicStoreDBTest, AnalyticsSnapshotTest) {
+    setupTestData();
+    testing::internal::CaptureStdout();
+    // More rows than one vector step, spread over several dates
+    for (int i = 0; i < 37; i++) {
+        std::string date = "2024-0" + std::to_string(1 + i % 9) + "-15";
+        db->registerOperation("поступление", 1 + i % 3, 3, date);
+        db->registerOperation("продажа", 1 + i % 3, 1 + i % 2, date);
+    }
+    testing::internal::GetCapturedStdout();
+    
+    AnalyticsSnapshot snapshot;
+    ASSERT_TRUE(db->loadAnalyticsSnapshot(snapshot));
+    EXPECT_EQ(snapshot.operationCount(), 80u);
+    
+    auto expectedAuthors = db->getAuthorSales();
+    auto expectedPerformers = db->getPerformerSales();
+    
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2}) {
+        snapshot.setSimdLevel(level);
+        SCOPED_TRACE(AnalyticsSnapshot::simdLevelName(snapshot.getSimdLevel()));
+        
+        auto authors = snapshot.authorSales();
+        ASSERT_EQ(authors.size(), expectedAuthors.size());
+        for (size_t i = 0; i < authors.size(); i++) {
+            EXPECT_EQ(authors[i].author, expectedAuthors[i].author);
+            EXPECT_EQ(authors[i].totalSold, expectedAuthors[i].totalSold);
+            EXPECT_EQ(authors[i].worksCount, expectedAuthors[i].worksCount);
+            EXPECT_NEAR(authors[i].totalRevenue, expectedAuthors[i].totalRevenue, 0.001);
+        }
+        
+        auto performers = snapshot.performerSales();
+        ASSERT_EQ(performers.size(), expectedPerformers.size());
+        for (size_t i = 0; i < performers.size(); i++) {
+            EXPECT_EQ(performers[i].performer, expectedPerformers[i].performer);
+            EXPECT_EQ(performers[i].totalSold, expectedPerformers[i].totalSold);
+        }
+        
+        auto discs = snapshot.periodStatistics("2024-02-01", "2024-06-30");
+        ASSERT_EQ(discs.size(), 3u);
+        for (const DiscPeriodTotals& disc : discs) {
+            PeriodTotals expected = db->getPeriodTotals(disc.compactId, "2024-02-01", "2024-06-30");
+            EXPECT_EQ(disc.received, expected.received);
+            EXPECT_EQ(disc.sold, expected.sold);
+        }
+    }
+    
+    EXPECT_TRUE(snapshot.authorSales("bad-date", "").empty());
+}
+
+// Compile-time parameter counting
+static_assert(sqlParameterCount("SELECT 1;") == 0, "no parameters");
+static_assert(sqlParameterCount("SELECT ?, ?;") == 2, "positional parameters");
+static_assert(sqlParameterCount("SELECT ?1, ?2 WHERE a BETWEEN ?1 AND ?2;") == 2, "numbered parameters are reused");
+static_assert(sqlParameterCount("SELECT ?3, ?;") == 4, "? continues after the largest number");
+static_assert(sqlParameterCount("SELECT '?', \"a?\" -- ?\n /* ? */ FROM t WHERE x = ?;") == 1, "literals and comments");
+static_assert(sqlParameterCount("SELECT :name;") == -1, "named parameters are rejected");
+
+namespace {
+constexpr char QUERY_TEST_INSERT_SQL[] = "INSERT INTO t (id, name, price) VALUES (?, ?, ?);";
+constexpr char QUERY_TEST_SELECT_SQL[] = "SELECT id, name, price FROM t WHERE id >= ?1 ORDER BY id;";
+}
+
+// Test typed query binding, decoding and statement caching
+TEST(QueryTest, BindDecodeAndCache) {
+    sqlite3* connection;
+    ASSERT_EQ(sqlite3_open(":memory:", &connection), SQLITE_OK);
+    sqlite3_exec(connection, "CREATE TABLE t (id INTEGER PRIMARY KEY, name TEXT, price REAL);", nullptr, nullptr, nullptr);
+    
+    {
+        StatementCache cache(connection);
+        using Insert = Command<QUERY_TEST_INSERT_SQL, int, std::string_view, std::optional<double>>;
+        
+        sqlite3_stmt* first = nullptr;
+        for (int id = 1; id <= 3; id++) {
+            Insert insert(cache);
+            ASSERT_TRUE(insert.ok());
+            std::string name = "Name '" + std::to_string(id) + "'";
+            EXPECT_TRUE(insert.bind(id, name, id == 2 ? std::nullopt : std::optional<double>(id * 1.5)).execute());
+            
+            // The prepared statement is reused from the cache
+            sqlite3_stmt* current = sqlite3_next_stmt(connection, nullptr);
+            if (!first) {
+                first = current;
+            }
+            EXPECT_EQ(current, first);
+        }
+        
+        using Select = Query<QUERY_TEST_SELECT_SQL, std::tuple<int, std::string, std::optional<double>>, int>;
+        auto rows = Select(cache).bind(2).fetchAll();
+        ASSERT_EQ(rows.size(), 2u);
+        EXPECT_EQ(std::get<0>(rows[0]), 2);
+        EXPECT_EQ(std::get<1>(rows[0]), "Name '2'");
+        EXPECT_FALSE(std::get<2>(rows[0]).has_value());
+        EXPECT_DOUBLE_EQ(*std::get<2>(rows[1]), 4.5);
+        
+        // Column count must match the row type
+        testing::internal::CaptureStderr();
+        Query<QUERY_TEST_SELECT_SQL, std::tuple<int>, int> mismatch(connection);
+        EXPECT_FALSE(mismatch.ok());
+        EXPECT_FALSE(mismatch.bind(1).execute());
+        testing::internal::GetCapturedStderr();
+    }
+    
+    // The cache finalized its statements, so the connection closes cleanly
+    EXPECT_EQ(sqlite3_close(connection), SQLITE_OK);
+}
+
+// Test per-report arena: small reports are served from the inline buffer
+TEST_F(MusicStoreDBTest, ReportArenaTest) {
+    {
+        ReportArena arena;
+        std::pmr::vector<std::pmr::string> cells(arena.resource());
+        for (int i = 0; i < 20; i++) {
+            cells.emplace_back("cell value that does not fit into the small string buffer");
+        }
+        ReportArenaStats stats = arena.stats();
+        EXPECT_GT(stats.allocations, 0u);
+        EXPECT_GT(stats.bytes, 0u);
+        EXPECT_EQ(stats.heapAllocations, 0u);
+    }
+    
+    // Growing past the inline buffer takes blocks from upstream
+    {
+        ReportArena arena;
+        std::pmr::string big(ReportArena::INITIAL_BUFFER_SIZE * 2, 'x', arena.resource());
+        EXPECT_GT(arena.stats().heapAllocations, 0u);
+    }
+    
+    setupTestData();
+    ReportArenaStats before = ReportArena::totals();
+    std::string output = captureOutput([this]() { db->showAuthorSales(); });
+    ReportArenaStats after = ReportArena::totals();
+    
+    EXPECT_TRUE(output.find("Author 1") != std::string::npos);
+    EXPECT_EQ(after.reports, before.reports + 1);
+    EXPECT_GT(after.allocations, before.allocations);
+    EXPECT_EQ(after.heapAllocations, before.heapAllocations);
+}
+
+// Test SHA-256 and PBKDF2 against published vectors, and the stored hash format
+TEST(PasswordHashTest, KnownVectorsAndVerify) {
+    EXPECT_EQ(PasswordHash::toHex(std::string_view(reinterpret_cast<const char*>(PasswordHash::sha256("abc").data()), 32)),
+              "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(PasswordHash::toHex(PasswordHash::pbkdf2("password", "salt", 1, 32)),
+              "120fb6cffcf8b32c43e7225256c4f837a86548c92ccc35480805987cb70be17b");
+    EXPECT_EQ(PasswordHash::toHex(PasswordHash::pbkdf2("password", "salt", 2, 32)),
+              "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43");
+    
+    std::string stored = PasswordHash::hash("secret", 10);
+    EXPECT_TRUE(PasswordHash::isHashed(stored));
+    EXPECT_TRUE(PasswordHash::verify("secret", stored));
+    EXPECT_FALSE(PasswordHash::verify("Secret", stored));
+    EXPECT_FALSE(PasswordHash::verify("secret", "secret"));
+    
+    // Every hash gets its own salt
+    EXPECT_NE(PasswordHash::hash("secret", 10), stored);
+}
+
+// Test that a plaintext password is replaced by a hash on first login
+TEST_F(MusicStoreDBTest, PasswordUpgradeTest) {
+    db.reset();
+    
+    sqlite3* connection = nullptr;
+    ASSERT_EQ(sqlite3_open(testDbPath.c_str(), &connection), SQLITE_OK);
+    auto storedHash = [connection]() {
+        sqlite3_stmt* stmt = nullptr;
+        sqlite3_prepare_v2(connection, "SELECT password_hash FROM users WHERE username = 'user';", -1, &stmt, nullptr);
+        std::string value;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
+        return value;
+    };
+    EXPECT_EQ(storedHash(), "user");
+    
+    db = std::make_shared<MusicStoreDB>(testDbPath);
+    EXPECT_TRUE(db->login("user", "user"));
+    EXPECT_TRUE(PasswordHash::isHashed(storedHash()));
+    
+    // The hash is verified on later logins
+    EXPECT_TRUE(db->login("user", "user"));
+    EXPECT_FALSE(db->isUserAdmin());
+    EXPECT_FALSE(db->login("user", "wrong"));
+    EXPECT_FALSE(db->authenticate("user", "wrong").has_value());
+    
+    sqlite3_close(connection);
+}
+
+// Test session tokens: validation, expiry and revocation
+TEST(SessionManagerTest, CreateValidateRevoke) {
+    SessionManager sessions;
+    std::string token = sessions.create(1, "admin", true);
+    EXPECT_EQ(token.size(), SessionManager::TOKEN_BYTES * 2);
+    
+    auto session = sessions.validate(token);
+    ASSERT_TRUE(session.has_value());
+    EXPECT_EQ(session->userId, 1);
+    EXPECT_TRUE(session->admin);
+    EXPECT_FALSE(sessions.validate("unknown").has_value());
+    
+    sessions.create(1, "admin", true);
+    sessions.create(2, "user", false);
+    EXPECT_EQ(sessions.size(), 3u);
+    EXPECT_TRUE(sessions.revoke(token));
+    EXPECT_FALSE(sessions.validate(token).has_value());
+    EXPECT_EQ(sessions.revokeUser(1), 1u);
+    EXPECT_EQ(sessions.size(), 1u);
+    
+    // Zero lifetime: sessions expire immediately
+    SessionManager expiring(std::chrono::seconds(0));
+    std::string shortLived = expiring.create(2, "user", false);
+    EXPECT_FALSE(expiring.validate(shortLived).has_value());
+    expiring.create(2, "user", false);
+    EXPECT_EQ(expiring.purgeExpired(), 1u);
+    EXPECT_EQ(expiring.size(), 0u);
+}
+
+// Test that a second connection waits for the write lock instead of failing
+TEST_F(MusicStoreDBTest, BusyHandlingTest) {
+    std::streambuf* oldCout = std::cout.rdbuf();
+    std::ostringstream discarded;
+    std::cout.rdbuf(discarded.rdbuf());
+    
+    MusicStoreDB other(testDbPath);
+    ASSERT_TRUE(db->beginTransaction());
+    int compactId = db->addCompactDisc("2023-01-01", "Sony Music", 10.0f);
+    
+    // The writer holds the lock longer than the short policy allows
+    BusyPolicy impatient;
+    impatient.timeout = std::chrono::milliseconds(20);
+    impatient.writeRetries = 1;
+    other.setBusyPolicy(impatient);
+    testing::internal::CaptureStderr();
+    EXPECT_EQ(other.addCompactDisc("2023-01-02", "EMI", 12.0f), -1);
+    testing::internal::GetCapturedStderr();
+    LockStats stats = other.getLockStats();
+    EXPECT_EQ(stats.timeouts, 2);
+    EXPECT_EQ(stats.writeRetries, 1);
+    EXPECT_GT(stats.waitedMicros, 0);
+    
+    // With the default policy the write goes through once the lock is released
+    other.setBusyPolicy(BusyPolicy{});
+    other.resetLockStats();
+    std::thread writer([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        db->commitTransaction();
+    });
+    int otherId = other.addCompactDisc("2023-01-02", "EMI", 12.0f);
+    writer.join();
+    std::cout.rdbuf(oldCout);
+    
+    EXPECT_GT(otherId, compactId);
+    stats = other.getLockStats();
+    EXPECT_EQ(stats.waits, 1);
+    EXPECT_GT(stats.busyCalls, 0);
+    EXPECT_EQ(stats.timeouts, 0);
+    
+    // Readers on another connection do not block the writer in WAL mode
+    sqlite3* reader = nullptr;
+    ASSERT_EQ(sqlite3_open(testDbPath.c_str(), &reader), SQLITE_OK);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(reader, "PRAGMA journal_mode;", -1, &stmt, nullptr);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_STREQ(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), "wal");
+    sqlite3_finalize(stmt);
+    ASSERT_EQ(sqlite3_exec(reader, "BEGIN; SELECT COUNT(*) FROM compact_discs;", nullptr, nullptr, nullptr), SQLITE_OK);
+    std::cout.rdbuf(discarded.rdbuf());
+    EXPECT_GT(db->addCompactDisc("2023-01-03", "Decca", 15.0f), 0);
+    std::cout.rdbuf(oldCout);
+    sqlite3_exec(reader, "COMMIT;", nullptr, nullptr, nullptr);
+    sqlite3_close(reader);
+}
+
+// Test catalog cache: lazy load, copy-on-write updates and stable reader snapshots
+TEST_F(MusicStoreDBTest, CatalogCacheTest) {
+    setupTestData();
+    std::shared_ptr<CatalogCache> cache = db->getCatalogCache();
+    EXPECT_EQ(cache->snapshot(), nullptr);
+    
+    std::string output = captureOutput([this]() { db->showMostPopularCompact(); });
+    EXPECT_TRUE(output.find("Sony Music") != std::string::npos);
+    EXPECT_TRUE(output.find("Song 2") != std::string::npos);
+    
+    std::shared_ptr<const CatalogSnapshot> before = cache->snapshot();
+    ASSERT_NE(before, nullptr);
+    EXPECT_EQ(before->size(), 3u);
+    long long swaps = cache->swapCount();
+    
+    captureOutput([this]() {
+        db->updateCompactDisc(1, "Melodiya", 21.5f);
+        db->addMusicalWork("Song 5", "Author 4", "Performer 4", 1);
+        db->deleteCompactDisc(3);
+    });
+    EXPECT_EQ(cache->swapCount(), swaps + 3);
+    
+    // The old snapshot is unchanged; the new one has every update
+    EXPECT_EQ(before->find(1)->company, "Sony Music");
+    EXPECT_NE(before->find(3), nullptr);
+    std::shared_ptr<const CatalogSnapshot> after = cache->snapshot();
+    EXPECT_EQ(after->find(1)->company, "Melodiya");
+    EXPECT_DOUBLE_EQ(after->find(1)->price, 21.5);
+    ASSERT_EQ(after->find(1)->works.size(), 3u);
+    EXPECT_EQ(after->find(1)->works.back().title, "Song 5");
+    EXPECT_EQ(after->find(3), nullptr);
+    
+    output = captureOutput([this]() { db->showCompactSales(1, "2023-01-01", "2026-12-31"); });
+    EXPECT_TRUE(output.find("Melodiya") != std::string::npos);
+    
+    // A rolled back change drops the cache, the next report reloads it
+    db->beginTransaction();
+    captureOutput([this]() { db->updateCompactDisc(1, "Rolled Back", 30.0f); });
+    db->rollbackTransaction();
+    EXPECT_EQ(cache->snapshot(), nullptr);
+    output = captureOutput([this]() { db->getCompactSalesInfo(1, "2023-01-01", "2026-12-31"); });
+    EXPECT_TRUE(output.find("Melodiya") != std::string::npos);
+    EXPECT_NE(cache->snapshot(), nullptr);
+}
+
+// Test that the catalog cache notices changes from other connections and hides uncommitted ones
+TEST_F(MusicStoreDBTest, CatalogCacheExternalChangesTest) {
+    setupTestData();
+    std::string output = captureOutput([this]() { db->showMostPopularCompact(); });
+    ASSERT_NE(db->getCatalogCache()->snapshot(), nullptr);
+    
+    // Another process adds a disc with sales and renames a company
+    {
+        MusicStoreDB other(testDbPath);
+        captureOutput([&]() {
+            other.addCompactDisc("2024-01-01", "Decca", 12.0f);
+            other.registerOperation("поступление", 4, 10);
+            other.registerOperation("продажа", 4, 4, "2024-02-01");
+            other.updateCompactDisc(1, "Sony BMG", 19.99f);
+        });
+    }
+    
+    output = captureOutput([this]() { db->getCompactSalesInfo(4, "2024-01-01", "2024-12-31"); });
+    EXPECT_TRUE(output.find("Decca") != std::string::npos);
+    EXPECT_EQ(db->getCompanySales("Sony BMG", "2000-01-01", "2100-12-31").discs.size(), 1u);
+    EXPECT_TRUE(db->getCompanySales("Sony Music", "2000-01-01", "2100-12-31").discs.empty());
+    
+    // A pooled connection sharing the cache does not see this connection's uncommitted change
+    MusicStoreDB pooled(testDbPath);
+    pooled.setCatalogCache(db->getCatalogCache());
+    ASSERT_TRUE(db->beginTransaction());
+    captureOutput([this]() { db->updateCompactDisc(2, "Uncommitted", 24.99f); });
+    EXPECT_EQ(db->getDiscSales({2}, "2000-01-01", "2100-12-31").discs[0].company, "Uncommitted");
+    EXPECT_EQ(pooled.getDiscSales({2}, "2000-01-01", "2100-12-31").discs[0].company, "Universal");
+    ASSERT_TRUE(db->commitTransaction());
+    EXPECT_EQ(pooled.getDiscSales({2}, "2000-01-01", "2100-12-31").discs[0].company, "Uncommitted");
+    
+    // The catalog version is checked once per read transaction and again in the next one
+    MusicStoreDB reader(testDbPath, OpenMode::ReadOnly);
+    ASSERT_TRUE(reader.beginTransaction());
+    EXPECT_EQ(reader.getDiscSales({2}, "2000-01-01", "2100-12-31").discs[0].company, "Uncommitted");
+    captureOutput([this]() { db->updateCompactDisc(2, "Universal", 24.99f); });
+    EXPECT_EQ(reader.getDiscSales({2}, "2000-01-01", "2100-12-31").discs[0].company, "Uncommitted");
+    ASSERT_TRUE(reader.commitTransaction());
+    ASSERT_TRUE(reader.beginTransaction());
+    EXPECT_EQ(reader.getDiscSales({2}, "2000-01-01", "2100-12-31").discs[0].company, "Universal");
+    ASSERT_TRUE(reader.commitTransaction());
+}
+
+// Test sales of several discs in one query, by id list and by company
+TEST_F(MusicStoreDBTest, MultiDiscSalesTest) {
+    setupTestData();
+    captureOutput([this]() {
+        db->addCompactDisc("2023-04-01", "Sony Music", 5.0f);
+        db->registerOperation("продажа", 1, 3, "2020-06-01");
+    });
+    
+    // Unknown ids are skipped, discs without sales are reported with zeros
+    DiscSalesReport report = db->getDiscSales({3, 1, 99, 4, 1}, "2023-01-01", "2026-12-31");
+    ASSERT_EQ(report.discs.size(), 3u);
+    EXPECT_EQ(report.discs[0].compactId, 1);
+    EXPECT_EQ(report.discs[0].sold, 10);
+    EXPECT_EQ(report.discs[0].company, "Sony Music");
+    EXPECT_EQ(report.discs[1].compactId, 3);
+    EXPECT_EQ(report.discs[1].sold, 2);
+    EXPECT_EQ(report.discs[2].compactId, 4);
+    EXPECT_EQ(report.discs[2].sold, 0);
+    EXPECT_EQ(report.totalSold, 12);
+    EXPECT_NEAR(report.totalRevenue, 10 * 19.99 + 2 * 14.99, 1e-3);
+    
+    report = db->getCompanySales("Sony Music", "2020-01-01", "2026-12-31");
+    ASSERT_EQ(report.discs.size(), 2u);
+    EXPECT_EQ(report.totalSold, 13);
+    EXPECT_TRUE(db->getCompanySales("Nobody", "2020-01-01", "2026-12-31").discs.empty());
+    
+    std::string output = captureOutput([this]() { db->showCompanySales("Sony Music", "2020-01-01", "2026-12-31"); });
+    EXPECT_TRUE(output.find("Итого") != std::string::npos);
+    EXPECT_TRUE(output.find("13") != std::string::npos);
+    
+    // The temporary table also works on a read-only connection
+    MusicStoreDB reader(testDbPath, OpenMode::ReadOnly);
+    EXPECT_EQ(reader.getDiscSales({1, 2}, "2023-01-01", "2026-12-31").totalSold, 15);
+}
+
+// Test comparing several periods in one report
+TEST_F(MusicStoreDBTest, PeriodComparisonTest) {
+    captureOutput([this]() {
+        db->addCompactDisc("2023-01-01", "Sony Music", 10.0f);
+        db->addCompactDisc("2023-01-01", "Warner", 20.0f);
+        db->addCompactDisc("2023-01-01", "Idle", 5.0f);
+        db->registerOperation("поступление", 1, 50, "2024-01-05");
+        db->registerOperation("продажа", 1, 4, "2024-01-10");
+        db->registerOperation("продажа", 1, 6, "2024-02-10");
+        db->registerOperation("поступление", 2, 5, "2023-12-20");
+        db->registerOperation("продажа", 2, 3, "2024-02-15");
+    });
+    
+    // The third period overlaps the first two
+    PeriodComparison comparison = db->comparePeriods({{"2024-01-01", "2024-01-31"},
+                                                      {"2024-02-01", "2024-02-29"},
+                                                      {"2024-01-01", "2024-12-31"}});
+    ASSERT_EQ(comparison.rows.size(), 3u);
+    const PeriodComparisonRow& first = comparison.rows[0];
+    ASSERT_EQ(first.periods.size(), 3u);
+    EXPECT_EQ(first.periods[0].received, 50);
+    EXPECT_EQ(first.periods[0].sold, 4);
+    EXPECT_EQ(first.periods[1].sold, 6);
+    EXPECT_EQ(first.periods[2].sold, 10);
+    EXPECT_NEAR(first.periods[2].revenue, 100.0, 1e-6);
+    ASSERT_EQ(first.changes.size(), 2u);
+    EXPECT_EQ(first.changes[0].soldDelta, 2);
+    ASSERT_TRUE(first.changes[0].soldGrowth.has_value());
+    EXPECT_NEAR(*first.changes[0].soldGrowth, 0.5, 1e-9);
+    
+    // No sales in the previous period means no growth rate
+    EXPECT_EQ(comparison.rows[1].periods[0].sold, 0);
+    EXPECT_FALSE(comparison.rows[1].changes[0].soldGrowth.has_value());
+    EXPECT_EQ(comparison.rows[2].company, "Idle");
+    EXPECT_EQ(comparison.rows[2].periods[2].sold, 0);
+    
+    EXPECT_EQ(comparison.totals[1].sold, 9);
+    EXPECT_NEAR(comparison.totals[1].revenue, 120.0, 1e-6);
+    EXPECT_NEAR(*comparison.totalChanges[0].revenueGrowth, 2.0, 1e-9);
+    EXPECT_TRUE(db->comparePeriods({}).rows.empty());
+    
+    std::string output = captureOutput([this]() {
+        db->showPeriodComparison({{"2024-01-01", "2024-01-31"}, {"2024-02-01", "2024-02-29"}});
+    });
+    EXPECT_TRUE(output.find("Рост, % 2") != std::string::npos);
+    EXPECT_TRUE(output.find("Итого") != std::string::npos);
+}
+
+// Test time-bucketed sales series with moving averages and running totals
+TEST_F(MusicStoreDBTest, SalesSeriesTest) {
+    captureOutput([this]() {
+        db->addCompactDisc("2023-01-01", "Sony Music", 10.0f);
+        db->addCompactDisc("2023-01-01", "Warner", 20.0f);
+        db->addMusicalWork("Song 1", "Author 1", "Performer 1", 1);
+        db->addMusicalWork("Song 2", "Author 2", "Performer 1", 1);
+        db->addMusicalWork("Song 3", "Author 1", "Performer 2", 2);
+        db->registerOperation("поступление", 1, 100, "2024-01-01");
+        db->registerOperation("поступление", 2, 100, "2024-01-01");
+        db->registerOperation("продажа", 1, 2, "2024-01-01");
+        db->registerOperation("продажа", 1, 4, "2024-01-01");
+        db->registerOperation("продажа", 1, 6, "2024-01-03");
+        db->registerOperation("продажа", 2, 1, "2024-01-02");
+        db->registerOperation("продажа", 2, 5, "2024-02-20");
+    });
+    
+    // Day 2 has no sales of disc 1 but counts as zero in the 2-day moving average
+    auto days = db->getSalesSeries(SeriesBucket::Day, SeriesGrouping::Disc, "2024-01-01", "2024-01-31", 2);
+    ASSERT_EQ(days.size(), 3u);
+    EXPECT_EQ(days[0].key, "1");
+    EXPECT_EQ(days[0].bucket, "2024-01-01");
+    EXPECT_EQ(days[0].sold, 6);
+    EXPECT_NEAR(days[0].averageSold, 6.0, 1e-9);
+    EXPECT_EQ(days[1].bucket, "2024-01-03");
+    EXPECT_NEAR(days[1].averageSold, 3.0, 1e-9);
+    EXPECT_EQ(days[1].runningSold, 12);
+    EXPECT_NEAR(days[1].runningRevenue, 120.0, 1e-6);
+    EXPECT_EQ(days[2].key, "2");
+    
+    auto months = db->getSalesSeries(SeriesBucket::Month, SeriesGrouping::Disc, "2024-01-01", "2024-12-31", 3);
+    ASSERT_EQ(months.size(), 3u);
+    EXPECT_EQ(months[2].bucket, "2024-02-01");
+    EXPECT_NEAR(months[2].averageSold, 3.0, 1e-9);
+    EXPECT_EQ(months[2].runningSold, 6);
+    
+    // 2024-01-03 is a Wednesday, so its week starts on 2024-01-01
+    auto weeks = db->getSalesSeries(SeriesBucket::Week, SeriesGrouping::Disc, "2024-01-01", "2024-01-31", 1);
+    ASSERT_FALSE(weeks.empty());
+    EXPECT_EQ(weeks[0].bucket, "2024-01-01");
+    EXPECT_EQ(weeks[0].sold, 12);
+    
+    // A disc sale counts once for each distinct performer or author on it
+    auto performers = db->getSalesSeries(SeriesBucket::Month, SeriesGrouping::Performer, "2024-01-01", "2024-01-31");
+    ASSERT_EQ(performers.size(), 2u);
+    EXPECT_EQ(performers[0].key, "Performer 1");
+    EXPECT_EQ(performers[0].sold, 12);
+    auto authors = db->getSalesSeries(SeriesBucket::Month, SeriesGrouping::Author, "2024-01-01", "2024-01-31");
+    ASSERT_EQ(authors.size(), 2u);
+    EXPECT_EQ(authors[0].key, "Author 1");
+    EXPECT_EQ(authors[0].sold, 13);
+    
+    // A read-only copy without the rollup falls back to a view over operations
+    sqlite3* connection = nullptr;
+    ASSERT_EQ(sqlite3_open(testDbPath.c_str(), &connection), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(connection, "DROP TABLE daily_sales;", nullptr, nullptr, nullptr), SQLITE_OK);
+    sqlite3_close(connection);
+    MusicStoreDB reader(testDbPath, OpenMode::ReadOnly);
+    auto fallback = reader.getSalesSeries(SeriesBucket::Day, SeriesGrouping::Disc, "2024-01-01", "2024-01-31", 2);
+    ASSERT_EQ(fallback.size(), days.size());
+    EXPECT_NEAR(fallback[1].averageSold, days[1].averageSold, 1e-9);
+}
+
+// Test that corrected operations keep the stock and sales rollups in sync
+TEST_F(MusicStoreDBTest, OperationUpdateRollupTest) {
+    captureOutput([this]() {
+        db->addCompactDisc("2023-01-01", "Sony Music", 10.0f);
+        db->addCompactDisc("2023-01-01", "Warner", 20.0f);
+        db->registerOperation("поступление", 1, 100, "2024-01-01");
+        db->registerOperation("поступление", 2, 100, "2024-01-01");
+        db->registerOperation("продажа", 1, 5, "2024-01-02");
+        db->registerOperation("продажа", 1, 3, "2024-01-02");
+    });
+    
+    sqlite3* connection = nullptr;
+    ASSERT_EQ(sqlite3_open(testDbPath.c_str(), &connection), SQLITE_OK);
+    auto exec = [connection](const char* sql) {
+        EXPECT_EQ(sqlite3_exec(connection, sql, nullptr, nullptr, nullptr), SQLITE_OK) << sql;
+    };
+    
+    // Quantity fix
+    exec("UPDATE operations SET quantity = 7 WHERE operation_id = 3;");
+    EXPECT_EQ(db->getStockLevel(1), 90);
+    
+    // Sale booked against the wrong disc and date
+    exec("UPDATE operations SET compact_id = 2, operation_date = '2024-01-05' WHERE operation_id = 4;");
+    EXPECT_EQ(db->getStockLevel(1), 93);
+    EXPECT_EQ(db->getStockLevel(2), 97);
+    
+    // Receipt recorded as a sale
+    exec("UPDATE operations SET operation_type = 'продажа' WHERE operation_id = 2;");
+    EXPECT_EQ(db->getStockLevel(2), -103);
+    exec("UPDATE operations SET operation_type = 'поступление' WHERE operation_id = 2;");
+    EXPECT_EQ(db->getStockLevel(2), 97);
+    
+    // Moving the whole day's sale away removes its rollup row
+    exec("UPDATE operations SET operation_date = '2024-01-03' WHERE operation_id = 3;");
+    
+    // Rollups match a full recount from operations
+    auto mismatches = [connection](const char* sql) {
+        sqlite3_stmt* stmt = nullptr;
+        EXPECT_EQ(sqlite3_prepare_v2(connection, sql, -1, &stmt, nullptr), SQLITE_OK) << sql;
+        int rows = 0;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            rows++;
+        }
+        sqlite3_finalize(stmt);
+        return rows;
+    };
+    EXPECT_EQ(mismatches(
+        "SELECT compact_id, received, sold FROM stock_levels EXCEPT "
+        "SELECT cd.compact_id, "
+        "       COALESCE(SUM(CASE WHEN o.operation_type = 'поступление' THEN o.quantity END), 0), "
+        "       COALESCE(SUM(CASE WHEN o.operation_type = 'продажа' THEN o.quantity END), 0) "
+        "FROM compact_discs cd LEFT JOIN operations o ON o.compact_id = cd.compact_id "
+        "GROUP BY cd.compact_id;"), 0);
+    const char* recount =
+        "SELECT compact_id, operation_date, SUM(quantity) FROM operations "
+        "WHERE operation_type = 'продажа' GROUP BY compact_id, operation_date";
+    EXPECT_EQ(mismatches((std::string("SELECT compact_id, sale_date, sold FROM daily_sales EXCEPT ") + recount + ";").c_str()), 0);
+    EXPECT_EQ(mismatches((std::string(recount) + " EXCEPT SELECT compact_id, sale_date, sold FROM daily_sales;").c_str()), 0);
+    sqlite3_close(connection);
+    
+    auto days = db->getSalesSeries(SeriesBucket::Day, SeriesGrouping::Disc, "2024-01-01", "2024-01-31", 1);
+    ASSERT_EQ(days.size(), 2u);
+    EXPECT_EQ(days[0].key, "1");
+    EXPECT_EQ(days[0].bucket, "2024-01-03");
+    EXPECT_EQ(days[0].sold, 7);
+    EXPECT_EQ(days[1].key, "2");
+    EXPECT_EQ(days[1].bucket, "2024-01-05");
+    EXPECT_EQ(days[1].sold, 3);
+}
+
+// Test set-based bulk catalog maintenance
+TEST_F(MusicStoreDBTest, BulkCatalogMaintenanceTest) {
+    setupTestData();
+    captureOutput([this]() {
+        db->addCompactDisc("2023-04-01", "Sony Music", 10.0f);
+        db->addCompactDisc("2023-05-01", "Indie", 8.0f);
+    });
+    
+    // Disc lookups go through the catalog cache, so they also check its invalidation
+    auto disc = [this](int compactId) {
+        auto discs = db->getDiscSales({compactId}, "2000-01-01", "2100-12-31").discs;
+        return discs.empty() ? std::optional<DiscSales>() : std::optional<DiscSales>(discs[0]);
+    };
+    ASSERT_NEAR(disc(4)->price, 10.0, 1e-6);
+    
+    // A dry run only counts the selected discs
+    DiscSelection sony{{}, "Sony Music"};
+    captureOutput([&]() { EXPECT_EQ(db->repriceDiscs(sony, 10.0, true), 2); });
+    EXPECT_NEAR(disc(4)->price, 10.0, 1e-6);
+    
+    std::string output = captureOutput([&]() { EXPECT_EQ(db->repriceDiscs(sony, 10.0), 2); });
+    EXPECT_TRUE(output.find("Изменена цена компакт-дисков: 2") != std::string::npos);
+    EXPECT_NEAR(disc(1)->price, 21.99, 1e-3);
+    EXPECT_NEAR(disc(4)->price, 11.0, 1e-3);
+    EXPECT_NEAR(disc(2)->price, 24.99, 1e-3);
+    
+    // Id list and company are combined; unknown ids are ignored
+    captureOutput([&]() {
+        EXPECT_EQ(db->reassignCompany(DiscSelection{{2, 3, 4, 99}, "Sony Music"}, "Sony BMG"), 1);
+        EXPECT_EQ(db->repriceDiscs(DiscSelection{{2, 3}, ""}, -200.0), -1);
+    });
+    EXPECT_EQ(disc(4)->company, "Sony BMG");
+    EXPECT_EQ(disc(1)->company, "Sony Music");
+    
+    // Only discs without operations are deleted; an empty selection is rejected, not "all"
+    captureOutput([&]() {
+        std::string errors = captureError([&]() { EXPECT_EQ(db->deleteUnsoldDiscs(DiscSelection{}, true), -1); });
+        EXPECT_FALSE(errors.empty());
+        EXPECT_EQ(db->deleteUnsoldDiscs(DiscSelection{{}, "", true}, true), 2);
+        EXPECT_EQ(db->deleteUnsoldDiscs(DiscSelection{{1, 4}, ""}), 1);
+    });
+    EXPECT_FALSE(disc(4).has_value());
+    EXPECT_TRUE(disc(1).has_value());
+    EXPECT_TRUE(disc(5).has_value());
+    
+    // Inside an outer transaction the change is rolled back with it
+    ASSERT_TRUE(db->beginTransaction());
+    captureOutput([&]() { EXPECT_EQ(db->deleteUnsoldDiscs(DiscSelection{{}, "", true}), 1); });
+    ASSERT_TRUE(db->rollbackTransaction());
+    EXPECT_TRUE(disc(5).has_value());
+}
@@ -1,9 +1,29 @@
 #include <gtest/gtest.h>
 #include "../include/MusicStoreDB.h"
+#include "../include/ShardSet.h"
+#include "../include/QueryExecutor.h"
+#include "../include/RpcServer.h"
+#include "../include/RpcClient.h"
+#include "../include/StockLedger.h"
 #include <memory>
 #include <filesystem>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Remove a database file together with its WAL and shared-memory files
+void removeDatabase(const std::string& path) {
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::filesystem::remove(path + suffix);
+    }
+}
 
 // Example of thread-related functionality to test
 void threadFunction() {
@@ -126,4 +146,411 @@ TEST_F(SimpleDBTest, TestMusicalWorks) {
     // Since no direct query method is available, we'll test
     // that the operation completed without errors
     EXPECT_TRUE(true);
-}
\ No newline at end of file
+}
+
+// Test chain-wide reports merged from several shop databases
+TEST(ShardSetTest, MergesPartialAggregatesAcrossShards) {
+    std::vector<std::string> paths = {"test_shard_a.db", "test_shard_b.db"};
+    for (const auto& path : paths) {
+        removeDatabase(path);
+    }
+    
+    {
+        MusicStoreDB shopA(paths[0]);
+        shopA.addCompactDisc("2023-01-01", "Sony Music", 10.0);
+        shopA.addMusicalWork("Song 1", "Author 1", "Performer 1", 1);
+        shopA.registerOperation("поступление", 1, 20);
+        shopA.registerOperation("продажа", 1, 5);
+        
+        MusicStoreDB shopB(paths[1]);
+        shopB.addCompactDisc("2023-01-01", "Universal", 20.0);
+        shopB.addMusicalWork("Song 2", "Author 1", "Performer 2", 1);
+        shopB.addCompactDisc("2023-01-01", "Warner", 5.0);
+        shopB.addMusicalWork("Song 3", "Author 2", "Performer 1", 2);
+        shopB.registerOperation("поступление", 1, 10);
+        shopB.registerOperation("поступление", 2, 10);
+        shopB.registerOperation("продажа", 1, 8);
+        shopB.registerOperation("продажа", 2, 3);
+    }
+    
+    // Shards are opened read-only, so the chain report does not seed accounts
+    sqlite3* raw = nullptr;
+    ASSERT_EQ(sqlite3_open(paths[0].c_str(), &raw), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(raw, "DELETE FROM users;", nullptr, nullptr, nullptr), SQLITE_OK);
+    sqlite3_close(raw);
+    
+    ShardSet shards(paths);
+    EXPECT_EQ(shards.size(), 2u);
+    
+    ASSERT_EQ(sqlite3_open(paths[0].c_str(), &raw), SQLITE_OK);
+    sqlite3_stmt* count = nullptr;
+    ASSERT_EQ(sqlite3_prepare_v2(raw, "SELECT COUNT(*) FROM users;", -1, &count, nullptr), SQLITE_OK);
+    ASSERT_EQ(sqlite3_step(count), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(count, 0), 0);
+    sqlite3_finalize(count);
+    sqlite3_close(raw);
+    
+    // A mistyped path is an error instead of a new empty shop
+    EXPECT_THROW(ShardSet({paths[0], "test_shard_missing.db"}), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists("test_shard_missing.db"));
+    
+    // Performer 1: 5 + 3 = 8, Performer 2: 8 -> tie for first place
+    auto top = shards.topPerformers(1);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_EQ(top[0].totalSold, 8);
+    EXPECT_EQ(top[1].totalSold, 8);
+    
+    auto authors = shards.authorSales();
+    ASSERT_EQ(authors.size(), 2u);
+    EXPECT_EQ(authors[0].author, "Author 1");
+    EXPECT_EQ(authors[0].totalSold, 13);
+    EXPECT_EQ(authors[0].worksCount, 2);
+    EXPECT_DOUBLE_EQ(authors[0].totalRevenue, 5 * 10.0 + 8 * 20.0);
+    
+    InventoryValue inventory = shards.inventoryValue();
+    EXPECT_EQ(inventory.discCount, 3);
+    EXPECT_EQ(inventory.totalReceived, 40);
+    EXPECT_EQ(inventory.totalSold, 16);
+    EXPECT_EQ(inventory.remaining, 24);
+    EXPECT_DOUBLE_EQ(inventory.stockValue, 15 * 10.0 + 2 * 20.0 + 7 * 5.0);
+    
+    for (const auto& path : paths) {
+        removeDatabase(path);
+    }
+}
+
+namespace {
+
+// One terminal session: a stock check followed by a report, both awaited
+Task<long long> terminalSession(QueryExecutor& executor, int compactId) {
+    long long stock = co_await executor.stockLevel(compactId);
+    std::vector<PerformerSales> performers = co_await executor.performerSales();
+    co_return performers.empty() ? -1 : stock;
+}
+
+// Drains the streaming inventory into a vector
+Task<std::vector<int>> collectInventory(QueryExecutor& executor) {
+    std::vector<int> ids;
+    AsyncGenerator<InventoryRow> rows = executor.inventory(2);
+    while (auto row = co_await rows.next()) {
+        ids.push_back(row->compactId);
+    }
+    co_return ids;
+}
+
+} // namespace
+
+// Test coroutine executor: many terminals served by a few connection-owning threads
+TEST(QueryExecutorTest, ServesManyTerminalsWithFewThreads) {
+    std::string path = "test_query_executor.db";
+    removeDatabase(path);
+    
+    {
+        MusicStoreDB db(path);
+        for (int i = 1; i <= 5; i++) {
+            db.addCompactDisc("2023-01-01", "Label " + std::to_string(i), 10.0f);
+            db.addMusicalWork("Song " + std::to_string(i), "Author", "Performer " + std::to_string(i), i);
+            db.registerOperation("поступление", i, 100 * i);
+        }
+    }
+    
+    {
+        // One writer thread: sales are serialized on its connection
+        QueryExecutor writer(path, 1);
+        std::vector<Task<int>> sales;
+        for (int i = 0; i < 100; i++) {
+            sales.push_back(writer.registerSale(1 + i % 5, 1));
+        }
+        std::vector<int> ids = syncWait(whenAll(std::move(sales)));
+        EXPECT_EQ(std::count(ids.begin(), ids.end(), -1), 0);
+    }
+    
+    QueryExecutor executor(path, 4);
+    EXPECT_EQ(executor.size(), 4u);
+    
+    std::vector<Task<long long>> terminals;
+    for (int i = 0; i < 100; i++) {
+        terminals.push_back(terminalSession(executor, 1 + i % 5));
+    }
+    std::vector<long long> stock = syncWait(whenAll(std::move(terminals)));
+    ASSERT_EQ(stock.size(), 100u);
+    for (int i = 0; i < 100; i++) {
+        int compactId = 1 + i % 5;
+        EXPECT_EQ(stock[i], 100 * compactId - 20);
+    }
+    
+    // Streaming rows arrive page by page, each disc exactly once
+    std::vector<int> streamed = syncWait(collectInventory(executor));
+    std::sort(streamed.begin(), streamed.end());
+    EXPECT_EQ(streamed, (std::vector<int>{1, 2, 3, 4, 5}));
+    
+    // Exceptions thrown on a worker are rethrown to the awaiting side
+    EXPECT_THROW(syncWait(executor.query([](MusicStoreDB&) -> int { throw std::runtime_error("boom"); })),
+                 std::runtime_error);
+    EXPECT_EQ(syncWait(executor.query([](MusicStoreDB& db) { return db.getStockLevel(2); })), 180);
+    
+    removeDatabase(path);
+}
+
+// Test JSON values used by the RPC protocol
+TEST(RpcProtocolTest, JsonRoundTrip) {
+    auto value = JsonValue::parse(R"({"id": 7, "name": "\u0417\u0430\u043a\u0430\u0437 \"1\"", "price": 19.5,
+                                      "tags": [true, null, -3], "nested": {"a": []}})");
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ((*value)["id"].asInt(), 7);
+    EXPECT_EQ((*value)["name"].asString(), "Заказ \"1\"");
+    EXPECT_DOUBLE_EQ((*value)["price"].asDouble(), 19.5);
+    ASSERT_EQ((*value)["tags"].asArray().size(), 3u);
+    EXPECT_TRUE((*value)["tags"].asArray()[1].isNull());
+    EXPECT_TRUE((*value)["missing"].isNull());
+    
+    auto reparsed = JsonValue::parse(value->dump());
+    ASSERT_TRUE(reparsed.has_value());
+    EXPECT_EQ(reparsed->dump(), value->dump());
+    
+    EXPECT_FALSE(JsonValue::parse("{\"a\": }").has_value());
+    EXPECT_FALSE(JsonValue::parse("[1, 2").has_value());
+    EXPECT_FALSE(JsonValue::parse("01x").has_value());
+    
+    std::string buffer;
+    std::string body;
+    buffer.append("\0\0\0\x02{}", 6);
+    EXPECT_EQ(RpcFrame::extract(buffer, body), 1);
+    EXPECT_EQ(body, "{}");
+    EXPECT_EQ(RpcFrame::extract(buffer, body), 0);
+    buffer.assign("\x7f\0\0\0", 4);
+    EXPECT_EQ(RpcFrame::extract(buffer, body), -1);
+}
+
+// Test RPC server: concurrent clients share the server's connection pool
+TEST(RpcServerTest, ServesConcurrentClients) {
+    std::string path = "test_rpc_server.db";
+    std::string socketPath = "test_rpc_server.sock";
+    removeDatabase(path);
+    
+    {
+        MusicStoreDB db(path);
+        db.addCompactDisc("2023-01-01", "Sony Music", 10.0f);
+        db.addMusicalWork("Song 1", "Author 1", "Performer 1", 1);
+    }
+    
+    std::streambuf* oldCout = std::cout.rdbuf();
+    std::ostringstream discarded;
+    std::cout.rdbuf(discarded.rdbuf());
+    
+    RpcServer server(path, socketPath, 4);
+    ASSERT_TRUE(server.listen());
+    std::thread loop([&server]() { server.run(); });
+    
+    {
+        RpcClient admin(socketPath);
+        EXPECT_EQ(admin.call("ping")["result"].asString(), "pong");
+        EXPECT_FALSE(admin.call("stock", JsonValue::object().set("compactId", 1))["ok"].asBool());
+        EXPECT_FALSE(admin.login("admin", "wrong"));
+        ASSERT_TRUE(admin.login("admin", "admin"));
+        EXPECT_GT(admin.registerReceipt(1, 1000), 0);
+        EXPECT_FALSE(admin.call("noSuchMethod")["ok"].asBool());
+        
+        RpcClient user(socketPath);
+        ASSERT_TRUE(user.login("user", "user"));
+        EXPECT_EQ(user.registerSale(1, 1), -1);
+        EXPECT_EQ(user.stockLevel(1), 1000);
+        
+        // A session token works on another connection without a new login
+        RpcClient resumed(socketPath);
+        resumed.setToken(user.getToken());
+        EXPECT_EQ(resumed.stockLevel(1), 1000);
+        EXPECT_TRUE(user.logout());
+        EXPECT_EQ(resumed.stockLevel(1), -1);
+        EXPECT_EQ(server.sessionCount(), 1u);
+    }
+    
+    // Terminals sell concurrently; the server serializes the writes
+    std::vector<std::thread> terminals;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 8; t++) {
+        terminals.emplace_back([&]() {
+            RpcClient client(socketPath);
+            if (!client.login("admin", "admin")) {
+                failures++;
+                return;
+            }
+            for (int i = 0; i < 10; i++) {
+                if (client.registerSale(1, 2) < 0) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (auto& terminal : terminals) {
+        terminal.join();
+    }
+    EXPECT_EQ(failures.load(), 0);
+    
+    {
+        RpcClient client(socketPath);
+        ASSERT_TRUE(client.login("user", "user"));
+        EXPECT_EQ(client.stockLevel(1), 1000 - 8 * 10 * 2);
+        EXPECT_EQ(server.ledgerStock(1), 1000 - 8 * 10 * 2);
+        auto authors = client.authorSales();
+        ASSERT_EQ(authors.size(), 1u);
+        EXPECT_EQ(authors[0].author, "Author 1");
+        EXPECT_EQ(authors[0].totalSold, 160);
+    }
+    
+    // Overselling is rejected by the ledger and leaves the stock intact
+    {
+        RpcClient client(socketPath);
+        ASSERT_TRUE(client.login("admin", "admin"));
+        EXPECT_EQ(client.registerSale(1, 10000), -1);
+        EXPECT_EQ(client.registerSale(2, 1), -1);
+        EXPECT_EQ(client.stockLevel(1), 1000 - 8 * 10 * 2);
+        EXPECT_EQ(server.ledgerStock(1), 1000 - 8 * 10 * 2);
+        
+        // A receipt written by another process is picked up before a sale is refused
+        {
+            MusicStoreDB other(path);
+            ASSERT_GT(other.registerOperation("поступление", 1, 10000), 0);
+        }
+        EXPECT_GT(client.registerSale(1, 10000), 0);
+        EXPECT_EQ(client.stockLevel(1), 1000 - 8 * 10 * 2);
+        EXPECT_EQ(server.ledgerStock(1), 1000 - 8 * 10 * 2);
+    }
+    
+    server.stop();
+    loop.join();
+    std::cout.rdbuf(oldCout);
+    
+    EXPECT_GE(server.requestCount(), 90);
+    removeDatabase(path);
+}
+
+// Test that a terminal which stops reading ties up neither a worker nor the server
+TEST(RpcServerTest, DropsClientThatStopsReading) {
+    std::string path = "test_rpc_stalled.db";
+    std::string socketPath = "test_rpc_stalled.sock";
+    removeDatabase(path);
+    
+    std::streambuf* oldCout = std::cout.rdbuf();
+    std::ostringstream discarded;
+    std::cout.rdbuf(discarded.rdbuf());
+    
+    RpcServer server(path, socketPath, 1);
+    server.setSendTimeout(std::chrono::milliseconds(300));
+    ASSERT_TRUE(server.listen());
+    std::thread loop([&server]() { server.run(); });
+    
+    // Far more replies than the socket buffer holds, none of them read
+    int stalled = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, socketPath.c_str());
+    ASSERT_EQ(::connect(stalled, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    std::string frames;
+    const int pings = 50000;
+    for (int i = 0; i < pings; i++) {
+        RpcFrame::encode(R"({"id": 1, "method": "ping"})", frames);
+    }
+    // The server may already drop the connection while the requests are still being sent
+    size_t sent = 0;
+    while (sent < frames.size()) {
+        ssize_t n = ::send(stalled, frames.data() + sent, frames.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    
+    // The only worker still serves other terminals
+    {
+        RpcClient client(socketPath);
+        EXPECT_EQ(client.call("ping")["result"].asString(), "pong");
+    }
+    
+    // After the send timeout the stalled connection is closed by the server
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    timeval timeout{5, 0};
+    ::setsockopt(stalled, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char chunk[64 * 1024];
+    size_t received = 0;
+    ssize_t n;
+    while ((n = ::recv(stalled, chunk, sizeof(chunk), 0)) > 0) {
+        received += static_cast<size_t>(n);
+    }
+    // Closed or reset (when requests were left unread), but not a receive timeout
+    EXPECT_TRUE(n == 0 || errno == ECONNRESET) << std::strerror(errno);
+    EXPECT_LT(received, static_cast<size_t>(pings) * 30);
+    ::close(stalled);
+    
+    {
+        RpcClient client(socketPath);
+        EXPECT_EQ(client.call("ping")["result"].asString(), "pong");
+    }
+    
+    server.stop();
+    loop.join();
+    std::cout.rdbuf(oldCout);
+    removeDatabase(path);
+}
+
+// Test that concurrent reservations never oversell a disc
+TEST(StockLedgerTest, ConcurrentReservations) {
+    StockLedger ledger;
+    ledger.load({{1, 1000}, {2, 5}});
+    EXPECT_EQ(ledger.size(), 2u);
+    EXPECT_EQ(ledger.reserve(3, 1), StockLedger::Reservation::Unknown);
+    
+    std::atomic<int> reserved{0};
+    std::vector<std::thread> terminals;
+    for (int t = 0; t < 8; t++) {
+        terminals.emplace_back([&]() {
+            for (int i = 0; i < 200; i++) {
+                if (ledger.reserve(1, 1) == StockLedger::Reservation::Reserved) {
+                    reserved++;
+                    ledger.commit(1, 1);
+                }
+            }
+        });
+    }
+    for (auto& terminal : terminals) {
+        terminal.join();
+    }
+    EXPECT_EQ(reserved.load(), 1000);
+    EXPECT_EQ(ledger.available(1), 0);
+    
+    // Reconciliation keeps reservations that are not in the database yet
+    EXPECT_EQ(ledger.reserve(2, 3), StockLedger::Reservation::Reserved);
+    EXPECT_EQ(ledger.reserve(2, 3), StockLedger::Reservation::Insufficient);
+    ledger.reconcile(2, 10);
+    EXPECT_EQ(ledger.available(2), 7);
+    ledger.release(2, 3);
+    EXPECT_EQ(ledger.available(2), 10);
+    
+    // A deleted disc has nothing to sell
+    ledger.reconcile(2, -1);
+    EXPECT_EQ(ledger.reserve(2, 1), StockLedger::Reservation::Insufficient);
+}
+
+// Test that discs added while terminals reserve do not disturb existing counters
+TEST(StockLedgerTest, AddDiscsDuringReservations) {
+    StockLedger ledger;
+    ledger.load({{1, 1000}});
+    
+    std::atomic<int> reserved{0};
+    std::thread terminal([&]() {
+        for (int i = 0; i < 1000; i++) {
+            if (ledger.reserve(1, 1) == StockLedger::Reservation::Reserved) {
+                reserved++;
+            }
+        }
+    });
+    for (int compactId = 2; compactId <= 500; compactId++) {
+        ledger.reconcile(compactId, compactId);
+    }
+    terminal.join();
+    
+    EXPECT_EQ(reserved.load(), 1000);
+    EXPECT_EQ(ledger.size(), 500u);
+    EXPECT_EQ(ledger.available(1), 0);
+    EXPECT_EQ(ledger.available(500), 500);
+}
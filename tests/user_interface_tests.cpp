@@ -180,4 +180,175 @@ TEST_F(UserInterfaceTest, MostPopularPerformerTest) {
     EXPECT_FALSE(output.empty());
     // This depends on which performer is more popular in your test data
     EXPECT_TRUE(output.find("Performer") != std::string::npos);
-}
\ No newline at end of file
+}
+// Test non-interactive batch command mode
+TEST_F(UserInterfaceTest, BatchModeTest) {
+    UserInterface* ui = tester->getUi();
+    
+    std::istringstream script(
+        "# admin session\n"
+        "login admin admin\n"
+        "add-disc 2023-03-01 \"Warner Music\" 14.5\n"
+        "add-work 3 \"Song 3\" \"Author 3\" \"Performer 3\"\n"
+        "receipt 3 12\n"
+        "sale 3 2\n"
+        "sale 3 100\n"
+        "report 2000-01-01 2100-12-31\n"
+        "unknown-command\n"
+        "reprice \"Warner Music\" 10 dry-run\n"
+        "series month disc 2000-01-01 2100-12-31 3\n");
+    std::ostringstream output;
+    
+    int failed = 0;
+    std::string errors = [&]() {
+        std::streambuf* oldCerr = std::cerr.rdbuf();
+        std::ostringstream captured;
+        std::cerr.rdbuf(captured.rdbuf());
+        failed = ui->runBatch(script, output, 3);
+        std::cerr.rdbuf(oldCerr);
+        return captured.str();
+    }();
+    
+    // Overselling and the unknown command fail, the rest succeed
+    EXPECT_EQ(failed, 2);
+    EXPECT_TRUE(errors.find("Строка 7") != std::string::npos);
+    EXPECT_TRUE(errors.find("Строка 9") != std::string::npos);
+    
+    std::string text = output.str();
+    EXPECT_TRUE(text.find("Добавлен новый компакт-диск с ID: 3") != std::string::npos);
+    EXPECT_TRUE(text.find("Warner Music") != std::string::npos);
+    EXPECT_TRUE(text.find("Будет изменена цена компакт-дисков: 1") != std::string::npos);
+    EXPECT_TRUE(text.find("Продажи по времени") != std::string::npos);
+    
+    // Writes are committed and visible after the batch
+    auto page = db->getCompactInventoryPage(10);
+    bool found = false;
+    for (const auto& row : page.rows) {
+        if (row.compactId == 3) {
+            found = true;
+            EXPECT_EQ(row.remaining, 10);
+        }
+    }
+    EXPECT_TRUE(found);
+}
+
+// Test that regular users cannot run admin batch commands
+TEST_F(UserInterfaceTest, BatchModeUserPermissionsTest) {
+    std::istringstream script(
+        "login user user\n"
+        "sale 1 1\n"
+        "sales 1 2000-01-01 2100-12-31\n"
+        "sales 1,2 2000-01-01 2100-12-31\n");
+    std::ostringstream output;
+    
+    std::streambuf* oldCerr = std::cerr.rdbuf();
+    std::ostringstream errors;
+    std::cerr.rdbuf(errors.rdbuf());
+    int failed = tester->getUi()->runBatch(script, output);
+    std::cerr.rdbuf(oldCerr);
+    
+    EXPECT_EQ(failed, 1);
+    EXPECT_TRUE(errors.str().find("администратору") != std::string::npos);
+    EXPECT_TRUE(output.str().find("Sony Music") != std::string::npos);
+    EXPECT_TRUE(output.str().find("Итого") != std::string::npos);
+}
+
+// Test that backup in a transactional batch commits pending commands first
+TEST_F(UserInterfaceTest, BatchModeBackupInTransactionTest) {
+    std::string backupPath = "test_batch_backup.db";
+    std::istringstream script(
+        "login admin admin\n"
+        "receipt 1 3\n"
+        "backup " + backupPath + "\n"
+        "receipt 1 2\n");
+    std::ostringstream output;
+    
+    int failed = tester->getUi()->runBatch(script, output, 5);
+    EXPECT_EQ(failed, 0);
+    EXPECT_TRUE(std::filesystem::exists(backupPath));
+    EXPECT_FALSE(std::filesystem::exists(backupPath + ".part"));
+    std::filesystem::remove(backupPath);
+}
+
+// Test that commands are not run in autocommit when the batch transaction cannot start
+TEST_F(UserInterfaceTest, BatchModeBeginFailureTest) {
+    ASSERT_TRUE(db->login("admin", "admin"));
+    long long stock = db->getStockLevel(1);
+    
+    // Another connection holds the write lock longer than the policy allows
+    MusicStoreDB other(testDbPath);
+    ASSERT_TRUE(other.beginTransaction());
+    BusyPolicy impatient;
+    impatient.timeout = std::chrono::milliseconds(20);
+    impatient.writeRetries = 0;
+    db->setBusyPolicy(impatient);
+    
+    std::istringstream script(
+        "receipt 1 3\n"
+        "receipt 1 2\n");
+    std::ostringstream output;
+    
+    std::streambuf* oldCerr = std::cerr.rdbuf();
+    std::ostringstream errors;
+    std::cerr.rdbuf(errors.rdbuf());
+    int failed = tester->getUi()->runBatch(script, output, 5);
+    std::cerr.rdbuf(oldCerr);
+    
+    EXPECT_EQ(failed, 2);
+    EXPECT_TRUE(errors.str().find("Строка 1: не удалось начать транзакцию") != std::string::npos);
+    EXPECT_TRUE(errors.str().find("Строка 2: не удалось начать транзакцию") != std::string::npos);
+    
+    other.rollbackTransaction();
+    EXPECT_EQ(db->getStockLevel(1), stock);
+}
+
+// Test that a sales id list with a bad or overflowing item is rejected as a whole
+TEST_F(UserInterfaceTest, BatchModeIdListTest) {
+    std::istringstream script(
+        "login admin admin\n"
+        "sales 1,x,3 2000-01-01 2100-12-31\n"
+        "sales 1,4294967297 2000-01-01 2100-12-31\n"
+        "sales 1,-2 2000-01-01 2100-12-31\n"
+        "sales 1,2 2000-01-01 2100-12-31\n");
+    std::ostringstream output;
+    
+    std::streambuf* oldCerr = std::cerr.rdbuf();
+    std::ostringstream errors;
+    std::cerr.rdbuf(errors.rdbuf());
+    int failed = tester->getUi()->runBatch(script, output);
+    std::cerr.rdbuf(oldCerr);
+    
+    EXPECT_EQ(failed, 3);
+    EXPECT_TRUE(errors.str().find("Неверный список идентификаторов: 1,x,3") != std::string::npos);
+    EXPECT_TRUE(errors.str().find("Неверный список идентификаторов: 1,4294967297") != std::string::npos);
+    EXPECT_TRUE(errors.str().find("Неверный список идентификаторов: 1,-2") != std::string::npos);
+    EXPECT_TRUE(output.str().find("Итого") != std::string::npos);
+}
+
+// Test that malformed bulk selections are rejected instead of selecting every disc
+TEST_F(UserInterfaceTest, BatchModeDiscSelectionTest) {
+    std::istringstream script(
+        "login admin admin\n"
+        "reprice , 10 dry-run\n"
+        "delete-unsold 1,,2 dry-run\n"
+        "reassign company: Other dry-run\n"
+        "reprice company:1 10 dry-run\n"
+        "reprice all 10 dry-run\n");
+    std::ostringstream output;
+    
+    std::streambuf* oldCerr = std::cerr.rdbuf();
+    std::ostringstream errors;
+    std::cerr.rdbuf(errors.rdbuf());
+    int failed = tester->getUi()->runBatch(script, output);
+    std::cerr.rdbuf(oldCerr);
+    
+    EXPECT_EQ(failed, 3);
+    EXPECT_TRUE(errors.str().find("Строка 2") != std::string::npos);
+    EXPECT_TRUE(errors.str().find("Строка 3") != std::string::npos);
+    EXPECT_TRUE(errors.str().find("Строка 4") != std::string::npos);
+    
+    // "company:1" names a company, not disc 1; only "all" selects the whole catalog
+    std::string text = output.str();
+    EXPECT_TRUE(text.find("Будет изменена цена компакт-дисков: 0") != std::string::npos);
+    EXPECT_TRUE(text.find("Будет изменена цена компакт-дисков: 2") != std::string::npos);
+}